@@ -29,8 +29,15 @@ class ZMQTest (BitcoinTestFramework):
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashblock")
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashtx")
         self.zmqSubSocket.connect("tcp://127.0.0.1:%i" % self.port)
+        self.zmqBlockSubSocket = self.zmqContext.socket(zmq.SUB)
+        self.zmqBlockSubSocket.setsockopt(zmq.SUBSCRIBE, b"rawblock")
+        self.zmqBlockSubSocket.setsockopt(zmq.SUBSCRIBE, b"rawsigmamint")
+        self.zmqBlockSubSocket.setsockopt(zmq.SUBSCRIBE, b"sigmaspendserial")
+        self.zmqBlockSubSocket.connect("tcp://127.0.0.1:%i" % self.port)
+        address = 'tcp://127.0.0.1:'+str(self.port)
         return start_nodes(self.num_nodes, self.options.tmpdir, extra_args=[
-            ['-zmqpubhashtx=tcp://127.0.0.1:'+str(self.port), '-zmqpubhashblock=tcp://127.0.0.1:'+str(self.port)],
+            ['-zmqpubhashtx='+address, '-zmqpubhashblock='+address, '-zmqpubrawblock='+address,
+             '-zmqpubrawsigmamint='+address, '-zmqpubsigmaspendserial='+address],
             [],
             [],
             []
@@ -41,6 +48,7 @@ class ZMQTest (BitcoinTestFramework):
 
         genhashes = self.nodes[0].generate(1)
         self.sync_all()
+        tiphashes = list(genhashes)
 
         print("listen...")
         msg = self.zmqSubSocket.recv_multipart()
@@ -63,6 +71,7 @@ class ZMQTest (BitcoinTestFramework):
         n = 10
         genhashes = self.nodes[1].generate(n)
         self.sync_all()
+        tiphashes += genhashes
 
         zmqHashes = []
         blockcount = 0
@@ -95,6 +104,58 @@ class ZMQTest (BitcoinTestFramework):
 
         assert_equal(hashRPC, hashZMQ) #blockhash from generate must be equal to the hash received over zmq
 
+        # rawblock is serialized from the connected block in memory, for blocks generated locally
+        # and received from a peer alike, and must match the block stored on disk
+        self.check_rawblocks(tiphashes)
+
+        # sigma mints and spends of connected blocks
+        sigmaStart = 560 # past the sigma start and padding blocks of regtest
+        self.check_rawblocks(self.nodes[0].generate(sigmaStart - self.nodes[0].getblockcount()))
+
+        mintTxid = self.nodes[0].mint(1)
+        mintBlock = self.nodes[0].generate(1)[0]
+        msg = self.zmqBlockSubSocket.recv_multipart()
+        assert_equal(msg[0], b"rawsigmamint")
+        body = msg[1]
+        assert_equal(bytes_to_hex_str(body[0:32]), mintBlock)
+        assert_equal(bytes_to_hex_str(body[32:64]), mintTxid)
+        vout = struct.unpack('<I', body[64:68])[0]
+        assert_equal(struct.unpack('<q', body[68:76])[0], 100000000)
+        mintTx = self.nodes[0].getrawtransaction(mintTxid, 1)
+        # the public coin follows the sigma mint opcode in the output script
+        assert_equal(bytes_to_hex_str(body[76:]), mintTx['vout'][vout]['scriptPubKey']['hex'][2:])
+        self.check_rawblocks([mintBlock])
+
+        self.check_rawblocks(self.nodes[0].generate(6))
+        spendTxid = self.nodes[0].spend(self.nodes[0].getnewaddress(), 1, "", "", True)
+        spendBlock = self.nodes[0].generate(1)[0]
+        msg = self.zmqBlockSubSocket.recv_multipart()
+        assert_equal(msg[0], b"sigmaspendserial")
+        body = msg[1]
+        assert_equal(bytes_to_hex_str(body[0:32]), spendBlock)
+        assert_equal(bytes_to_hex_str(body[32:64]), spendTxid)
+        assert_equal(struct.unpack('<I', body[64:68])[0], 0)
+        assert_equal(len(body), 100)
+        self.check_rawblocks([spendBlock])
+
+        # a disconnected block sends nothing on the sigma topics, the spend is only published again
+        # with the block connected instead, if it went back to the mempool
+        self.nodes[0].invalidateblock(spendBlock)
+        reorgBlock = self.nodes[0].generate(1)[0]
+        msg = self.zmqBlockSubSocket.recv_multipart()
+        if msg[0] == b"sigmaspendserial":
+            assert_equal(bytes_to_hex_str(msg[1][0:32]), reorgBlock)
+            assert_equal(bytes_to_hex_str(msg[1][32:64]), spendTxid)
+            msg = self.zmqBlockSubSocket.recv_multipart()
+        assert_equal(msg[0], b"rawblock")
+        assert_equal(bytes_to_hex_str(msg[1]), self.nodes[0].getblock(reorgBlock, False))
+
+    def check_rawblocks(self, blockhashes):
+        for blockhash in blockhashes:
+            msg = self.zmqBlockSubSocket.recv_multipart()
+            assert_equal(msg[0], b"rawblock")
+            assert_equal(bytes_to_hex_str(msg[1]), self.nodes[0].getblock(blockhash, False))
+
 
 if __name__ == '__main__':
     ZMQTest ().main ()
@@ -13,6 +13,8 @@
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
 #include "crypto/sha512.h"
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Lyra2ZContext.h"
 
 /* Number of bytes to hash per iteration */
 static const uint64_t BUFFER_SIZE = 1000*1000;
@@ -69,6 +71,29 @@ static void SipHash_32b(benchmark::State& state)
     }
 }
 
+// Lyra2Z of a block header, reusing the memory matrix of the thread
+static void Lyra2Z(benchmark::State& state)
+{
+    uint256 hash;
+    std::vector<uint8_t> header(80, 0);
+    Lyra2ZContext& context = Lyra2ZContext::ThreadContext();
+    while (state.KeepRunning()) {
+        context.Hash(begin_ptr(header), hash.begin());
+        header[76]++;
+    }
+}
+
+// Lyra2Z of a block header, allocating the memory matrix for every hash
+static void Lyra2ZAlloc(benchmark::State& state)
+{
+    uint256 hash;
+    std::vector<uint8_t> header(80, 0);
+    while (state.KeepRunning()) {
+        LYRA2(hash.begin(), 32, begin_ptr(header), 80, begin_ptr(header), 80, 2, 330, 256);
+        header[76]++;
+    }
+}
+
 BENCHMARK(RIPEMD160);
 BENCHMARK(SHA1);
 BENCHMARK(SHA256);
@@ -76,3 +101,6 @@ BENCHMARK(SHA512);
 
 BENCHMARK(SHA256_32b);
 BENCHMARK(SipHash_32b);
+
+BENCHMARK(Lyra2Z);
+BENCHMARK(Lyra2ZAlloc);
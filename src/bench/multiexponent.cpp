@@ -0,0 +1,104 @@
+#include "bench.h"
+
+#include "crypto/sha256.h"
+#include "secp256k1/include/MultiExponent.h"
+
+#include <vector>
+
+using namespace secp_primitives;
+
+// Deterministic points and exponents, derived from the index so runs are comparable.
+static void MakeFixture(std::size_t n, std::vector<GroupElement>& points, std::vector<Scalar>& exponents)
+{
+    points.resize(n);
+    exponents.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        unsigned char seed[CSHA256::OUTPUT_SIZE];
+        uint64_t index = i;
+        CSHA256().Write((const unsigned char*)&index, sizeof(index)).Finalize(seed);
+        points[i].generate(seed);
+        CSHA256().Write(seed, sizeof(seed)).Finalize(seed);
+        exponents[i].generate(seed);
+    }
+}
+
+static void MultiExponentN(benchmark::State& state, std::size_t n)
+{
+    std::vector<GroupElement> points;
+    std::vector<Scalar> exponents;
+    MakeFixture(n, points, exponents);
+
+    while (state.KeepRunning()) {
+        MultiExponent mult(points, exponents);
+        mult.get_multiple();
+    }
+}
+
+// The same sums with the inputs copied on every call, as MultiExponent did before it borrowed them,
+// for comparison with the cases above. Allocating scratch space per call, which MultiExponent also
+// did, is internal to it and not part of this baseline.
+static void MultiExponentCopyingN(benchmark::State& state, std::size_t n)
+{
+    std::vector<GroupElement> points;
+    std::vector<Scalar> exponents;
+    MakeFixture(n, points, exponents);
+
+    while (state.KeepRunning()) {
+        std::vector<GroupElement> pointsCopy(points);
+        std::vector<Scalar> exponentsCopy(exponents);
+        MultiExponent mult(pointsCopy, exponentsCopy);
+        mult.get_multiple();
+    }
+}
+
+// Small enough that allocation and scratch setup are a visible share of the work,
+// 28 is the size of a sigma vector commitment.
+static void MultiExponent28(benchmark::State& state)
+{
+    MultiExponentN(state, 28);
+}
+
+static void MultiExponentCopying28(benchmark::State& state)
+{
+    MultiExponentCopyingN(state, 28);
+}
+
+static void MultiExponent1024(benchmark::State& state)
+{
+    MultiExponentN(state, 1024);
+}
+
+static void MultiExponentCopying1024(benchmark::State& state)
+{
+    MultiExponentCopyingN(state, 1024);
+}
+
+// Anonymity set sizes, a full coin group and a few of them verified together
+static void MultiExponent16384(benchmark::State& state)
+{
+    MultiExponentN(state, 16384);
+}
+
+static void MultiExponentCopying16384(benchmark::State& state)
+{
+    MultiExponentCopyingN(state, 16384);
+}
+
+static void MultiExponent65536(benchmark::State& state)
+{
+    MultiExponentN(state, 65536);
+}
+
+static void MultiExponentCopying65536(benchmark::State& state)
+{
+    MultiExponentCopyingN(state, 65536);
+}
+
+BENCHMARK(MultiExponent28);
+BENCHMARK(MultiExponentCopying28);
+BENCHMARK(MultiExponent1024);
+BENCHMARK(MultiExponentCopying1024);
+BENCHMARK(MultiExponent16384);
+BENCHMARK(MultiExponentCopying16384);
+BENCHMARK(MultiExponent65536);
+BENCHMARK(MultiExponentCopying65536);
@@ -0,0 +1,149 @@
+#include "bench.h"
+
+#include "chain.h"
+#include "crypto/sha256.h"
+#include "sigma.h"
+#include "sigma/params.h"
+#include "sigma/sigmaplus_prover.h"
+#include "sigma/sigmaplus_verifier.h"
+#include "taskpool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace secp_primitives;
+
+// Fixtures are derived from fixed seeds so every run works on the same data.
+static void Seed(uint64_t index, uint64_t tag, unsigned char seed[CSHA256::OUTPUT_SIZE])
+{
+    CSHA256().Write((const unsigned char*)&index, sizeof(index))
+             .Write((const unsigned char*)&tag, sizeof(tag))
+             .Finalize(seed);
+}
+
+static GroupElement FixturePoint(uint64_t index)
+{
+    unsigned char seed[CSHA256::OUTPUT_SIZE];
+    Seed(index, 0, seed);
+    GroupElement result;
+    result.generate(seed);
+    return result;
+}
+
+static Scalar FixtureScalar(uint64_t index)
+{
+    unsigned char seed[CSHA256::OUTPUT_SIZE];
+    Seed(index, 1, seed);
+    Scalar result;
+    result.generate(seed);
+    return result;
+}
+
+// Commitments of an anonymity set of size N, where the one at index l opens to zero.
+struct SigmaProofFixture {
+    std::vector<GroupElement> commits;
+    int l;
+    Scalar r;
+
+    explicit SigmaProofFixture(int N) : l(N / 2), r(FixtureScalar(0))
+    {
+        const sigma::Params* params = sigma::Params::get_default();
+        commits.reserve(N);
+        for (int i = 0; i < N; ++i)
+            commits.push_back(FixturePoint(i));
+        commits[l] = params->get_h0() * r;
+    }
+
+    sigma::SigmaPlusProof<Scalar, GroupElement> Prove(bool fPadding) const
+    {
+        const sigma::Params* params = sigma::Params::get_default();
+        sigma::SigmaPlusProver<Scalar, GroupElement> prover(
+            params->get_g(), params->get_h(), params->get_n(), params->get_m(), params, ParallelFor);
+        sigma::SigmaPlusProof<Scalar, GroupElement> proof(params);
+        prover.proof(commits, l, r, fPadding, proof);
+        return proof;
+    }
+};
+
+static void SigmaProve(benchmark::State& state)
+{
+    SigmaProofFixture fixture(16384);
+    while (state.KeepRunning()) {
+        fixture.Prove(false);
+    }
+}
+
+static void SigmaVerify(benchmark::State& state, int N, bool fPadding)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    SigmaProofFixture fixture(N);
+    sigma::SigmaPlusProof<Scalar, GroupElement> proof = fixture.Prove(fPadding);
+    sigma::SigmaPlusVerifier<Scalar, GroupElement> verifier(
+        params->get_g(), params->get_h(), params->get_n(), params->get_m(), params);
+
+    // Timing the rejection of a broken proof would be meaningless, and asserts are compiled out of
+    // optimized builds
+    if (!verifier.verify(fixture.commits, proof, fPadding)) {
+        fprintf(stderr, "SigmaVerify: the proof of the fixture doesn't verify (N=%d, padding=%d)\n", N, (int)fPadding);
+        std::abort();
+    }
+    while (state.KeepRunning()) {
+        verifier.verify(fixture.commits, proof, fPadding);
+    }
+}
+
+// Full anonymity set, nothing to pad
+static void SigmaVerifyUnpadded(benchmark::State& state)
+{
+    SigmaVerify(state, 16384, false);
+}
+
+// Anonymity set padded up to 16384 with its last element
+static void SigmaVerifyPadded(benchmark::State& state)
+{
+    SigmaVerify(state, 10000, true);
+}
+
+static void GroupElementSerialize(benchmark::State& state)
+{
+    GroupElement point = FixturePoint(0);
+    unsigned char buffer[GroupElement::serialize_size];
+    while (state.KeepRunning()) {
+        point.serialize(buffer);
+    }
+}
+
+static void GroupElementDeserialize(benchmark::State& state)
+{
+    GroupElement point = FixturePoint(0);
+    unsigned char buffer[GroupElement::serialize_size];
+    point.serialize(buffer);
+    while (state.KeepRunning()) {
+        point.deserialize(buffer);
+    }
+}
+
+// A block with 1000 mints of a single group added to an empty state
+static void SigmaStateAddBlock(benchmark::State& state)
+{
+    CBlockIndex index;
+    index.nHeight = 1;
+    CSigmaBlockIndex sigmaIndex;
+    std::vector<sigma::PublicCoin>& coins = sigmaIndex.mintedPubCoins[
+        std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_1, 1)];
+    for (int i = 0; i < 1000; ++i)
+        coins.push_back(sigma::PublicCoin(FixturePoint(i), sigma::CoinDenomination::SIGMA_DENOM_1));
+
+    while (state.KeepRunning()) {
+        sigma::CSigmaState sigmaState;
+        sigmaState.AddBlock(&index, sigmaIndex);
+    }
+}
+
+BENCHMARK(SigmaProve);
+BENCHMARK(SigmaVerifyUnpadded);
+BENCHMARK(SigmaVerifyPadded);
+BENCHMARK(GroupElementSerialize);
+BENCHMARK(GroupElementDeserialize);
+BENCHMARK(SigmaStateAddBlock);
@@ -25,6 +25,10 @@
 #include <unordered_set>
 
 #define ZC_ADVANCED_INDEX_VERSION_CHAIN           130500
+// Version of block index records that no longer carry sigma entries, they are kept in CSigmaBlockIndex
+// records of their own. Records are written with at least this version, so older binaries fail to read
+// them instead of silently seeing blocks without sigma entries.
+#define SIGMA_BLOCK_INDEX_VERSION                 2020001
 
 class CBlockFileInfo
 {
@@ -163,6 +167,91 @@ enum BlockStatus: uint32_t {
     BLOCK_STAKE_MODIFIER     =   1024,
 };
 
+/** Sigma mints and spends of a block. Kept in the block tree database apart from the
+ *  block index, so that CBlockIndex stays a fixed-size header record.
+ */
+class CSigmaBlockIndex
+{
+public:
+    //! Public coin values of mints in this block, ordered by serialized value of public coin
+    //! Maps <denomination,id> to vector of public coins
+    std::map<std::pair<sigma::CoinDenomination, int>, std::vector<sigma::PublicCoin>> mintedPubCoins;
+
+    //! Values of coin serials spent in this block
+    std::vector<secp_primitives::Scalar> spentSerials;
+
+    CSigmaBlockIndex()
+    {
+        SetNull();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(mintedPubCoins);
+        READWRITE(spentSerials);
+    }
+
+    void SetNull()
+    {
+        mintedPubCoins.clear();
+        spentSerials.clear();
+    }
+
+    bool IsNull() const
+    {
+        return mintedPubCoins.empty() && spentSerials.empty();
+    }
+};
+
+/** Key of the coins a block added to a sigma coin group in the block tree database. Height is
+ *  stored big endian so the entries of a group are iterated in chain order. Entries are kept when
+ *  their block is disconnected, readers skip the ones of blocks not in the chain.
+ */
+struct CSigmaCoinGroupKey {
+    sigma::CoinDenomination denomination;
+    int id;
+    int nHeight;
+    uint256 blockHash;
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        return 1 + 4 + 4 + 32;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s, int nType, int nVersion) const {
+        ser_writedata8(s, static_cast<uint8_t>(denomination));
+        ser_writedata32be(s, id);
+        ser_writedata32be(s, nHeight);
+        blockHash.Serialize(s, nType, nVersion);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s, int nType, int nVersion) {
+        denomination = static_cast<sigma::CoinDenomination>(ser_readdata8(s));
+        id = ser_readdata32be(s);
+        nHeight = ser_readdata32be(s);
+        blockHash.Unserialize(s, nType, nVersion);
+    }
+
+    CSigmaCoinGroupKey(sigma::CoinDenomination denominationIn, int idIn, int nHeightIn, const uint256 &blockHashIn) {
+        denomination = denominationIn;
+        id = idIn;
+        nHeight = nHeightIn;
+        blockHash = blockHashIn;
+    }
+
+    CSigmaCoinGroupKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        denomination = sigma::CoinDenomination::SIGMA_DENOM_0_1;
+        id = 0;
+        nHeight = 0;
+        blockHash.SetNull();
+    }
+};
+
 /** The block chain is a tree shaped structure starting with the
  * genesis block at the root, with each block potentially having multiple
  * candidates to be the next block. A blockindex may have multiple pprev pointing
@@ -228,23 +317,13 @@ public:
     //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
     map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
 
-    //! Same as accumulatorChanges but for alternative modulus
+    //! Same as accumulatorChanges but for alternative modulus. Calculated on demand, and kept in
+    //! the block tree database apart from the block index
     map<pair<int,int>, pair<CBigNum,int>> alternativeAccumulatorChanges;
     
     //! Values of coin serials spent in this block
     set<CBigNum> spentSerials;
 
-    //////////////////////////////////
-    // Sigma entries   
-    //////////////////////////////////
-
-    //! Public coin values of mints in this block, ordered by serialized value of public coin
-    //! Maps <denomination,id> to vector of public coins
-    std::map<pair<sigma::CoinDenomination, int>, vector<sigma::PublicCoin>> sigmaMintedPubCoins;
-
-    //! Values of coin serials spent in this block
-    unordered_set<secp_primitives::Scalar, sigma::CScalarHash> sigmaSpentSerials;
-
     void SetNull()
     {
         phashBlock = NULL;
@@ -270,10 +349,6 @@ public:
         accumulatorChanges.clear();
         spentSerials.clear();
 
-        // Sigma
-        sigmaMintedPubCoins.clear();
-        sigmaSpentSerials.clear();
-
         //PoS
         nStakeModifier = uint256();
     }
@@ -437,6 +512,12 @@ class CDiskBlockIndex : public CBlockIndex
 public:
     uint256 hashPrev;
     int nDiskBlockVersion;
+
+    //! Sigma entries of records written before SIGMA_BLOCK_INDEX_VERSION, read only to migrate
+    //! existing block tree databases. Never written.
+    std::map<pair<sigma::CoinDenomination, int>, vector<sigma::PublicCoin>> sigmaMintedPubCoins;
+    unordered_set<secp_primitives::Scalar, sigma::CScalarHash> sigmaSpentSerials;
+
     CDiskBlockIndex() {
         hashPrev = uint256();
         // value doesn't really matter but we won't leave it uninitialized
@@ -452,8 +533,11 @@ public:
 
     template <typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
-        if (!(nType & SER_GETHASH))
+        if (!(nType & SER_GETHASH)) {
+            if (!ser_action.ForRead())
+                nVersion = std::max(nVersion, SIGMA_BLOCK_INDEX_VERSION);
             READWRITE(VARINT(nVersion));
+        }
 
         READWRITE(VARINT(nHeight));
         READWRITE(VARINT(nStatus));
@@ -479,7 +563,8 @@ public:
         }
 
         // Sigma
-        if (!(nType & SER_GETHASH) && nHeight >= Params().GetConsensus().nSigmaStartBlock) {
+        if (!(nType & SER_GETHASH) && nVersion < SIGMA_BLOCK_INDEX_VERSION
+                && nHeight >= Params().GetConsensus().nSigmaStartBlock) {
             READWRITE(sigmaMintedPubCoins);
             READWRITE(sigmaSpentSerials);
         }
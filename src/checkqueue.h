@@ -5,6 +5,8 @@
 #ifndef BITCOIN_CHECKQUEUE_H
 #define BITCOIN_CHECKQUEUE_H
 
+#include "taskpool.h"
+
 #include <algorithm>
 #include <vector>
 
@@ -22,9 +24,9 @@ class CCheckQueueControl;
   * operator(), returning a bool.
   *
   * One thread (the master) is assumed to push batches of verifications
-  * onto the queue, where they are processed by N-1 worker threads. When
-  * the master is done adding work, it temporarily joins the worker pool
-  * as an N'th worker, until all jobs are done.
+  * onto the queue, which are processed by helper tasks on the task pool,
+  * at most one per pool thread. When the master is done adding work, it
+  * processes checks too, until all jobs are done.
   */
 template <typename T>
 class CCheckQueue
@@ -33,9 +35,6 @@ private:
     //! Mutex to protect the inner state
     boost::mutex mutex;
 
-    //! Worker threads block on this when out of work
-    boost::condition_variable condWorker;
-
     //! Master thread blocks on this when out of work
     boost::condition_variable condMaster;
 
@@ -43,11 +42,8 @@ private:
     //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
     std::vector<T> queue;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle;
-
-    //! The total number of workers (including the master).
-    int nTotal;
+    //! The number of helper tasks submitted to the pool that have not returned yet.
+    int nHelpers;
 
     //! The temporary evaluation result.
     bool fAllOk;
@@ -59,16 +55,12 @@ private:
      */
     unsigned int nTodo;
 
-    //! Whether we're shutting down.
-    bool fQuit;
-
     //! The maximum number of elements to be processed in one batch
     unsigned int nBatchSize;
 
-    /** Internal function that does bulk of the verification work. */
+    /** Internal function that does bulk of the verification work. Helpers return once the queue is empty. */
     bool Loop(bool fMaster = false)
     {
-        boost::condition_variable& cond = fMaster ? condMaster : condWorker;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
         unsigned int nNow = 0;
@@ -83,31 +75,27 @@ private:
                     if (nTodo == 0 && !fMaster)
                         // We processed the last element; inform the master it can exit and return the result
                         condMaster.notify_one();
-                } else {
-                    // first iteration
-                    nTotal++;
                 }
                 // logically, the do loop starts here
                 while (queue.empty()) {
-                    if ((fMaster || fQuit) && nTodo == 0) {
-                        nTotal--;
+                    if (!fMaster) {
+                        nHelpers--;
+                        return true;
+                    }
+                    if (nTodo == 0) {
                         bool fRet = fAllOk;
                         // reset the status for new work later
-                        if (fMaster)
-                            fAllOk = true;
+                        fAllOk = true;
                         // return the current status
                         return fRet;
                     }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
+                    condMaster.wait(lock); // wait for the checks still in the helpers' batches
                 }
                 // Decide how many work units to process now.
                 // * Do not try to do everything at once, but aim for increasingly smaller batches so
                 //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
                 // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
+                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nHelpers + 2)));
                 vChecks.resize(nNow);
                 for (unsigned int i = 0; i < nNow; i++) {
                     // We want the lock on the mutex to be as short as possible, so swap jobs from the global
@@ -128,13 +116,7 @@ private:
 
 public:
     //! Create a new check queue
-    CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), fQuit(false), nBatchSize(nBatchSizeIn) {}
-
-    //! Worker thread
-    void Thread()
-    {
-        Loop();
-    }
+    CCheckQueue(unsigned int nBatchSizeIn) : nHelpers(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn) {}
 
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
@@ -145,16 +127,19 @@ public:
     //! Add a batch of checks to the queue
     void Add(std::vector<T>& vChecks)
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        BOOST_FOREACH (T& check, vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
+        int nNewHelpers;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            BOOST_FOREACH (T& check, vChecks) {
+                queue.push_back(T());
+                check.swap(queue.back());
+            }
+            nTodo += vChecks.size();
+            nNewHelpers = std::max(0, std::min(taskPool.GetThreadCount() - nHelpers, (int)vChecks.size()));
+            nHelpers += nNewHelpers;
         }
-        nTodo += vChecks.size();
-        if (vChecks.size() == 1)
-            condWorker.notify_one();
-        else if (vChecks.size() > 1)
-            condWorker.notify_all();
+        for (int i = 0; i < nNewHelpers; i++)
+            taskPool.Submit([this] { Loop(); });
     }
 
     ~CCheckQueue()
@@ -163,8 +148,9 @@ public:
 
     bool IsIdle()
     {
+        // Helpers may still be returning from the previous batches, which does not matter
         boost::unique_lock<boost::mutex> lock(mutex);
-        return (nTotal == nIdle && nTodo == 0 && fAllOk == true);
+        return (nTodo == 0 && fAllOk == true);
     }
 
 };
@@ -21,9 +21,73 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 #include "Lyra2.h"
 #include "Sponge.h"
 
+/**
+ * Allocates the memory matrix and the row pointers of Lyra2 for the given dimensions, so they can be
+ * reused by any number of LYRA2_context calls. On Linux the matrix is aligned to huge pages and
+ * advised to use them, which cuts TLB misses of the random row accesses of the Wandering phase.
+ *
+ * @param ctx Context to initialize
+ * @param nRows Number or rows of the memory matrix (R)
+ * @param nCols Number of columns of the memory matrix (C)
+ *
+ * @return 0 on success; -1 if there is not enough memory
+ */
+int LYRA2_context_init(Lyra2Context *ctx, uint64_t nRows, uint64_t nCols) {
+    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
+    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
+    const size_t matrixSize = (size_t) nRows * (size_t) ROW_LEN_BYTES;
+    uint64_t i;
+
+    ctx->ops = selectSpongeRowOps();
+    ctx->nRows = nRows;
+    ctx->nCols = nCols;
+    ctx->memMatrix = NULL;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (posix_memalign((void **) &ctx->wholeMatrix, LYRA2_HUGE_PAGE_SIZE, matrixSize) != 0)
+      ctx->wholeMatrix = NULL;
+    else
+      madvise(ctx->wholeMatrix, matrixSize, MADV_HUGEPAGE);
+#else
+    ctx->wholeMatrix = malloc(matrixSize);
+#endif
+    if (ctx->wholeMatrix == NULL) {
+      return -1;
+    }
+    memset(ctx->wholeMatrix, 0, matrixSize);
+
+    //Allocates pointers to each row of the matrix
+    ctx->memMatrix = malloc(nRows * sizeof (uint64_t*));
+    if (ctx->memMatrix == NULL) {
+      LYRA2_context_free(ctx);
+      return -1;
+    }
+    //Places the pointers in the correct positions
+    uint64_t *ptrWord = ctx->wholeMatrix;
+    for (i = 0; i < nRows; i++) {
+      ctx->memMatrix[i] = ptrWord;
+      ptrWord += ROW_LEN_INT64;
+    }
+
+    return 0;
+}
+
+/**
+ * Frees the memory held by a context initialized with LYRA2_context_init.
+ */
+void LYRA2_context_free(Lyra2Context *ctx) {
+    free(ctx->memMatrix);
+    free(ctx->wholeMatrix);
+    ctx->memMatrix = NULL;
+    ctx->wholeMatrix = NULL;
+}
+
 /**
  * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
  * whose combined length is smaller than the size of the memory matrix, (i.e., (nRows x nCols x b) bits,
@@ -44,7 +108,27 @@
  * @return 0 if the key is generated correctly; -1 if there is an error (usually due to lack of memory for allocation)
  */
 int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
+    Lyra2Context ctx;
+    int result;
+
+    if (LYRA2_context_init(&ctx, nRows, nCols) != 0) {
+      return -1;
+    }
+    result = LYRA2_context(&ctx, K, kLen, pwd, pwdlen, salt, saltlen, timeCost);
+    LYRA2_context_free(&ctx);
 
+    return result;
+}
+
+/**
+ * Executes Lyra2 like LYRA2 does, using the memory matrix of a context instead of allocating one.
+ * The matrix needs no clearing between calls: every row is written by the Setup phase before it is read.
+ *
+ * @param ctx Context initialized with LYRA2_context_init, giving nRows and nCols
+ *
+ * @return 0 if the key is generated correctly
+ */
+int LYRA2_context(Lyra2Context *ctx, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost) {
     //============================= Basic variables ============================//
     int64_t row = 2; //index of row to be processed
     int64_t prev = 1; //index of prev (last row ever computed/modified)
@@ -56,32 +140,12 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     int64_t i; //auxiliary iteration counter
     //==========================================================================/
 
-    //========== Initializing the Memory Matrix and pointers to it =============//
-    //Tries to allocate enough space for the whole memory matrix
-
-
-    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
-    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
-
-    i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
-    uint64_t *wholeMatrix = malloc(i);
-    if (wholeMatrix == NULL) {
-      return -1;
-    }
-    memset(wholeMatrix, 0, i);
-
-    //Allocates pointers to each row of the matrix
-    uint64_t **memMatrix = malloc(nRows * sizeof (uint64_t*));
-    if (memMatrix == NULL) {
-      return -1;
-    }
-    //Places the pointers in the correct positions
-    uint64_t *ptrWord = wholeMatrix;
-    for (i = 0; i < nRows; i++) {
-      memMatrix[i] = ptrWord;
-      ptrWord += ROW_LEN_INT64;
-    }
-    //==========================================================================/
+    const uint64_t nRows = ctx->nRows;
+    const uint64_t nCols = ctx->nCols;
+    uint64_t *wholeMatrix = ctx->wholeMatrix;
+    uint64_t **memMatrix = ctx->memMatrix;
+    const SpongeRowOps *ops = ctx->ops;
+    uint64_t *ptrWord;
 
     //============= Getting the password + salt + basil padded with 10*1 ===============//
     //OBS.:The memory matrix will temporarily hold the password: not for saving memory,
@@ -123,10 +187,7 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
 
     //======================= Initializing the Sponge State ====================//
     //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
-    uint64_t *state = malloc(16 * sizeof (uint64_t));
-    if (state == NULL) {
-      return -1;
-    }
+    uint64_t *state = ctx->state;
     initState(state);
     //==========================================================================/
 
@@ -139,12 +200,12 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     }
 
     //Initializes M[0] and M[1]
-    reducedSqueezeRow0(state, memMatrix[0], nCols); //The locally copied password is most likely overwritten here
-    reducedDuplexRow1(state, memMatrix[0], memMatrix[1], nCols);
+    ops->reducedSqueezeRow0(state, memMatrix[0], nCols); //The locally copied password is most likely overwritten here
+    ops->reducedDuplexRow1(state, memMatrix[0], memMatrix[1], nCols);
 
     do {
       //M[row] = rand; //M[row*] = M[row*] XOR rotW(rand)
-      reducedDuplexRowSetup(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
+      ops->reducedDuplexRowSetup(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
 
 
       //updates the value of row* (deterministically picked during Setup))
@@ -177,7 +238,7 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
         //------------------------------------------------------------------------------------------
 
         //Performs a reduced-round duplexing operation over M[row*] XOR M[prev], updating both M[row*] and M[row]
-        reducedDuplexRow(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
+        ops->reducedDuplexRow(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
 
         //update prev: it now points to the last row ever computed
         prev = row;
@@ -200,13 +261,8 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     squeeze(state, K, kLen);
     //==========================================================================/
 
-    //========================= Freeing the memory =============================//
-    free(memMatrix);
-    free(wholeMatrix);
-
-    //Wiping out the sponge's internal state before freeing it
+    //======================= Wiping out the sponge state ======================//
     memset(state, 0, 16 * sizeof (uint64_t));
-    free(state);
     //==========================================================================/
 
     return 0;
@@ -37,10 +37,29 @@ typedef unsigned char byte;
         #define BLOCK_LEN_BYTES (BLOCK_LEN_INT64 * 8)    //Block length, in bytes
 #endif
 
+//Alignment of the memory matrix, so it can be backed by transparent huge pages where available
+#define LYRA2_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+struct SpongeRowOps;
+
+//Memory matrix and sponge state of Lyra2, allocated once and reused across hashes
+typedef struct {
+    const struct SpongeRowOps *ops;     //Row operations used for the hot loops, picked for the CPU
+    uint64_t nRows;
+    uint64_t nCols;
+    uint64_t *wholeMatrix;
+    uint64_t **memMatrix;
+    uint64_t state[16];
+} Lyra2Context;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+    int LYRA2_context_init(Lyra2Context *ctx, uint64_t nRows, uint64_t nCols);
+    void LYRA2_context_free(Lyra2Context *ctx);
+    int LYRA2_context(Lyra2Context *ctx, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost);
+
     int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols);
 
 #ifdef __cplusplus
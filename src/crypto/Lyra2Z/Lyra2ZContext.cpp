@@ -0,0 +1,27 @@
+#include "Lyra2ZContext.h"
+
+Lyra2ZContext::Lyra2ZContext() : fInitialized(false)
+{
+}
+
+Lyra2ZContext::~Lyra2ZContext()
+{
+    if (fInitialized)
+        LYRA2_context_free(&ctx);
+}
+
+bool Lyra2ZContext::Hash(const void *header, void *output)
+{
+    if (!fInitialized) {
+        if (LYRA2_context_init(&ctx, N_ROWS, N_COLS) != 0)
+            return false;
+        fInitialized = true;
+    }
+    return LYRA2_context(&ctx, output, 32, header, 80, header, 80, TIME_COST) == 0;
+}
+
+Lyra2ZContext &Lyra2ZContext::ThreadContext()
+{
+    static thread_local Lyra2ZContext context;
+    return context;
+}
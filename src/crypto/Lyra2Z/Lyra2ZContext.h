@@ -0,0 +1,35 @@
+#ifndef LYRA2Z_CONTEXT_H
+#define LYRA2Z_CONTEXT_H
+
+#include "Lyra2.h"
+
+/**
+ * Lyra2Z proof of work hasher: Lyra2 with timeCost 2 over a 330x256 memory matrix, using the 80
+ * byte block header as both password and salt. The matrix (about 8MB) is allocated on first use
+ * and kept, rather than allocated and freed for every hash.
+ */
+class Lyra2ZContext
+{
+public:
+    static const uint64_t TIME_COST = 2;
+    static const uint64_t N_ROWS = 330;
+    static const uint64_t N_COLS = 256;
+
+    Lyra2ZContext();
+    ~Lyra2ZContext();
+
+    /** Hashes an 80 byte block header into 32 bytes. Returns false if the matrix can't be allocated. */
+    bool Hash(const void *header, void *output);
+
+    /** Context owned by the calling thread, freed when the thread exits. */
+    static Lyra2ZContext &ThreadContext();
+
+private:
+    Lyra2Context ctx;
+    bool fInitialized;
+
+    Lyra2ZContext(const Lyra2ZContext &);
+    Lyra2ZContext &operator=(const Lyra2ZContext &);
+};
+
+#endif // LYRA2Z_CONTEXT_H
@@ -92,6 +92,36 @@ void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint
 //---- Misc
 void printArray(unsigned char *array, unsigned int size, char *name);
 
+//---- Row operations, the hot loop of Lyra2, with SIMD implementations picked at run time
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LYRA2_HAVE_SIMD
+#endif
+
+typedef struct SpongeRowOps {
+    const char *name;
+    void (*reducedSqueezeRow0)(uint64_t* state, uint64_t* rowOut, uint64_t nCols);
+    void (*reducedDuplexRow1)(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+    void (*reducedDuplexRowSetup)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+    void (*reducedDuplexRow)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+} SpongeRowOps;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const SpongeRowOps spongeRowOpsGeneric;
+#if defined(LYRA2_HAVE_SIMD)
+extern const SpongeRowOps spongeRowOpsSSSE3;
+extern const SpongeRowOps spongeRowOpsAVX2;
+#endif
+
+//Returns the fastest implementation the CPU supports
+const SpongeRowOps *selectSpongeRowOps(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 
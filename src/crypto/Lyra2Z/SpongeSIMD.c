@@ -0,0 +1,349 @@
+/**
+ * SIMD implementations of the row operations of the Lyra2 sponge (reduced-round Blake2b).
+ * They compute exactly what the portable versions in Sponge.c compute, including the
+ * order of reads and writes when rows alias each other, so hashes are bit-exact.
+ *
+ * The code is compiled with per-function target attributes, so no special compiler flags
+ * are needed and the binary still runs on CPUs without these extensions: selectSpongeRowOps
+ * only hands them out when CPUID reports support.
+ */
+#include <string.h>
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_HAVE_SIMD)
+
+#include <immintrin.h>
+
+//============================== SSSE3 (2 x 64 bits) ==============================//
+
+#define LYRA2_SSSE3 __attribute__((target("ssse3")))
+
+#define ROTR32_SSSE3(x) _mm_shuffle_epi32((x), _MM_SHUFFLE(2,3,0,1))
+#define ROTR24_SSSE3(x) _mm_shuffle_epi8((x), r24)
+#define ROTR16_SSSE3(x) _mm_shuffle_epi8((x), r16)
+#define ROTR63_SSSE3(x) _mm_xor_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+#define G_SSSE3(a,b,c,d) \
+  do { \
+    a = _mm_add_epi64(a, b); d = ROTR32_SSSE3(_mm_xor_si128(d, a)); \
+    c = _mm_add_epi64(c, d); b = ROTR24_SSSE3(_mm_xor_si128(b, c)); \
+    a = _mm_add_epi64(a, b); d = ROTR16_SSSE3(_mm_xor_si128(d, a)); \
+    c = _mm_add_epi64(c, d); b = ROTR63_SSSE3(_mm_xor_si128(b, c)); \
+  } while(0)
+
+/*One round of Blake2b over the state v[0..15] kept in s[0..7], two words per register*/
+#define ROUND_LYRA_SSSE3(s) \
+  do { \
+    __m128i t0, t1; \
+    G_SSSE3(s[0], s[2], s[4], s[6]); \
+    G_SSSE3(s[1], s[3], s[5], s[7]); \
+    t0 = _mm_alignr_epi8(s[3], s[2], 8); t1 = _mm_alignr_epi8(s[2], s[3], 8); s[2] = t0; s[3] = t1; \
+    t0 = s[4]; s[4] = s[5]; s[5] = t0; \
+    t0 = _mm_alignr_epi8(s[7], s[6], 8); t1 = _mm_alignr_epi8(s[6], s[7], 8); s[6] = t1; s[7] = t0; \
+    G_SSSE3(s[0], s[2], s[4], s[6]); \
+    G_SSSE3(s[1], s[3], s[5], s[7]); \
+    t0 = _mm_alignr_epi8(s[2], s[3], 8); t1 = _mm_alignr_epi8(s[3], s[2], 8); s[2] = t0; s[3] = t1; \
+    t0 = s[4]; s[4] = s[5]; s[5] = t0; \
+    t0 = _mm_alignr_epi8(s[6], s[7], 8); t1 = _mm_alignr_epi8(s[7], s[6], 8); s[6] = t1; s[7] = t0; \
+  } while(0)
+
+#define LOAD_STATE_SSSE3(s, state) \
+  do { int k; for (k = 0; k < 8; k++) s[k] = _mm_loadu_si128((const __m128i *) &state[2 * k]); } while(0)
+#define STORE_STATE_SSSE3(s, state) \
+  do { int k; for (k = 0; k < 8; k++) _mm_storeu_si128((__m128i *) &state[2 * k], s[k]); } while(0)
+
+/*rotW(rand) of the first BLOCK_LEN_INT64 words of the state: word k receives word k-1, word 0 receives word 11*/
+#define ROTW_SSSE3(r, s) \
+  do { \
+    r[0] = _mm_alignr_epi8(s[0], s[5], 8); \
+    r[1] = _mm_alignr_epi8(s[1], s[0], 8); \
+    r[2] = _mm_alignr_epi8(s[2], s[1], 8); \
+    r[3] = _mm_alignr_epi8(s[3], s[2], 8); \
+    r[4] = _mm_alignr_epi8(s[4], s[3], 8); \
+    r[5] = _mm_alignr_epi8(s[5], s[4], 8); \
+  } while(0)
+
+LYRA2_SSSE3 static void reducedSqueezeRow0SSSE3(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64;
+    __m128i s[8];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSSE3(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 6; k++)
+        _mm_storeu_si128((__m128i *) &ptrWord[2 * k], s[k]);
+      ptrWord -= BLOCK_LEN_INT64;
+      ROUND_LYRA_SSSE3(s);
+    }
+    STORE_STATE_SSSE3(s, state);
+}
+
+LYRA2_SSSE3 static void reducedDuplexRow1SSSE3(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    uint64_t* ptrWordIn = rowIn;
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64;
+    __m128i s[8], in[6];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSSE3(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 6; k++) {
+        in[k] = _mm_loadu_si128((const __m128i *) &ptrWordIn[2 * k]);
+        s[k] = _mm_xor_si128(s[k], in[k]);
+      }
+      ROUND_LYRA_SSSE3(s);
+      for (k = 0; k < 6; k++)
+        _mm_storeu_si128((__m128i *) &ptrWordOut[2 * k], _mm_xor_si128(in[k], s[k]));
+      ptrWordIn += BLOCK_LEN_INT64;
+      ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_SSSE3(s, state);
+}
+
+LYRA2_SSSE3 static void reducedDuplexRowSetupSSSE3(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    uint64_t* ptrWordIn = rowIn;
+    uint64_t* ptrWordInOut = rowInOut;
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64;
+    __m128i s[8], in[6], r[6];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSSE3(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 6; k++) {
+        in[k] = _mm_loadu_si128((const __m128i *) &ptrWordIn[2 * k]);
+        s[k] = _mm_xor_si128(s[k], _mm_add_epi64(in[k], _mm_loadu_si128((const __m128i *) &ptrWordInOut[2 * k])));
+      }
+      ROUND_LYRA_SSSE3(s);
+      for (k = 0; k < 6; k++)
+        _mm_storeu_si128((__m128i *) &ptrWordOut[2 * k], _mm_xor_si128(in[k], s[k]));
+      ROTW_SSSE3(r, s);
+      for (k = 0; k < 6; k++)
+        _mm_storeu_si128((__m128i *) &ptrWordInOut[2 * k],
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i *) &ptrWordInOut[2 * k]), r[k]));
+      ptrWordInOut += BLOCK_LEN_INT64;
+      ptrWordIn += BLOCK_LEN_INT64;
+      ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_SSSE3(s, state);
+}
+
+LYRA2_SSSE3 static void reducedDuplexRowSSSE3(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    uint64_t* ptrWordInOut = rowInOut;
+    uint64_t* ptrWordIn = rowIn;
+    uint64_t* ptrWordOut = rowOut;
+    __m128i s[8], r[6];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_SSSE3(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 6; k++)
+        s[k] = _mm_xor_si128(s[k], _mm_add_epi64(_mm_loadu_si128((const __m128i *) &ptrWordIn[2 * k]),
+                                                 _mm_loadu_si128((const __m128i *) &ptrWordInOut[2 * k])));
+      ROUND_LYRA_SSSE3(s);
+      for (k = 0; k < 6; k++)
+        _mm_storeu_si128((__m128i *) &ptrWordOut[2 * k],
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i *) &ptrWordOut[2 * k]), s[k]));
+      //rowInOut may be rowOut: read it only after rowOut is written, like the portable code
+      ROTW_SSSE3(r, s);
+      for (k = 0; k < 6; k++)
+        _mm_storeu_si128((__m128i *) &ptrWordInOut[2 * k],
+                         _mm_xor_si128(_mm_loadu_si128((const __m128i *) &ptrWordInOut[2 * k]), r[k]));
+      ptrWordOut += BLOCK_LEN_INT64;
+      ptrWordInOut += BLOCK_LEN_INT64;
+      ptrWordIn += BLOCK_LEN_INT64;
+    }
+    STORE_STATE_SSSE3(s, state);
+}
+
+const SpongeRowOps spongeRowOpsSSSE3 = {
+    "ssse3",
+    reducedSqueezeRow0SSSE3,
+    reducedDuplexRow1SSSE3,
+    reducedDuplexRowSetupSSSE3,
+    reducedDuplexRowSSSE3
+};
+
+//=============================== AVX2 (4 x 64 bits) ===============================//
+
+#define LYRA2_AVX2 __attribute__((target("avx2")))
+
+#define ROTR32_AVX2(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2,3,0,1))
+#define ROTR24_AVX2(x) _mm256_shuffle_epi8((x), r24)
+#define ROTR16_AVX2(x) _mm256_shuffle_epi8((x), r16)
+#define ROTR63_AVX2(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define G_AVX2(a,b,c,d) \
+  do { \
+    a = _mm256_add_epi64(a, b); d = ROTR32_AVX2(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi64(c, d); b = ROTR24_AVX2(_mm256_xor_si256(b, c)); \
+    a = _mm256_add_epi64(a, b); d = ROTR16_AVX2(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi64(c, d); b = ROTR63_AVX2(_mm256_xor_si256(b, c)); \
+  } while(0)
+
+/*One round of Blake2b over the state v[0..15] kept in s[0..3], one row of the 4x4 matrix per register*/
+#define ROUND_LYRA_AVX2(s) \
+  do { \
+    G_AVX2(s[0], s[1], s[2], s[3]); \
+    s[1] = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(0,3,2,1)); \
+    s[2] = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(1,0,3,2)); \
+    s[3] = _mm256_permute4x64_epi64(s[3], _MM_SHUFFLE(2,1,0,3)); \
+    G_AVX2(s[0], s[1], s[2], s[3]); \
+    s[1] = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(2,1,0,3)); \
+    s[2] = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(1,0,3,2)); \
+    s[3] = _mm256_permute4x64_epi64(s[3], _MM_SHUFFLE(0,3,2,1)); \
+  } while(0)
+
+#define LOAD_STATE_AVX2(s, state) \
+  do { int k; for (k = 0; k < 4; k++) s[k] = _mm256_loadu_si256((const __m256i *) &state[4 * k]); } while(0)
+#define STORE_STATE_AVX2(s, state) \
+  do { int k; for (k = 0; k < 4; k++) _mm256_storeu_si256((__m256i *) &state[4 * k], s[k]); } while(0)
+
+/*rotW(rand): every register is rotated up by one word, then the word shifted out of the
+  previous register is blended into lane 0*/
+#define ROTW_AVX2(r, s) \
+  do { \
+    __m256i p0 = _mm256_permute4x64_epi64(s[0], _MM_SHUFFLE(2,1,0,3)); \
+    __m256i p1 = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(2,1,0,3)); \
+    __m256i p2 = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(2,1,0,3)); \
+    r[0] = _mm256_blend_epi32(p0, p2, 0x03); \
+    r[1] = _mm256_blend_epi32(p1, p0, 0x03); \
+    r[2] = _mm256_blend_epi32(p2, p1, 0x03); \
+  } while(0)
+
+#define DECLARE_ROTATIONS_AVX2 \
+    const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, \
+                                         2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9); \
+    const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, \
+                                         3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10)
+
+LYRA2_AVX2 static void reducedSqueezeRow0AVX2(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    DECLARE_ROTATIONS_AVX2;
+    uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64;
+    __m256i s[4];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 3; k++)
+        _mm256_storeu_si256((__m256i *) &ptrWord[4 * k], s[k]);
+      ptrWord -= BLOCK_LEN_INT64;
+      ROUND_LYRA_AVX2(s);
+    }
+    STORE_STATE_AVX2(s, state);
+}
+
+LYRA2_AVX2 static void reducedDuplexRow1AVX2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    DECLARE_ROTATIONS_AVX2;
+    uint64_t* ptrWordIn = rowIn;
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64;
+    __m256i s[4], in[3];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 3; k++) {
+        in[k] = _mm256_loadu_si256((const __m256i *) &ptrWordIn[4 * k]);
+        s[k] = _mm256_xor_si256(s[k], in[k]);
+      }
+      ROUND_LYRA_AVX2(s);
+      for (k = 0; k < 3; k++)
+        _mm256_storeu_si256((__m256i *) &ptrWordOut[4 * k], _mm256_xor_si256(in[k], s[k]));
+      ptrWordIn += BLOCK_LEN_INT64;
+      ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_AVX2(s, state);
+}
+
+LYRA2_AVX2 static void reducedDuplexRowSetupAVX2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    DECLARE_ROTATIONS_AVX2;
+    uint64_t* ptrWordIn = rowIn;
+    uint64_t* ptrWordInOut = rowInOut;
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64;
+    __m256i s[4], in[3], r[3];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 3; k++) {
+        in[k] = _mm256_loadu_si256((const __m256i *) &ptrWordIn[4 * k]);
+        s[k] = _mm256_xor_si256(s[k], _mm256_add_epi64(in[k], _mm256_loadu_si256((const __m256i *) &ptrWordInOut[4 * k])));
+      }
+      ROUND_LYRA_AVX2(s);
+      for (k = 0; k < 3; k++)
+        _mm256_storeu_si256((__m256i *) &ptrWordOut[4 * k], _mm256_xor_si256(in[k], s[k]));
+      ROTW_AVX2(r, s);
+      for (k = 0; k < 3; k++)
+        _mm256_storeu_si256((__m256i *) &ptrWordInOut[4 * k],
+                            _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &ptrWordInOut[4 * k]), r[k]));
+      ptrWordInOut += BLOCK_LEN_INT64;
+      ptrWordIn += BLOCK_LEN_INT64;
+      ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    STORE_STATE_AVX2(s, state);
+}
+
+LYRA2_AVX2 static void reducedDuplexRowAVX2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    DECLARE_ROTATIONS_AVX2;
+    uint64_t* ptrWordInOut = rowInOut;
+    uint64_t* ptrWordIn = rowIn;
+    uint64_t* ptrWordOut = rowOut;
+    __m256i s[4], r[3];
+    uint64_t i;
+    int k;
+
+    LOAD_STATE_AVX2(s, state);
+    for (i = 0; i < nCols; i++) {
+      for (k = 0; k < 3; k++)
+        s[k] = _mm256_xor_si256(s[k], _mm256_add_epi64(_mm256_loadu_si256((const __m256i *) &ptrWordIn[4 * k]),
+                                                       _mm256_loadu_si256((const __m256i *) &ptrWordInOut[4 * k])));
+      ROUND_LYRA_AVX2(s);
+      for (k = 0; k < 3; k++)
+        _mm256_storeu_si256((__m256i *) &ptrWordOut[4 * k],
+                            _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &ptrWordOut[4 * k]), s[k]));
+      //rowInOut may be rowOut: read it only after rowOut is written, like the portable code
+      ROTW_AVX2(r, s);
+      for (k = 0; k < 3; k++)
+        _mm256_storeu_si256((__m256i *) &ptrWordInOut[4 * k],
+                            _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &ptrWordInOut[4 * k]), r[k]));
+      ptrWordOut += BLOCK_LEN_INT64;
+      ptrWordInOut += BLOCK_LEN_INT64;
+      ptrWordIn += BLOCK_LEN_INT64;
+    }
+    STORE_STATE_AVX2(s, state);
+}
+
+const SpongeRowOps spongeRowOpsAVX2 = {
+    "avx2",
+    reducedSqueezeRow0AVX2,
+    reducedDuplexRow1AVX2,
+    reducedDuplexRowSetupAVX2,
+    reducedDuplexRowAVX2
+};
+
+#endif // LYRA2_HAVE_SIMD
+
+const SpongeRowOps *selectSpongeRowOps(void) {
+#if defined(LYRA2_HAVE_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return &spongeRowOpsAVX2;
+    if (__builtin_cpu_supports("ssse3"))
+      return &spongeRowOpsSSSE3;
+#endif
+    return &spongeRowOpsGeneric;
+}
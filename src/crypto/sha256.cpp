@@ -6,8 +6,15 @@
 
 #include "crypto/common.h"
 
+#include <algorithm>
+#include <assert.h>
 #include <string.h>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_HAVE_LANES
+#include <immintrin.h>
+#endif
+
 // Internal implementation code.
 namespace
 {
@@ -127,6 +134,160 @@ void Transform(uint32_t* s, const unsigned char* chunk)
     s[7] += h;
 }
 
+/** Round constants, for the multi-lane transforms below. */
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+/**
+ * Multi-lane transforms: SHA-256 of several independent chunks at once, one per lane. State and
+ * message words are stored word-major (s[word][lane]) and the message words are already decoded.
+ */
+void TransformLanes1(uint32_t s[8][1], const uint32_t w[16][1])
+{
+    unsigned char chunk[64];
+    for (int i = 0; i < 16; i++)
+        WriteBE32(chunk + 4 * i, w[i][0]);
+    uint32_t state[8];
+    for (int i = 0; i < 8; i++)
+        state[i] = s[i][0];
+    Transform(state, chunk);
+    for (int i = 0; i < 8; i++)
+        s[i][0] = state[i];
+}
+
+#if defined(SHA256_HAVE_LANES)
+
+#define SHA256_SSE2 __attribute__((target("sse2")))
+
+SHA256_SSE2 inline __m128i Ror4(__m128i x, int n) { return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n)); }
+
+SHA256_SSE2 void TransformLanes4(uint32_t s[8][4], const uint32_t chunk[16][4])
+{
+    __m128i v[8], w[16];
+    for (int i = 0; i < 8; i++)
+        v[i] = _mm_loadu_si128((const __m128i*)s[i]);
+    for (int i = 0; i < 16; i++)
+        w[i] = _mm_loadu_si128((const __m128i*)chunk[i]);
+
+    __m128i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+    for (int t = 0; t < 64; t++) {
+        if (t >= 16) {
+            __m128i w2 = w[(t - 2) & 15], w15 = w[(t - 15) & 15];
+            __m128i s1 = _mm_xor_si128(_mm_xor_si128(Ror4(w2, 17), Ror4(w2, 19)), _mm_srli_epi32(w2, 10));
+            __m128i s0 = _mm_xor_si128(_mm_xor_si128(Ror4(w15, 7), Ror4(w15, 18)), _mm_srli_epi32(w15, 3));
+            w[t & 15] = _mm_add_epi32(_mm_add_epi32(w[t & 15], s0), _mm_add_epi32(s1, w[(t - 7) & 15]));
+        }
+        __m128i S1 = _mm_xor_si128(_mm_xor_si128(Ror4(e, 6), Ror4(e, 11)), Ror4(e, 25));
+        __m128i ch = _mm_xor_si128(g, _mm_and_si128(e, _mm_xor_si128(f, g)));
+        __m128i t1 = _mm_add_epi32(_mm_add_epi32(h, S1), _mm_add_epi32(ch, _mm_add_epi32(_mm_set1_epi32(K[t]), w[t & 15])));
+        __m128i S0 = _mm_xor_si128(_mm_xor_si128(Ror4(a, 2), Ror4(a, 13)), Ror4(a, 22));
+        __m128i maj = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(c, _mm_or_si128(a, b)));
+        h = g; g = f; f = e; e = _mm_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm_add_epi32(t1, _mm_add_epi32(S0, maj));
+    }
+
+    _mm_storeu_si128((__m128i*)s[0], _mm_add_epi32(v[0], a));
+    _mm_storeu_si128((__m128i*)s[1], _mm_add_epi32(v[1], b));
+    _mm_storeu_si128((__m128i*)s[2], _mm_add_epi32(v[2], c));
+    _mm_storeu_si128((__m128i*)s[3], _mm_add_epi32(v[3], d));
+    _mm_storeu_si128((__m128i*)s[4], _mm_add_epi32(v[4], e));
+    _mm_storeu_si128((__m128i*)s[5], _mm_add_epi32(v[5], f));
+    _mm_storeu_si128((__m128i*)s[6], _mm_add_epi32(v[6], g));
+    _mm_storeu_si128((__m128i*)s[7], _mm_add_epi32(v[7], h));
+}
+
+#define SHA256_AVX2 __attribute__((target("avx2")))
+
+SHA256_AVX2 inline __m256i Ror8(__m256i x, int n) { return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n)); }
+
+SHA256_AVX2 void TransformLanes8(uint32_t s[8][8], const uint32_t chunk[16][8])
+{
+    __m256i v[8], w[16];
+    for (int i = 0; i < 8; i++)
+        v[i] = _mm256_loadu_si256((const __m256i*)s[i]);
+    for (int i = 0; i < 16; i++)
+        w[i] = _mm256_loadu_si256((const __m256i*)chunk[i]);
+
+    __m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+    for (int t = 0; t < 64; t++) {
+        if (t >= 16) {
+            __m256i w2 = w[(t - 2) & 15], w15 = w[(t - 15) & 15];
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(Ror8(w2, 17), Ror8(w2, 19)), _mm256_srli_epi32(w2, 10));
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(Ror8(w15, 7), Ror8(w15, 18)), _mm256_srli_epi32(w15, 3));
+            w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(s1, w[(t - 7) & 15]));
+        }
+        __m256i S1 = _mm256_xor_si256(_mm256_xor_si256(Ror8(e, 6), Ror8(e, 11)), Ror8(e, 25));
+        __m256i ch = _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g)));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(K[t]), w[t & 15])));
+        __m256i S0 = _mm256_xor_si256(_mm256_xor_si256(Ror8(a, 2), Ror8(a, 13)), Ror8(a, 22));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm256_add_epi32(t1, _mm256_add_epi32(S0, maj));
+    }
+
+    _mm256_storeu_si256((__m256i*)s[0], _mm256_add_epi32(v[0], a));
+    _mm256_storeu_si256((__m256i*)s[1], _mm256_add_epi32(v[1], b));
+    _mm256_storeu_si256((__m256i*)s[2], _mm256_add_epi32(v[2], c));
+    _mm256_storeu_si256((__m256i*)s[3], _mm256_add_epi32(v[3], d));
+    _mm256_storeu_si256((__m256i*)s[4], _mm256_add_epi32(v[4], e));
+    _mm256_storeu_si256((__m256i*)s[5], _mm256_add_epi32(v[5], f));
+    _mm256_storeu_si256((__m256i*)s[6], _mm256_add_epi32(v[6], g));
+    _mm256_storeu_si256((__m256i*)s[7], _mm256_add_epi32(v[7], h));
+}
+
+#endif // SHA256_HAVE_LANES
+
+/** Double SHA-256 of messages that continue the midstate with one tail block each, LANES at a time. */
+template <size_t LANES>
+void HashTailsD(void (*transform)(uint32_t[8][LANES], const uint32_t[16][LANES]), unsigned char* out, const uint32_t midstate[8], const unsigned char* tails, size_t tailLen, size_t n)
+{
+    uint32_t s[8][LANES], w[16][LANES];
+    unsigned char block[56] = {0};
+    block[tailLen] = 0x80;
+
+    for (size_t base = 0; base < n; base += LANES) {
+        // First hash: the tail block of each message, with spare lanes repeating the last message
+        for (size_t l = 0; l < LANES; l++) {
+            memcpy(block, tails + std::min(base + l, n - 1) * tailLen, tailLen);
+            for (int i = 0; i < 14; i++)
+                w[i][l] = ReadBE32(block + 4 * i);
+            w[14][l] = 0;
+            w[15][l] = (64 + tailLen) * 8;
+            for (int i = 0; i < 8; i++)
+                s[i][l] = midstate[i];
+        }
+        transform(s, w);
+
+        // Second hash: the 32-byte digest, padded to one block
+        for (size_t l = 0; l < LANES; l++) {
+            for (int i = 0; i < 8; i++)
+                w[i][l] = s[i][l];
+            w[8][l] = 0x80000000ul;
+            for (int i = 9; i < 15; i++)
+                w[i][l] = 0;
+            w[15][l] = 256;
+        }
+        for (size_t l = 0; l < LANES; l++) {
+            uint32_t init[8];
+            Initialize(init);
+            for (int i = 0; i < 8; i++)
+                s[i][l] = init[i];
+        }
+        transform(s, w);
+
+        for (size_t l = 0; l < LANES && base + l < n; l++)
+            for (int i = 0; i < 8; i++)
+                WriteBE32(out + (base + l) * 32 + 4 * i, s[i][l]);
+    }
+}
+
 } // namespace sha256
 } // namespace
 
@@ -187,3 +348,23 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+void SHA256DSharedPrefix(unsigned char* out, const unsigned char prefix[64], const unsigned char* tails, size_t tailLen, size_t n)
+{
+    assert(tailLen <= 55);
+    if (n == 0)
+        return;
+
+    uint32_t midstate[8];
+    sha256::Initialize(midstate);
+    sha256::Transform(midstate, prefix);
+
+#if defined(SHA256_HAVE_LANES)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return sha256::HashTailsD<8>(sha256::TransformLanes8, out, midstate, tails, tailLen, n);
+    if (__builtin_cpu_supports("sse2"))
+        return sha256::HashTailsD<4>(sha256::TransformLanes4, out, midstate, tails, tailLen, n);
+#endif
+    sha256::HashTailsD<1>(sha256::TransformLanes1, out, midstate, tails, tailLen, n);
+}
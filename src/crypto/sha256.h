@@ -25,4 +25,11 @@ public:
     CSHA256& Reset();
 };
 
+/**
+ * Double SHA-256 of n messages that share the 64-byte prefix and end in distinct tails of tailLen
+ * (at most 55) bytes, stored back to back in tails. Writes the n 32-byte hashes to out. The prefix
+ * is compressed once, and the tails are hashed 8 or 4 at a time on CPUs with AVX2 or SSE2.
+ */
+void SHA256DSharedPrefix(unsigned char* out, const unsigned char prefix[64], const unsigned char* tails, size_t tailLen, size_t n);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -21,14 +21,17 @@
 #include "key.h"
 #include "main.h"
 #include "zerocoin.h"
+#include "sigma.h"
 #include "miner.h"
 #include "net.h"
 #include "policy/policy.h"
+#include "powhashindex.h"
 #include "rpc/server.h"
 #include "rpc/register.h"
 #include "script/standard.h"
 #include "script/sigcache.h"
 #include "scheduler.h"
+#include "taskpool.h"
 #include "timedata.h"
 #include "txdb.h"
 #include "txmempool.h"
@@ -252,6 +255,7 @@ void PrepareShutdown(){
 
     StopTorControl();
     UnregisterNodeSignals(GetNodeSignals());
+    taskPool.Stop();
 
     if (fFeeEstimatesInitialized) {
         boost::filesystem::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
@@ -277,6 +281,7 @@ void PrepareShutdown(){
         delete pblocktree;
         pblocktree = NULL;
     }
+    powHashIndex.Close();
 #ifdef ENABLE_WALLET
     if (pwalletMain)
         pwalletMain->Flush(true);
@@ -389,8 +394,10 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
-    strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
+    strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-sigmaprecompmem=<n>", strprintf(_("Set the memory for precomputed sigma generator tables in megabytes (0 to disable, default: %u)"),
+        sigma::DEFAULT_FIXED_BASE_MEMORY >> 20));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
@@ -463,6 +470,8 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubrawsigmamint=<address>", _("Enable publish raw sigma mints of connected blocks in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubsigmaspendserial=<address>", _("Enable publish sigma spend serials of connected blocks in <address>"));
 #endif
 
     strUsage += HelpMessageGroup(_("Debugging/Testing options:"));
@@ -505,6 +514,7 @@ std::string HelpMessage(HelpMessageMode mode) {
         strUsage += HelpMessageOpt("-limitfreerelay=<n>", strprintf("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default: %u)", DEFAULT_LIMITFREERELAY));
         strUsage += HelpMessageOpt("-relaypriority", strprintf("Require high priority for relaying free or low-fee transactions (default: %u)", DEFAULT_RELAYPRIORITY));
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit size of signature cache to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxsigmaproofcachesize=<n>", strprintf("Limit size of sigma proof cache to <n> MiB (default: %u)", sigma::DEFAULT_MAX_SIGMA_PROOF_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
     strUsage += HelpMessageOpt("-minrelaytxfee=<amt>", strprintf(_("Fees (in %s/kB) smaller than this are considered zero fee for relaying, mining and transaction creation (default: %s)"),
@@ -1076,6 +1086,9 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    int64_t nSigmaPrecompMem = GetArg("-sigmaprecompmem", sigma::DEFAULT_FIXED_BASE_MEMORY >> 20);
+    sigma::Params::set_fixed_base_memory(std::max<int64_t>(nSigmaPrecompMem, 0) << 20);
+
     fServer = GetBoolArg("-server", false);
 
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
@@ -1233,10 +1246,9 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     std::ostringstream strErrors;
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
-    if (nScriptCheckThreads) {
-        for (int i=0; i<nScriptCheckThreads-1; i++)
-            threadGroup.create_thread(&ThreadScriptCheck);
-    }
+    // The thread waiting for parallel work is the last worker
+    if (nScriptCheckThreads)
+        taskPool.Start(nScriptCheckThreads - 1);
 
     // Start the lightweight task scheduler thread
     CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue, &scheduler);
@@ -1500,6 +1512,10 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set\n", nCoinCacheUsage * (1.0 / 1024 / 1024));
 
+    // The PoW hash index outlives -reindex: it is keyed by block hash, so it stays valid for any block files
+    if (!powHashIndex.Open(GetDataDir() / POW_HASH_INDEX_FILENAME))
+        LogPrintf("Failed to open the PoW hash index, headers will be hashed on every validation\n");
+
     bool fLoaded = false;
     while (!fLoaded) {
         bool fReset = fReindex;
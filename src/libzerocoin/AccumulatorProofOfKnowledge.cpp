@@ -11,6 +11,7 @@
  **/
 
 #include "Zerocoin.h"
+#include "FixedBaseExp.h"
 
 namespace libzerocoin {
 
@@ -144,37 +145,45 @@ namespace libzerocoin {
 
         Bignum c = Bignum(hasher.GetHash()); //this hash should be of length k_prime bits
 
-        Bignum st_1_prime = (valueOfCommitmentToCoin.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sg.pow_mod(s_alpha, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_phi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_2_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) * ((valueOfCommitmentToCoin *
-                                                                                              sg.inverse(
-                                                                                                      params->accumulatorPoKCommitmentGroup.modulus)).pow_mod(
-                s_gamma, params->accumulatorPoKCommitmentGroup.modulus)) *
-                             sh.pow_mod(s_psi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_3_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             (sg * valueOfCommitmentToCoin).pow_mod(s_sigma,
-                                                                    params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_xi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
+        // Powers of the generators come from precomputed tables, the other bases share the
+        // Montgomery contexts of the moduli. (h^-1)^s is computed as h^-s.
+        const Bignum &pokModulus = params->accumulatorPoKCommitmentGroup.modulus;
+        std::shared_ptr<const MontgomeryModulus> pok = MontgomeryModulus::Get(pokModulus);
+        std::shared_ptr<const FixedBaseExp> sgExp = FixedBaseExp::Get(sg, pokModulus);
+        std::shared_ptr<const FixedBaseExp> shExp = FixedBaseExp::Get(sh, pokModulus);
+
+        std::shared_ptr<const MontgomeryModulus> accumulator = MontgomeryModulus::Get(params->accumulatorModulus);
+        std::shared_ptr<const FixedBaseExp> gnExp = FixedBaseExp::Get(g_n, params->accumulatorModulus);
+        std::shared_ptr<const FixedBaseExp> hnExp = FixedBaseExp::Get(h_n, params->accumulatorModulus);
+
+        Bignum st_1_prime = (pok->pow_mod(valueOfCommitmentToCoin, c) *
+                             sgExp->pow_mod(s_alpha) *
+                             shExp->pow_mod(s_phi)) %
+                            pokModulus;
+        Bignum st_2_prime = (sgExp->pow_mod(c) *
+                             pok->pow_mod(valueOfCommitmentToCoin * sg.inverse(pokModulus), s_gamma) *
+                             shExp->pow_mod(s_psi)) %
+                            pokModulus;
+        Bignum st_3_prime = (sgExp->pow_mod(c) *
+                             pok->pow_mod(sg * valueOfCommitmentToCoin, s_sigma) *
+                             shExp->pow_mod(s_xi)) %
+                            pokModulus;
 
         Bignum t_1_prime =
-                (C_r.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_zeta, params->accumulatorModulus) *
-                 g_n.pow_mod(s_epsilon, params->accumulatorModulus)) % params->accumulatorModulus;
+                (accumulator->pow_mod(C_r, c) * hnExp->pow_mod(s_zeta) *
+                 gnExp->pow_mod(s_epsilon)) % params->accumulatorModulus;
         Bignum t_2_prime =
-                (C_e.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_eta, params->accumulatorModulus) *
-                 g_n.pow_mod(s_alpha, params->accumulatorModulus)) % params->accumulatorModulus;
+                (accumulator->pow_mod(C_e, c) * hnExp->pow_mod(s_eta) *
+                 gnExp->pow_mod(s_alpha)) % params->accumulatorModulus;
 
-        Bignum t_3_prime = ((a.getValue()).pow_mod(c, params->accumulatorModulus) *
-                            C_u.pow_mod(s_alpha, params->accumulatorModulus) *
-                            ((h_n.inverse(params->accumulatorModulus)).pow_mod(s_beta, params->accumulatorModulus))) %
+        Bignum t_3_prime = (accumulator->pow_mod(a.getValue(), c) *
+                            accumulator->pow_mod(C_u, s_alpha) *
+                            hnExp->pow_mod(-s_beta)) %
                            params->accumulatorModulus;
 
-        Bignum t_4_prime = (C_r.pow_mod(s_alpha, params->accumulatorModulus) *
-                            ((h_n.inverse(params->accumulatorModulus)).pow_mod(s_delta, params->accumulatorModulus)) *
-                            ((g_n.inverse(params->accumulatorModulus)).pow_mod(s_beta, params->accumulatorModulus))) %
+        Bignum t_4_prime = (accumulator->pow_mod(C_r, s_alpha) *
+                            hnExp->pow_mod(-s_delta) *
+                            gnExp->pow_mod(-s_beta)) %
                            params->accumulatorModulus;
 
         bool result = false;
@@ -0,0 +1,153 @@
+#include "FixedBaseExp.h"
+
+#include <map>
+#include <mutex>
+
+namespace libzerocoin {
+
+// Caches are keyed by value, and only ever hold the moduli and generators of the parameters
+// in use, so they are just dropped if they grow past this
+static const size_t MAX_CACHED = 64;
+
+// One BN_CTX per thread instead of one per operation
+static BN_CTX* ThreadContext() {
+    static thread_local CAutoBN_CTX pctx;
+    return pctx;
+}
+
+MontgomeryModulus::MontgomeryModulus(const Bignum& modulusIn) : modulus(modulusIn), mont(NULL) {
+    if (!BN_is_odd(&modulus))
+        return;
+    mont = BN_MONT_CTX_new();
+    if (!mont || !BN_MONT_CTX_set(mont, &modulus, ThreadContext())) {
+        BN_MONT_CTX_free(mont);
+        throw bignum_error("MontgomeryModulus : BN_MONT_CTX_set failed");
+    }
+}
+
+MontgomeryModulus::~MontgomeryModulus() {
+    BN_MONT_CTX_free(mont);
+}
+
+Bignum MontgomeryModulus::pow_mod(const Bignum& base, const Bignum& e) const {
+    if (!mont)
+        return base.pow_mod(e, modulus);
+    // g^-x = (g^-1)^x
+    if (e < 0)
+        return pow_mod(base.inverse(modulus), e * -1);
+
+    Bignum ret;
+    if (!BN_mod_exp_mont(&ret, &base, &e, &modulus, ThreadContext(), mont))
+        throw bignum_error("MontgomeryModulus::pow_mod : BN_mod_exp_mont failed");
+    return ret;
+}
+
+std::shared_ptr<const MontgomeryModulus> MontgomeryModulus::Get(const Bignum& modulus) {
+    static std::mutex cs;
+    static std::map<std::vector<unsigned char>, std::shared_ptr<const MontgomeryModulus>> cache;
+
+    std::vector<unsigned char> key = modulus.getvch();
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = cache.find(key);
+    if (it != cache.end())
+        return it->second;
+
+    if (cache.size() >= MAX_CACHED)
+        cache.clear();
+    std::shared_ptr<const MontgomeryModulus> mont = std::make_shared<MontgomeryModulus>(modulus);
+    cache.emplace(std::move(key), mont);
+    return mont;
+}
+
+FixedBaseExp::FixedBaseExp(const Bignum& baseIn, const Bignum& modulus)
+    : mont(MontgomeryModulus::Get(modulus)), base(baseIn), nMaxBits(0) {
+    BN_MONT_CTX* ctx = mont->getContext();
+    if (!ctx)
+        return;
+
+    BN_CTX* pctx = ThreadContext();
+    Bignum power;
+    if (!BN_nnmod(&power, &base, &modulus, pctx) || !BN_to_montgomery(&power, &power, ctx, pctx))
+        throw bignum_error("FixedBaseExp : BN_to_montgomery failed");
+
+    nMaxBits = 2 * modulus.bitSize();
+    table.resize((nMaxBits + WINDOW_BITS - 1) / WINDOW_BITS);
+    for (size_t i = 0; i < table.size(); i++) {
+        if (i > 0) {
+            for (int j = 0; j < WINDOW_BITS; j++) {
+                if (!BN_mod_mul_montgomery(&power, &power, &power, ctx, pctx))
+                    throw bignum_error("FixedBaseExp : BN_mod_mul_montgomery failed");
+            }
+        }
+        table[i] = power;
+    }
+}
+
+Bignum FixedBaseExp::pow_mod(const Bignum& e) const {
+    const Bignum& modulus = mont->getModulus();
+    if (table.empty() || e == 0 || e.bitSize() > nMaxBits)
+        return mont->pow_mod(base, e);
+    // (g^-1)^x = (g^x)^-1
+    if (e < 0)
+        return pow_mod(e * -1).inverse(modulus);
+
+    std::vector<unsigned char> digits((e.bitSize() + WINDOW_BITS - 1) / WINDOW_BITS);
+    for (size_t i = 0; i < digits.size(); i++) {
+        for (int j = 0; j < WINDOW_BITS; j++) {
+            if (BN_is_bit_set(&e, i * WINDOW_BITS + j))
+                digits[i] |= 1 << j;
+        }
+    }
+
+    // With e = sum d_i 2^(5i), b_d is the product of the powers whose digit is at least d and
+    // base^e the product of all b_d
+    BN_MONT_CTX* ctx = mont->getContext();
+    BN_CTX* pctx = ThreadContext();
+    Bignum product, result;
+    bool fProduct = false, fResult = false;
+    for (int d = (1 << WINDOW_BITS) - 1; d > 0; d--) {
+        for (size_t i = 0; i < digits.size(); i++) {
+            if (digits[i] != d)
+                continue;
+            if (!fProduct)
+                product = table[i];
+            else if (!BN_mod_mul_montgomery(&product, &product, &table[i], ctx, pctx))
+                throw bignum_error("FixedBaseExp::pow_mod : BN_mod_mul_montgomery failed");
+            fProduct = true;
+        }
+        if (!fProduct)
+            continue;
+        if (!fResult)
+            result = product;
+        else if (!BN_mod_mul_montgomery(&result, &result, &product, ctx, pctx))
+            throw bignum_error("FixedBaseExp::pow_mod : BN_mod_mul_montgomery failed");
+        fResult = true;
+    }
+
+    Bignum ret;
+    if (!BN_from_montgomery(&ret, &result, ctx, pctx))
+        throw bignum_error("FixedBaseExp::pow_mod : BN_from_montgomery failed");
+    return ret;
+}
+
+std::shared_ptr<const FixedBaseExp> FixedBaseExp::Get(const Bignum& base, const Bignum& modulus) {
+    static std::mutex cs;
+    static std::map<std::pair<std::vector<unsigned char>, std::vector<unsigned char>>, std::shared_ptr<const FixedBaseExp>> cache;
+
+    std::pair<std::vector<unsigned char>, std::vector<unsigned char>> key(base.getvch(), modulus.getvch());
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        auto it = cache.find(key);
+        if (it != cache.end())
+            return it->second;
+    }
+
+    // Built outside the lock, a thread racing on the same table keeps the first one stored
+    std::shared_ptr<const FixedBaseExp> exp = std::make_shared<FixedBaseExp>(base, modulus);
+    std::lock_guard<std::mutex> lock(cs);
+    if (cache.size() >= MAX_CACHED)
+        cache.clear();
+    return cache.emplace(std::move(key), exp).first->second;
+}
+
+} /* namespace libzerocoin */
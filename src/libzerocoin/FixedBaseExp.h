@@ -0,0 +1,64 @@
+#ifndef FIXEDBASEEXP_H
+#define FIXEDBASEEXP_H
+
+#include <memory>
+#include <vector>
+
+#include <openssl/bn.h>
+
+#include "Zerocoin.h"
+
+namespace libzerocoin {
+
+// Montgomery context of an odd modulus, shared by all the exponentiations against it. Even
+// moduli have no context and use CBigNum::pow_mod.
+class MontgomeryModulus {
+public:
+    explicit MontgomeryModulus(const Bignum& modulusIn);
+    ~MontgomeryModulus();
+
+    // base^e mod modulus, same as base.pow_mod(e, modulus)
+    Bignum pow_mod(const Bignum& base, const Bignum& e) const;
+
+    const Bignum& getModulus() const { return modulus; }
+    BN_MONT_CTX* getContext() const { return mont; }
+
+    // Context of modulus, created on first use
+    static std::shared_ptr<const MontgomeryModulus> Get(const Bignum& modulus);
+
+private:
+    MontgomeryModulus(const MontgomeryModulus&);
+    MontgomeryModulus& operator=(const MontgomeryModulus&);
+
+    Bignum modulus;
+    BN_MONT_CTX* mont;
+};
+
+// Exponentiation of a fixed base, such as a group generator from Params, by precomputed powers.
+//
+// The table holds base^(2^(5i)) in Montgomery form for exponents up to twice the size of the
+// modulus, and base^e is then computed with one multiplication per 5-bit digit of e plus 62
+// (Brickell et al.'s method), instead of a squaring per bit. The table of a 2048-bit modulus
+// takes 210KB. Longer exponents go through the Montgomery context of the modulus.
+class FixedBaseExp {
+public:
+    FixedBaseExp(const Bignum& baseIn, const Bignum& modulus);
+
+    // base^e mod modulus, same as base.pow_mod(e, modulus)
+    Bignum pow_mod(const Bignum& e) const;
+
+    // Table of base mod modulus, created on first use
+    static std::shared_ptr<const FixedBaseExp> Get(const Bignum& base, const Bignum& modulus);
+
+private:
+    static const int WINDOW_BITS = 5;
+
+    std::shared_ptr<const MontgomeryModulus> mont;
+    Bignum base;
+    int nMaxBits;
+    std::vector<Bignum> table;
+};
+
+} /* namespace libzerocoin */
+
+#endif // FIXEDBASEEXP_H
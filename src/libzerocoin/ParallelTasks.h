@@ -3,18 +3,18 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
 
-#define BOOST_THREAD_PROVIDES_FUTURE
-
-
-#include <boost/thread/future.hpp>
 #include <boost/thread.hpp>
 
+#include "../taskpool.h"
+
 namespace libzerocoin {
 
+// Runs proof computations on the node's task pool
 class ParallelTasks {
 private:
-    vector<boost::future<void>> tasks;
+    std::unique_ptr<CTaskGroup> group;
 
 public:
     ParallelTasks(int n=0);
@@ -12,6 +12,7 @@
 
 #include "Zerocoin.h"
 #include "ParallelTasks.h"
+#include "FixedBaseExp.h"
 
 namespace libzerocoin {
 
@@ -98,15 +99,13 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
 inline Bignum SerialNumberSignatureOfKnowledge::challengeCalculation(const Bignum& a_exp,const Bignum& b_exp,
         const Bignum& h_exp) const {
 
-	Bignum a = params->coinCommitmentGroup.g;
-	Bignum b = params->coinCommitmentGroup.h;
-	Bignum g = params->serialNumberSoKCommitmentGroup.g;
-	Bignum h = params->serialNumberSoKCommitmentGroup.h;
+	const IntegerGroupParams& group = params->serialNumberSoKCommitmentGroup;
 
-	Bignum exponent = (a.pow_mod(a_exp, params->serialNumberSoKCommitmentGroup.groupOrder)
-	                   * b.pow_mod(b_exp, params->serialNumberSoKCommitmentGroup.groupOrder)) % params->serialNumberSoKCommitmentGroup.groupOrder;
+	// The generators are fixed, so their powers come from precomputed tables
+	Bignum exponent = (FixedBaseExp::Get(params->coinCommitmentGroup.g, group.groupOrder)->pow_mod(a_exp)
+	                   * FixedBaseExp::Get(params->coinCommitmentGroup.h, group.groupOrder)->pow_mod(b_exp)) % group.groupOrder;
 
-	return (g.pow_mod(exponent, params->serialNumberSoKCommitmentGroup.modulus) * h.pow_mod(h_exp, params->serialNumberSoKCommitmentGroup.modulus)) % params->serialNumberSoKCommitmentGroup.modulus;
+	return (FixedBaseExp::Get(group.g, group.modulus)->pow_mod(exponent) * FixedBaseExp::Get(group.h, group.modulus)->pow_mod(h_exp)) % group.modulus;
 }
 
 bool SerialNumberSignatureOfKnowledge::Verify(const Bignum& coinSerialNumber, const Bignum& valueOfCommitmentToCoin,
@@ -133,19 +132,23 @@ bool SerialNumberSignatureOfKnowledge::Verify(const Bignum& coinSerialNumber, co
 	vector<CBigNum> tprime(params->zkp_iterations);
 	unsigned char *hashbytes = (unsigned char*) &this->hash;
 
+    std::shared_ptr<const FixedBaseExp> bExp = FixedBaseExp::Get(b, params->serialNumberSoKCommitmentGroup.groupOrder);
+    std::shared_ptr<const FixedBaseExp> hExp = FixedBaseExp::Get(h, params->serialNumberSoKCommitmentGroup.modulus);
+    std::shared_ptr<const MontgomeryModulus> modulus = MontgomeryModulus::Get(params->serialNumberSoKCommitmentGroup.modulus);
+
     ParallelTasks challenges(params->zkp_iterations);
 
 	for(uint32_t i = 0; i < params->zkp_iterations; i++) {
-        challenges.Add([this, i, hashbytes, &b, &h, &tprime, &coinSerialNumber, &valueOfCommitmentToCoin] {
+        challenges.Add([this, i, hashbytes, &bExp, &hExp, &modulus, &tprime, &coinSerialNumber, &valueOfCommitmentToCoin] {
             int bit = i % 8;
             int byte = i / 8;
             bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
             if(challenge_bit) {
                 tprime[i] = challengeCalculation(coinSerialNumber, s_notprime[i], sprime[i]);
             } else {
-                Bignum exp = b.pow_mod(s_notprime[i], params->serialNumberSoKCommitmentGroup.groupOrder);
-                tprime[i] = ((valueOfCommitmentToCoin.pow_mod(exp, params->serialNumberSoKCommitmentGroup.modulus) % params->serialNumberSoKCommitmentGroup.modulus) *
-                             (h.pow_mod(sprime[i], params->serialNumberSoKCommitmentGroup.modulus) % params->serialNumberSoKCommitmentGroup.modulus)) %
+                Bignum exp = bExp->pow_mod(s_notprime[i]);
+                tprime[i] = ((modulus->pow_mod(valueOfCommitmentToCoin, exp) % params->serialNumberSoKCommitmentGroup.modulus) *
+                             (hExp->pow_mod(sprime[i]) % params->serialNumberSoKCommitmentGroup.modulus)) %
                             params->serialNumberSoKCommitmentGroup.modulus;
             }
         });
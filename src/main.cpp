@@ -24,6 +24,7 @@
 #include "policy/policy.h"
 #include "pos.h"
 #include "pow.h"
+#include "powhashindex.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "random.h"
@@ -1921,7 +1922,8 @@ bool WriteBlockToDisk(const CBlock &block, CDiskBlockPos &pos, const CMessageHea
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+// Reads the block stored at pos without checking it in any way
+static bool ReadBlockDataFromDisk(CBlock &block, const CDiskBlockPos &pos) {
     block.SetNull();
 
     // Open history file to read
@@ -1936,6 +1938,11 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, con
     catch (const std::exception &e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
+    return true;
+}
+
+// Checks the proof of work of a PoW block read from disk
+static bool CheckReadBlockProofOfWork(const CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
     // Check the header only for PoW blocks
     if (!block.IsProofOfStake()){
         // Check the header
@@ -1946,13 +1953,25 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, con
     return true;
 }
 
+bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+    if (!ReadBlockDataFromDisk(block, pos))
+        return false;
+    return CheckReadBlockProofOfWork(block, pos, nHeight, consensusParams);
+}
+
 bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams) {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams))
+    if (!ReadBlockDataFromDisk(block, pindex->GetBlockPos()))
         return false;
     if (block.GetHash() != pindex->GetBlockHash()) {
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
                      pindex->ToString(), pindex->GetBlockPos().ToString());
     }
+    // Blocks are only stored by AcceptBlock after CheckBlock checked their proof of work, and
+    // ReceivedBlockTransactions then raises them to BLOCK_VALID_TRANSACTIONS. The hash comparison
+    // above ties the data read to that record, so Lyra2Z is only evaluated again for blocks
+    // without it (failed blocks, or data stored by any other path)
+    if (!pindex->IsValid(BLOCK_VALID_TRANSACTIONS))
+        return CheckReadBlockProofOfWork(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams);
     return true;
 }
 
@@ -2247,6 +2266,14 @@ bool CScriptCheck::operator()() {
     return true;
 }
 
+bool CHeaderPoWCheck::operator()() {
+    // A hash that can't be computed isn't cached, validation tries again
+    uint256 powHash;
+    if (pheader->ComputePoWHash(nHeight, powHash))
+        pheader->SetPoWHash(powHash);
+    return true;
+}
+
 int GetSpendHeight(const CCoinsViewCache &inputs) {
     LOCK(cs_main);
     CBlockIndex *pindexPrev = mapBlockIndex.find(inputs.GetBestBlock())->second;
@@ -2657,9 +2684,63 @@ bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigne
 
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
 
-void ThreadScriptCheck() {
-    RenameThread("bitcoin-scriptch");
-    scriptcheckqueue.Thread();
+// Sigma proofs are heavy, so every worker takes one check at a time
+static CCheckQueue<sigma::CSigmaSpendCheck> sigmaspendcheckqueue(1);
+// CheckBlock can be called without cs_main, only one master may use the queue at a time
+static CCriticalSection cs_sigmaspendcheckqueue;
+
+/** Verify sigma spends collected while checking transactions of the block, using the -par workers if there are any */
+static bool CheckSigmaSpends(CValidationState &state, sigma::CSigmaTxInfo *sigmaTxInfo) {
+    if (!nScriptCheckThreads)
+        return sigma::CheckSigmaSpendBatches(state, sigmaTxInfo);
+
+    std::vector<sigma::CSigmaSpendCheck> vChecks;
+    sigma::GetSigmaSpendChecks(sigmaTxInfo, vChecks, nScriptCheckThreads);
+    if (vChecks.empty())
+        return true;
+
+    LOCK(cs_sigmaspendcheckqueue);
+    CCheckQueueControl<sigma::CSigmaSpendCheck> control(&sigmaspendcheckqueue);
+    control.Add(vChecks);
+    if (!control.Wait())
+        return state.DoS(100, false, REJECT_INVALID, "bad-txns-zerocoin");
+    return true;
+}
+
+// Headers are hashed in small batches, Lyra2Z takes a few milliseconds per header
+static CCheckQueue<CHeaderPoWCheck> headerpowcheckqueue(8);
+// Headers messages are processed by one thread, but keep the queue single-master anyway
+static CCriticalSection cs_headerpowcheckqueue;
+
+void PrecomputeHeadersPoW(const std::vector<CBlockHeader> &headers, const Consensus::Params &consensusParams) {
+    // Without worker threads this would only move the hashing ahead of the block, keep it there
+    if (!nScriptCheckThreads || headers.empty() || Params().NetworkIDString() == CBaseChainParams::REGTEST)
+        return;
+
+    std::vector<CHeaderPoWCheck> vChecks;
+    {
+        LOCK(cs_main);
+        BlockMap::iterator mi = mapBlockIndex.find(headers[0].hashPrevBlock);
+        if (mi == mapBlockIndex.end())
+            return;
+        int nHeight = mi->second->nHeight;
+        uint256 hashPrev = headers[0].hashPrevBlock;
+        vChecks.reserve(headers.size());
+        BOOST_FOREACH(const CBlockHeader &header, headers) {
+            if (header.hashPrevBlock != hashPrev || ++nHeight > consensusParams.nLastPOWBlock)
+                break;
+            hashPrev = header.GetHash();
+            if (!mapBlockIndex.count(hashPrev))
+                vChecks.push_back(CHeaderPoWCheck(header, nHeight));
+        }
+    }
+    if (vChecks.empty())
+        return;
+
+    LOCK(cs_headerpowcheckqueue);
+    CCheckQueueControl<CHeaderPoWCheck> control(&headerpowcheckqueue);
+    control.Add(vChecks);
+    control.Wait();
 }
 
 // Protected by cs_main
@@ -3032,6 +3113,9 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
         pos.nTxOffset += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
     }
 
+    if (!CheckSigmaSpends(state, block.sigmaTxInfo.get()))
+        return error("ConnectBlock(): sigma spend verification failed");
+
     block.zerocoinTxInfo->Complete();
     block.sigmaTxInfo->Complete();
 
@@ -3221,6 +3305,7 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
     static int64_t nLastWrite = 0;
     static int64_t nLastFlush = 0;
     static int64_t nLastSetChain = 0;
+    static int64_t nLastSnapshot = 0;
     std::set<int> setFilesToPrune;
     bool fFlushForPrune = false;
     try {
@@ -3246,6 +3331,9 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
         if (nLastSetChain == 0) {
             nLastSetChain = nNow;
         }
+        if (nLastSnapshot == 0) {
+            nLastSnapshot = nNow;
+        }
         size_t cacheSize = pcoinsTip->DynamicMemoryUsage();
         // The cache is large and close to the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize * (10.0 / 9) > nCoinCacheUsage;
@@ -3281,10 +3369,18 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
                     vBlocks.push_back(*it);
                     setDirtyBlockIndex.erase(it++);
                 }
-                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
+                std::vector<std::pair<const CBlockIndex *, const CSigmaBlockIndex *> > vSigmaBlocks;
+                sigma::GetUnsavedSigmaBlockIndexes(vSigmaBlocks);
+                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks, vSigmaBlocks)) {
                     return AbortNode(state, "Files to write to block index database");
                 }
+                sigma::ClearUnsavedSigmaBlockIndexes();
             }
+            // Write back the PoW hashes of headers accepted since the last flush
+            powHashIndex.Flush();
+            // and the alternative accumulator values a previous write failed to store
+            if (!CZerocoinState::GetZerocoinState()->FlushAlternativeAccumulatorValues())
+                LogPrintf("%s: failed to store alternative accumulator values\n", __func__);
             // Finally remove any pruned files
             if (fFlushForPrune)
                 UnlinkPrunedFiles(setFilesToPrune);
@@ -3302,6 +3398,14 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            // Snapshot zerocoin and sigma states at the flushed tip so the next start only replays blocks after it.
+            // Reserializing them is not cheap, so besides shutdown they are only refreshed every few hours.
+            if (mode == FLUSH_STATE_ALWAYS ||
+                    (!IsInitialBlockDownload() && nNow > nLastSnapshot + (int64_t) STATE_SNAPSHOT_WRITE_INTERVAL * 1000000)) {
+                if (!ZerocoinWriteStateSnapshot(&chainActive) || !sigma::WriteSigmaStateSnapshot(&chainActive))
+                    LogPrintf("%s: failed to write zerocoin state snapshots\n", __func__);
+                nLastSnapshot = nNow;
+            }
             nLastFlush = nNow;
         }
         if (fDoFullFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) &&
@@ -3453,20 +3557,24 @@ static int64_t nTimeChainState = 0;
 static int64_t nTimePostConnect = 0;
 
 /**
- * Connect a new block to chainActive. pblock is either NULL or a pointer to a CBlock
- * corresponding to pindexNew, to bypass loading it again from disk.
+ * Connect a new block to chainActive. pblock is either empty or the block corresponding to
+ * pindexNew, to bypass loading it again from disk. The block connected, given or read from disk,
+ * is handed to pblockConnected, so it can be passed on to the listeners of the new tip.
  */
-bool static ConnectTip(CValidationState &state, const CChainParams &chainparams, CBlockIndex *pindexNew, const CBlock *pblock) {
+bool static ConnectTip(CValidationState &state, const CChainParams &chainparams, CBlockIndex *pindexNew,
+                       const std::shared_ptr<const CBlock> &pblock, std::shared_ptr<const CBlock> &pblockConnected) {
     //LogPrintf("ConnectTip() nHeight=%s\n", pindexNew->nHeight);
     assert(pindexNew->pprev == chainActive.Tip());
     // Read block from disk.
     int64_t nTime1 = GetTimeMicros();
-    CBlock block;
-    if (!pblock) {
-        if (!ReadBlockFromDisk(block, pindexNew, chainparams.GetConsensus()))
+    pblockConnected = pblock;
+    if (!pblockConnected) {
+        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+        if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus()))
             return AbortNode(state, "Failed to read block");
-        pblock = &block;
+        pblockConnected = pblockNew;
     }
+    const CBlock &blockConnecting = *pblockConnected;
     // Apply the block atomically to the chain state.
     int64_t nTime2 = GetTimeMicros();
     nTimeReadFromDisk += nTime2 - nTime1;
@@ -3474,8 +3582,8 @@ bool static ConnectTip(CValidationState &state, const CChainParams &chainparams,
 //    LogPrintf("bench", "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * 0.001, nTimeReadFromDisk * 0.000001);
     {
         CCoinsViewCache view(pcoinsTip);
-        bool rv = ConnectBlock(*pblock, state, pindexNew, view, chainparams);
-        GetMainSignals().BlockChecked(*pblock, state);
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
+        GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
                 InvalidBlockFound(pindexNew, state);
@@ -3501,7 +3609,7 @@ bool static ConnectTip(CValidationState &state, const CChainParams &chainparams,
     // Remove conflicting transactions from the mempool.
     list <CTransaction> txConflicted;
 //    LogPrint("ConnectTip", "pblock->ToString()=%s\n", pblock->ToString());
-    mempool.removeForBlock(pblock->vtx, pindexNew->nHeight, txConflicted, !IsInitialBlockDownload());
+    mempool.removeForBlock(blockConnecting.vtx, pindexNew->nHeight, txConflicted, !IsInitialBlockDownload());
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
     // Tell wallet about transactions that went from mempool
@@ -3510,8 +3618,8 @@ bool static ConnectTip(CValidationState &state, const CChainParams &chainparams,
         SyncWithWallets(tx, pindexNew, NULL);
     }
     // ... and about transactions that got confirmed:
-    BOOST_FOREACH(const CTransaction &tx, pblock->vtx) {
-        SyncWithWallets(tx, pindexNew, pblock);
+    BOOST_FOREACH(const CTransaction &tx, blockConnecting.vtx) {
+        SyncWithWallets(tx, pindexNew, &blockConnecting);
     }
 
     int64_t nTime6 = GetTimeMicros();
@@ -3701,16 +3809,18 @@ static void PruneBlockIndexCandidates() {
 
 /**
  * Try to make some progress towards making pindexMostWork the active block.
- * pblock is either NULL or a pointer to a CBlock corresponding to pindexMostWork.
+ * pblock is either empty or the block corresponding to pindexMostWork.
+ * pblockTip gets the block of the new tip, given or read from disk.
  */
 static bool ActivateBestChainStep(CValidationState &state, const CChainParams &chainparams, CBlockIndex *pindexMostWork,
-                                  const CBlock *pblock, bool &fInvalidFound) {
+                                  const std::shared_ptr<const CBlock> &pblock, bool &fInvalidFound, std::shared_ptr<const CBlock> &pblockTip) {
     //LogPrintf("ActivateBestChainStep()\n");
         AssertLockHeld(cs_main);
         const CBlockIndex *pindexOldTip = chainActive.Tip();
         const CBlockIndex *pindexFork = chainActive.FindFork(pindexMostWork);
         // Disconnect active blocks which are no longer in the best chain.
         bool fBlocksDisconnected = false;
+        pblockTip.reset();
         while (chainActive.Tip() && chainActive.Tip() != pindexFork) {
             if (!DisconnectTip(state, chainparams)) {
                 LogPrintf("DisconnectTip() -> Failed!\n");
@@ -3738,7 +3848,8 @@ static bool ActivateBestChainStep(CValidationState &state, const CChainParams &c
             // Connect new blocks.
             BOOST_REVERSE_FOREACH(CBlockIndex * pindexConnect, vpindexToConnect)
             {
-                if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : NULL)) {
+                std::shared_ptr<const CBlock> pblockConnected;
+                if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), pblockConnected)) {
                     if (state.IsInvalid()) {
                         // The block violates a consensus rule.
                         if (!state.CorruptionPossible())
@@ -3752,6 +3863,7 @@ static bool ActivateBestChainStep(CValidationState &state, const CChainParams &c
                         return false;
                     }
                 } else {
+                    pblockTip = pblockConnected;
                     PruneBlockIndexCandidates();
                     if (!pindexOldTip || chainActive.Tip()->nChainWork > pindexOldTip->nChainWork) {
                         // We're in a better position than we were. Return temporarily to release the lock.
@@ -3802,16 +3914,17 @@ static void NotifyHeaderTip() {
 
 /**
  * Make the best chain active, in multiple steps. The result is either failure
- * or an activated best chain. pblock is either NULL or a pointer to a block
- * that is already loaded (to avoid loading it again from disk).
+ * or an activated best chain. pblock is either empty or a block that is already
+ * loaded (to avoid loading it again from disk), shared with the listeners of the new tip.
  */
-bool ActivateBestChain(CValidationState &state, const CChainParams &chainparams, const CBlock *pblock) {
+bool ActivateBestChain(CValidationState &state, const CChainParams &chainparams, std::shared_ptr<const CBlock> pblock) {
     //LogPrintf("ActivateBestChain()\n");
 //    if (pblock) {
 //        LogPrint("ActivateBestChain", "block=%s\n", pblock->ToString());
 //    }
     CBlockIndex *pindexMostWork = NULL;
     CBlockIndex *pindexNewTip = NULL;
+    std::shared_ptr<const CBlock> pblockNewTip;
     do {
         boost::this_thread::interruption_point();
         if (ShutdownRequested())
@@ -3833,7 +3946,7 @@ bool ActivateBestChain(CValidationState &state, const CChainParams &chainparams,
             }
 
             bool fInvalidFound = false;
-            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : NULL, fInvalidFound)) {
+            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : std::shared_ptr<const CBlock>(), fInvalidFound, pblockNewTip)) {
                 LogPrintf("ActivateBestChainStep --> Failed!\n");
                 return false;
             }
@@ -3880,10 +3993,9 @@ bool ActivateBestChain(CValidationState &state, const CChainParams &chainparams,
                         }
                     }
                 }
-                // Notify external listeners about the new tip.
-                if (!vHashes.empty()) {
-                    GetMainSignals().UpdatedBlockTip(pindexNewTip);
-                }
+                // Notify external listeners about the new tip, along with the block connected last
+                if (!vHashes.empty())
+                    GetMainSignals().UpdatedBlockTip(pindexNewTip, pblockNewTip);
             }
         }
     } while (pindexNewTip != pindexMostWork);
@@ -4053,7 +4165,9 @@ CBlockIndex *AddToBlockIndex(const CBlockHeader &block) {
     return pindexNew;
 }
 
-/** Mark a block as having its data received and checked (up to BLOCK_VALID_TRANSACTIONS). */
+/** Mark a block as having its data received and checked (up to BLOCK_VALID_TRANSACTIONS).
+ *  The block must have passed CheckBlock with its proof of work checked: ReadBlockFromDisk
+ *  trusts the proof of work of blocks with that validity. */
 bool ReceivedBlockTransactions(const CBlock &block, CValidationState &state, CBlockIndex *pindexNew,
                                const CDiskBlockPos &pos) {
     if (block.IsProofOfStake())
@@ -4243,12 +4357,17 @@ static bool CheckBlockSignature(const CBlock& block)
 
 
 //btzc: code from vertcoin, add
-bool CheckBlockHeader(const CBlockHeader &block, CValidationState &state, const Consensus::Params &consensusParams, bool fCheckPOW) {
+bool CheckBlockHeader(const CBlockHeader &block, CValidationState &state, const Consensus::Params &consensusParams, bool fCheckPOW, uint256 *pPoWHash) {
     int nHeight = ZerocoinGetNHeight(block);
     if(Params().NetworkIDString() == CBaseChainParams::REGTEST)
         return true;
-    if (nHeight <= consensusParams.nLastPOWBlock){
-        if (fCheckPOW && !CheckProofOfWork(block.GetPoWHash(nHeight), block.nBits, consensusParams,nHeight)) {
+    if (nHeight <= consensusParams.nLastPOWBlock && fCheckPOW){
+        uint256 powHash;
+        if (!block.ComputePoWHash(nHeight, powHash))
+            return state.Error("CheckBlockHeader(): can't compute the proof of work hash");
+        if (pPoWHash)
+            *pPoWHash = powHash;
+        if (!CheckProofOfWork(powHash, block.nBits, consensusParams,nHeight)) {
             if(nHeight > ZPOW_ERR || nHeight == INT_MAX)
                 return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
         }
@@ -4385,6 +4504,10 @@ bool CheckBlock(const CBlock &block, CValidationState &state, const Consensus::P
                                  strprintf("Transaction check failed (tx hash %s) %s", tx.GetHash().ToString(),
                                            state.GetDebugMessage()));
         }
+        if (!CheckSigmaSpends(state, block.sigmaTxInfo.get())) {
+            LogPrintf("CheckBlock - CheckSigmaSpends -> failed!\n");
+            return false;
+        }
         block.zerocoinTxInfo->Complete();
         block.sigmaTxInfo->Complete();
     
@@ -4669,7 +4792,7 @@ bool CheckStake(CBlock* pblock, CWallet& wallet, const CChainParams& chainparams
         }
 
         // Process this block the same as if we had received it from another node
-        if (!ProcessNewBlock(state, chainparams, NULL, pblock, true, NULL, false))
+        if (!ProcessNewBlock(state, chainparams, NULL, std::make_shared<const CBlock>(*pblock), true, NULL, false))
             return error("CheckStake() : ProcessNewBlock, block not accepted");
     }
 
@@ -4746,6 +4869,7 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
     uint256 hash = block.GetHash();
     BlockMap::iterator miSelf = mapBlockIndex.find(hash);
     CBlockIndex *pindex = NULL;
+    uint256 powHash;
     if (hash != chainparams.GetConsensus().hashGenesisBlock) {
 
         if (miSelf != mapBlockIndex.end()) {
@@ -4758,7 +4882,7 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), !fProofOfStake))
+        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), !fProofOfStake, &powHash))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -4783,6 +4907,13 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
     if (pindex == NULL)
         pindex = AddToBlockIndex(block);
 
+    // Remember the PoW hash of the accepted header, so it's never computed again for this block.
+    // Headers messages aren't checked here, but their hashes may have been precomputed
+    if (powHash.IsNull() && block.IsComputed())
+        powHash = block.powHash;
+    if (!powHash.IsNull())
+        powHashIndex.Add(pindex->nHeight, hash, powHash);
+
     if (pindex->nHeight > chainparams.GetConsensus().nLastPOWBlock)
         pindex->SetProofOfStake();
 
@@ -4792,6 +4923,25 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
     return true;
 }
 
+bool ProcessNewBlockHeaders(const std::vector<CBlockHeader> &headers, CValidationState &state, const CChainParams &chainparams,
+                            CBlockIndex **ppindexLast) {
+    LOCK(cs_main);
+    CBlockIndex *pindexLast = NULL;
+    BOOST_FOREACH(const CBlockHeader& header, headers) {
+        if (pindexLast != NULL && header.hashPrevBlock != pindexLast->GetBlockHash())
+            return state.DoS(20, error("non-continuous headers sequence"));
+        // Headers failing for other reasons than being invalid are skipped
+        CValidationState stateHeader;
+        if (!AcceptBlockHeader(header, stateHeader, chainparams, &pindexLast) && stateHeader.IsInvalid()) {
+            state = stateHeader;
+            return false;
+        }
+    }
+    if (ppindexLast)
+        *ppindexLast = pindexLast;
+    return true;
+}
+
 /** Store block on disk. If dbp is non-NULL, the file is known to already reside on disk */
 static bool AcceptBlock(const CBlock &block, CValidationState &state, const CChainParams &chainparams, CBlockIndex **ppindex,
             bool fRequested, const CDiskBlockPos *dbp, bool *fNewBlock) {
@@ -4878,7 +5028,7 @@ static bool IsSuperMajority(int minVersion, const CBlockIndex *pstart, unsigned
 }
 
 
-bool ProcessNewBlock(CValidationState &state, const CChainParams &chainparams, CNode *pfrom, const CBlock *pblock,
+bool ProcessNewBlock(CValidationState &state, const CChainParams &chainparams, CNode *pfrom, const std::shared_ptr<const CBlock> pblock,
                      bool fForceProcessing, const CDiskBlockPos *dbp, bool fMayBanPeerIfInvalid) {
     int nHeight = ZerocoinGetNHeight(pblock->GetBlockHeader());
     //LogPrintf("ProcessNewBlock nHeight=%s, blockHash:%s\n", nHeight, pblock->GetHash().ToString());
@@ -5231,10 +5381,17 @@ bool static LoadBlockIndexDB() {
     set<CBlockIndex *> changes;
     ZerocoinBuildStateFromIndex(&chainActive, changes);
     sigma::BuildSigmaStateFromIndex(&chainActive);
+    bool fChangesFlushed = true;
     if (!changes.empty()) {
         setDirtyBlockIndex.insert(changes.begin(), changes.end());
-        FlushStateToDisk();
+        CValidationState flushState;
+        fChangesFlushed = FlushStateToDisk(flushState, FLUSH_STATE_ALWAYS);
     }
+    // recalculated accumulators are on disk now, the check is not needed on the next start
+    if (fChangesFlushed)
+        pblocktree->WriteFlag(ZEROCOIN_ACCUMULATORS_CHECKED_FLAG, true);
+    else
+        LogPrintf("%s: recalculated zerocoin accumulators weren't flushed, checking them again on the next start\n", __func__);
           LogPrintf("%s: hashBestChain=%s height=%d date=%s progress=%f\n", __func__,
               chainActive.Tip()->GetBlockHash().ToString(), chainActive.Height(),
               DateTimeStrFormat("%Y-%m-%d %H:%M:%S", chainActive.Tip()->GetBlockTime()),
@@ -5576,7 +5733,8 @@ bool LoadExternalBlockFile(const CChainParams &chainparams, FILE *fileIn, CDiskB
                     dbp->nPos = nBlockPos;
                 blkdat.SetLimit(nBlockPos + nSize);
                 blkdat.SetPos(nBlockPos);
-                CBlock block;
+                std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+                CBlock &block = *pblock;
                 blkdat >> block;
                 nRewind = blkdat.GetPos();
 
@@ -5598,7 +5756,7 @@ bool LoadExternalBlockFile(const CChainParams &chainparams, FILE *fileIn, CDiskB
                     if (AcceptBlock(block, state, chainparams, NULL, true, dbp, NULL)) {
                         nLoaded++;
                         LogPrintf("block nHeight=%s IS ACCEPTED!\n", nHeight);
-                        if (!ActivateBestChain(state, chainparams, &block)) {
+                        if (!ActivateBestChain(state, chainparams, pblock)) {
                             break;
                         }
                     } else {
@@ -7069,7 +7227,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
 
         // Keep a CBlock for "optimistic" compactblock reconstructions (see
         // below)
-        CBlock block;
+        std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        CBlock &block = *pblock;
         bool fBlockReconstructed = false;
 
         LOCK(cs_main);
@@ -7244,7 +7403,7 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
                 }
             }
             CValidationState state;
-            ProcessNewBlock(state, chainparams, pfrom, &block, true, NULL, false);
+            ProcessNewBlock(state, chainparams, pfrom, pblock, true, NULL, false);
             // TODO: could send reject message if block is invalid?
         }
 
@@ -7266,7 +7425,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
         }
 
         PartiallyDownloadedBlock &partialBlock = *it->second.second->partialBlock;
-        CBlock block;
+        std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        CBlock &block = *pblock;
         ReadStatus status = partialBlock.FillBlock(block, resp.txn);
         if (status == READ_STATUS_INVALID) {
             MarkBlockAsReceived(resp.blockhash); // Reset in-flight state in case of whitelist
@@ -7301,7 +7461,7 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
             // BIP 152 permits peers to relay compact blocks after validating
             // the header only; we should not punish peers if the block turns
             // out to be invalid.
-            ProcessNewBlock(state, chainparams, pfrom, &block, false, NULL, false);
+            ProcessNewBlock(state, chainparams, pfrom, pblock, false, NULL, false);
             int nDoS;
             if (state.IsInvalid(nDoS)) {
                 assert(state.GetRejectCode() < REJECT_INTERNAL); // Blocks are never rejected with internal reject codes
@@ -7326,6 +7486,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
+        PrecomputeHeadersPoW(headers, chainparams.GetConsensus());
+
         {
         LOCK(cs_main);
 
@@ -7364,19 +7526,13 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
         }
 
         CBlockIndex *pindexLast = NULL;
-        BOOST_FOREACH(const CBlockHeader& header, headers) {
-            CValidationState state;
-            if (pindexLast != NULL && header.hashPrevBlock != pindexLast->GetBlockHash()) {
-                Misbehaving(pfrom->GetId(), 20);
-                return error("non-continuous headers sequence");
-            }
-            if (!AcceptBlockHeader(header, state, chainparams, &pindexLast)) {
-                int nDoS;
-                if (state.IsInvalid(nDoS)) {
-                    if (nDoS > 0)
-                        Misbehaving(pfrom->GetId(), nDoS);
-                    return error("invalid header received");
-                }
+        CValidationState state;
+        if (!ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast)) {
+            int nDoS;
+            if (state.IsInvalid(nDoS)) {
+                if (nDoS > 0)
+                    Misbehaving(pfrom->GetId(), nDoS);
+                return error("invalid header received");
             }
         }
 
@@ -7461,7 +7617,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
         NotifyHeaderTip();
     } else if (strCommand == NetMsgType::BLOCK && !fImporting && !fReindex) // Ignore blocks received while importing
     {
-        CBlock block;
+        std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        CBlock &block = *pblock;
         vRecv >> block;
         LogPrint("net", "received block %s peer=%d\n", block.GetHash().ToString(), pfrom->id);
         CValidationState state;
@@ -7470,7 +7627,7 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
         // Such an unrequested block may still be processed, subject to the
         // conditions in AcceptBlock().
         bool forceProcessing = pfrom->fWhitelisted && !IsInitialBlockDownload();
-        ProcessNewBlock(state, chainparams, pfrom, &block, forceProcessing, NULL, true);
+        ProcessNewBlock(state, chainparams, pfrom, pblock, forceProcessing, NULL, true);
         int nDoS;
         if (state.IsInvalid(nDoS)) {
             assert(state.GetRejectCode() < REJECT_INTERNAL); // Blocks are never rejected with internal reject codes
@@ -7717,6 +7874,8 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
             ReadCompactSize(vRecv); // ignore block sig; assume it is 0.
         }
 
+        PrecomputeHeadersPoW(headers, chainparams.GetConsensus());
+
         {
         LOCK(cs_main);
 
@@ -7755,19 +7914,13 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
         }
 
         CBlockIndex *pindexLast = NULL;
-        BOOST_FOREACH(const CBlockHeader& header, headers) {
-            CValidationState state;
-            if (pindexLast != NULL && header.hashPrevBlock != pindexLast->GetBlockHash()) {
-                Misbehaving(pfrom->GetId(), 20);
-                return error("non-continuous headers sequence");
-            }
-            if (!AcceptBlockHeader(header, state, chainparams, &pindexLast)) {
-                int nDoS;
-                if (state.IsInvalid(nDoS)) {
-                    if (nDoS > 0)
-                        Misbehaving(pfrom->GetId(), nDoS);
-                    return error("invalid header received");
-                }
+        CValidationState state;
+        if (!ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast)) {
+            int nDoS;
+            if (state.IsInvalid(nDoS)) {
+                if (nDoS > 0)
+                    Misbehaving(pfrom->GetId(), nDoS);
+                return error("invalid header received");
             }
         }
 
@@ -39,6 +39,7 @@
 
 #include "crypto/Lyra2Z/Lyra2Z.h"
 #include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Lyra2ZContext.h"
 
 #include <algorithm>
 #include <boost/thread.hpp>
@@ -1165,7 +1166,7 @@ static bool ProcessBlockFound(const CBlock* pblock, const CChainParams& chainpar
 
     // Process this block the same as if we had received it from another node
     CValidationState state;
-    if (!ProcessNewBlock(state, chainparams, NULL, pblock, true, NULL, false))
+    if (!ProcessNewBlock(state, chainparams, NULL, std::make_shared<const CBlock>(*pblock), true, NULL, false))
         return error("NoirMiner: ProcessNewBlock, block not accepted");
 
     return true;
@@ -1231,6 +1232,8 @@ void static ZcoinMiner(const CChainParams &chainparams) {
             int64_t nStart = GetTime();
             arith_uint256 hashTarget = arith_uint256().SetCompact(pblock->nBits);
             LogPrintf("hashTarget: %s\n", hashTarget.ToString());
+            // Memory matrix of this thread, reused for every nonce
+            Lyra2ZContext &lyra2z = Lyra2ZContext::ThreadContext();
             LogPrintf("fTestnet: %d\n", fTestNet);
             LogPrintf("pindexPrev->nHeight: %s\n", pindexPrev->nHeight);
             LogPrintf("pblock: %s\n", pblock->ToString());
@@ -1239,16 +1242,18 @@ void static ZcoinMiner(const CChainParams &chainparams) {
             while (true) {
                 // Check if something found
                 uint256 thash;
+                bool fHashed = true;
 
                 while (true) {
 
-                    LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 330, 256);
+                    fHashed = lyra2z.Hash(BEGIN(pblock->nVersion), BEGIN(thash));
                     //LogPrintf("*****\nhash   : %s  \ntarget : %s\n", UintToArith256(thash).ToString(), hashTarget.ToString());
 
-                    if (thash.IsNull())
+                    if (!fHashed)
                     {
-                        LogPrintf("NoirMiner() : Out of memory\n");
-                        throw std::runtime_error("NoirMiner() : Out of memory");
+                        // thash holds no hash, abort the round and build a new block
+                        LogPrintf("NoirMiner() : can't allocate the Lyra2Z matrix\n");
+                        break;
                     }
                     if (UintToArith256(thash) <= hashTarget) {
                         // Found a solution
@@ -1271,6 +1276,8 @@ void static ZcoinMiner(const CChainParams &chainparams) {
                 }
                 // Check for stop or if block needs to be rebuilt
                 boost::this_thread::interruption_point();
+                if (!fHashed)
+                    break;
                 // Regtest mode doesn't require peers
                 if (vNodes.empty() && chainparams.MiningRequiresPeers())
                     break;
@@ -14,6 +14,8 @@
 #include "clientversion.h"
 #include "coins.h"
 #include "consensus/consensus.h"
+#include "crypto/common.h"
+#include "crypto/sha256.h"
 #include "hash.h"
 #include "main.h"
 #include "uint256.h"
@@ -146,7 +148,8 @@ bool CheckProofOfStake(CBlockIndex* pindexPrev, const CTransaction& tx, unsigned
         return state.DoS(100, error("CheckProofOfStake() : stake prevout is not mature, expecting %i and only matured to %i", COINBASE_MATURITY, pindexPrev->nHeight + 1 - mapBlockIndex[hashBlock]->nHeight));
     }
 
-    if (!CheckStakeKernelHash(pindexPrev, nBits, pindexPrev->GetBlockTime(), new CCoins(txPrev, pindexPrev->nHeight), txin.prevout, nBlockTime, fDebug))
+    CCoins coins(txPrev, pindexPrev->nHeight);
+    if (!CheckStakeKernelHash(pindexPrev, nBits, pindexPrev->GetBlockTime(), &coins, txin.prevout, nBlockTime, fDebug))
        return state.DoS(1, error("CheckProofOfStake() : INFO: check kernel failed on coinstake %s", tx.GetHash().ToString())); // may occur during initial download or if behind on block chain sync
 
     return true;
@@ -168,6 +171,27 @@ bool VerifySignature(const CTransaction& txFrom, const CTransaction& txTo, unsig
     return VerifyScript(txin.scriptSig, txout.scriptPubKey, witness, flags, TransactionSignatureChecker(&txTo, nIn, 0),  NULL);
 }
 
+// Reads the transaction of a stake prevout and checks that it is mature on top of pindexPrev
+static bool ReadMatureStakeTx(const char* func, const COutPoint& prevout, const CBlockIndex* pindexPrev, CTransaction& txPrev, uint256& hashBlock)
+{
+    if (!GetTransaction(prevout.hash, txPrev, Params().GetConsensus(), hashBlock, true)){
+        LogPrintf("%s() : could not find previous transaction %s\n", func, prevout.hash.ToString());
+        return false;
+    }
+
+    if (mapBlockIndex.count(hashBlock) == 0) {
+        LogPrintf("%s() : could not find block of previous transaction %s\n", func, hashBlock.ToString());
+        return false;
+    }
+
+    if (pindexPrev->nHeight + 1 - mapBlockIndex[hashBlock]->nHeight < COINBASE_MATURITY){
+        LogPrintf("%s() : stake prevout is not mature in block %s\n", func, hashBlock.ToString());
+        return false;
+    }
+
+    return true;
+}
+
 /*bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout){
     std::map<COutPoint, CStakeCache> tmp;
     return CheckKernel(pindexPrev, nBits, nTimeBlock, prevout, tmp);
@@ -183,22 +207,11 @@ bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTime, co
     if(it == cache.end()) {
         CTransaction txPrev;
         uint256 hashBlock = uint256();
-        if (!GetTransaction(prevout.hash, txPrev, Params().GetConsensus(), hashBlock, true)){
-            LogPrintf("CheckKernel() : could not find previous transaction %s\n", prevout.hash.ToString());
-            return false;
-        }
-
-        if (mapBlockIndex.count(hashBlock) == 0) {
-            LogPrintf("CheckKernel() : could not find block of previous transaction %s\n", hashBlock.ToString());
+        if (!ReadMatureStakeTx(__func__, prevout, pindexPrev, txPrev, hashBlock))
             return false;
-        }
-
-        if (pindexPrev->nHeight + 1 - mapBlockIndex[hashBlock]->nHeight < COINBASE_MATURITY){
-            LogPrintf("CheckKernel() : stake prevout is not mature in block %s\n", hashBlock.ToString());
-            return false;
-        }
 
-        return CheckStakeKernelHash(pindexPrev, nBits, *pBlockTime, new CCoins(txPrev, pindexPrev->nHeight), prevout, nTime);
+        CCoins coins(txPrev, pindexPrev->nHeight);
+        return CheckStakeKernelHash(pindexPrev, nBits, *pBlockTime, &coins, prevout, nTime);
     } else {
         //found in cache
         const CStakeCache& stake = it->second;
@@ -208,7 +221,8 @@ bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTime, co
             return CheckKernel(pindexPrev, nBits, nTime, prevout);
         }
         */
-        return CheckStakeKernelHash(pindexPrev, nBits, *pBlockTime, new CCoins(stake.txPrev, pindexPrev->nHeight), prevout, nTime);
+        CCoins coins(stake.txPrev, pindexPrev->nHeight);
+        return CheckStakeKernelHash(pindexPrev, nBits, *pBlockTime, &coins, prevout, nTime);
     }
 }
 
@@ -219,21 +233,101 @@ void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevo
     }
     CTransaction txPrev;
     uint256 hashBlock = uint256();
-    if (!GetTransaction(prevout.hash, txPrev, Params().GetConsensus(), hashBlock, true)){
-        LogPrintf("CacheKernel() : could not find previous transaction %s\n", prevout.hash.ToString());
+    if (!ReadMatureStakeTx(__func__, prevout, pindexPrev, txPrev, hashBlock))
         return;
-    }
 
-    if (mapBlockIndex.count(hashBlock) == 0) {
-        LogPrintf("CacheKernel() : could not find block of previous transaction %s\n", hashBlock.ToString());
-        return;
-    }
+    CStakeCache c(hashBlock, txPrev);
+    cache.insert({prevout, c});
+}
 
-    if (pindexPrev->nHeight + 1 - mapBlockIndex[hashBlock]->nHeight < COINBASE_MATURITY){
-        LogPrintf("CacheKernel() : stake prevout is not mature in block %s\n", hashBlock.ToString());
-        return;
+bool CStakeKernelTable::IsBuiltFor(const CBlockIndex* pindexPrevIn, unsigned int nBitsIn, const std::vector<COutPoint>& vPrevoutsIn) const
+{
+    return pindexPrev == pindexPrevIn && nBits == nBitsIn && vPrevouts == vPrevoutsIn;
+}
+
+void CStakeKernelTable::Build(CBlockIndex* pindexPrevIn, unsigned int nBitsIn, const std::vector<COutPoint>& vPrevoutsIn, const std::map<COutPoint, CStakeCache>& cache)
+{
+    pindexPrev = pindexPrevIn;
+    nBits = nBitsIn;
+    nBlockTime = pindexPrev->GetBlockTime();
+    fEarlyTimeAllowed = pindexPrev->nHeight <= Params().GetConsensus().nLastPOWBlock;
+    vPrevouts = vPrevoutsIn;
+    vCandidates.clear();
+    vCandidates.reserve(vPrevouts.size());
+
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(nBits);
+
+    for (size_t nPos = 0; nPos < vPrevouts.size(); nPos++) {
+        const COutPoint& prevout = vPrevouts[nPos];
+        CAmount nValue;
+        auto it = cache.find(prevout);
+        if (it != cache.end()) {
+            nValue = it->second.txPrev.vout[prevout.n].nValue;
+        } else {
+            CTransaction txPrev;
+            uint256 hashBlock = uint256();
+            if (!ReadMatureStakeTx(__func__, prevout, pindexPrev, txPrev, hashBlock))
+                continue;
+            nValue = txPrev.vout[prevout.n].nValue;
+        }
+        if (nValue == 0)
+            continue;
+
+        Candidate candidate;
+        candidate.nPos = nPos;
+        candidate.prevout = prevout;
+        candidate.nValue = nValue;
+        candidate.bnWeightedTarget = bnTarget * arith_uint256(nValue);
+        // nStakeModifier, nBlockTime and the first 28 bytes of prevout.hash, as serialized by CheckStakeKernelHash
+        memcpy(candidate.head, pindexPrev->nStakeModifier.begin(), 32);
+        WriteLE32(candidate.head + 32, nBlockTime);
+        memcpy(candidate.head + 36, prevout.hash.begin(), 28);
+        vCandidates.push_back(candidate);
     }
+}
 
-    CStakeCache c(hashBlock, txPrev);
-    cache.insert({prevout, c});
+bool CStakeKernelTable::Search(int64_t nTime, unsigned int nInterval, size_t& nPos)
+{
+    static const size_t TAIL_SIZE = 12;
+    if (nInterval == 0)
+        return false;
+    vTails.resize(nInterval * TAIL_SIZE);
+    vHashes.resize(nInterval * CSHA256::OUTPUT_SIZE);
+
+    for (const Candidate& candidate : vCandidates) {
+        if (candidate.nPos < nPos)
+            continue;
+
+        // The rest of prevout.hash, prevout.n and the timestamp
+        for (unsigned int n = 0; n < nInterval; n++) {
+            unsigned char* tail = &vTails[n * TAIL_SIZE];
+            memcpy(tail, candidate.prevout.hash.begin() + 28, 4);
+            WriteLE32(tail + 4, candidate.prevout.n);
+            WriteLE32(tail + 8, (unsigned int)(nTime - n));
+        }
+        SHA256DSharedPrefix(&vHashes[0], candidate.head, &vTails[0], TAIL_SIZE, nInterval);
+
+        for (unsigned int n = 0; n < nInterval; n++) {
+            unsigned int nTimeTx = nTime - n;
+            if (nTimeTx < nBlockTime && !fEarlyTimeAllowed)
+                continue;
+
+            uint256 hashProofOfStake;
+            memcpy(hashProofOfStake.begin(), &vHashes[n * CSHA256::OUTPUT_SIZE], CSHA256::OUTPUT_SIZE);
+            if (UintToArith256(hashProofOfStake) > candidate.bnWeightedTarget)
+                continue;
+
+            if (fDebug)
+            {
+                LogPrintf("CStakeKernelTable::Search() : nStakeModifier=%s, txPrev.nTime=%u, txPrev.vout.hash=%s, txPrev.vout.n=%u, nTime=%u, hashProof=%s\n",
+                    pindexPrev->nStakeModifier.GetHex().c_str(),
+                    nBlockTime, candidate.prevout.hash.ToString(), candidate.prevout.n, nTimeTx,
+                    hashProofOfStake.ToString());
+            }
+            nPos = candidate.nPos;
+            return true;
+        }
+    }
+    return false;
 }
@@ -41,4 +41,47 @@ bool CheckStakeKernelHash(const CBlockIndex* pindexPrev, unsigned int nBits, uns
 bool CheckProofOfStake(CBlockIndex* pindexPrev, const CTransaction& tx, unsigned int nBlockTime, unsigned int nBits, CValidationState &state);
 void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev);
 bool VerifySignature(const CTransaction& txFrom, const CTransaction& txTo, unsigned int nIn, unsigned int flags, int nHashType);
+
+/**
+ * Staking outputs prepared for the kernel search on top of one tip: the weighted target of each
+ * output and the first 64 bytes of its kernel (stake modifier, block time and most of the prevout
+ * hash), which do not depend on the timestamp. A search only hashes the 12-byte tails that change
+ * with the timestamp, a whole search window of one output at a time.
+ */
+class CStakeKernelTable
+{
+public:
+    CStakeKernelTable() : pindexPrev(NULL), nBits(0), nBlockTime(0), fEarlyTimeAllowed(false) {}
+
+    // Whether the table holds these outputs, in this order, on top of pindexPrev with target nBits
+    bool IsBuiltFor(const CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<COutPoint>& vPrevouts) const;
+
+    // Prepares the outputs that are mature on top of pindexPrev, reading their transactions from cache when present
+    void Build(CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<COutPoint>& vPrevouts, const std::map<COutPoint, CStakeCache>& cache);
+
+    // Finds the first output at or after position nPos of vPrevouts with a kernel at one of the nInterval
+    // timestamps going back from nTime, and sets nPos to its position. Same result as CheckKernel.
+    bool Search(int64_t nTime, unsigned int nInterval, size_t& nPos);
+
+private:
+    struct Candidate {
+        size_t nPos;
+        COutPoint prevout;
+        CAmount nValue;
+        arith_uint256 bnWeightedTarget;
+        unsigned char head[64];
+    };
+
+    const CBlockIndex* pindexPrev;
+    unsigned int nBits;
+    unsigned int nBlockTime;
+    // Kernels may predate the previous block up to the last PoW block
+    bool fEarlyTimeAllowed;
+    std::vector<COutPoint> vPrevouts;
+    std::vector<Candidate> vCandidates;
+
+    // Scratch space of Search
+    std::vector<unsigned char> vTails;
+    std::vector<unsigned char> vHashes;
+};
 #endif // NOIR_POS_H
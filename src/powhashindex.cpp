@@ -0,0 +1,205 @@
+#include "powhashindex.h"
+
+#include "chainparams.h"
+#include "hash.h"
+#include "util.h"
+#include "primitives/precomputed_hash.h"
+
+#include <boost/filesystem.hpp>
+
+CPoWHashIndex powHashIndex;
+
+CPoWHashIndex::CPoWHashIndex() : records(NULL), nRecords(0)
+{
+}
+
+CPoWHashIndex::~CPoWHashIndex()
+{
+    Close();
+}
+
+bool CPoWHashIndex::Open(const boost::filesystem::path &pathIn)
+{
+    LOCK(cs);
+    Close();
+    path = pathIn;
+
+    const CMessageHeader::MessageStartChars &pchMessageStart = Params().MessageStart();
+    unsigned char header[HEADER_SIZE];
+    bool fNew = true;
+
+    FILE *fileIn = fopen(path.string().c_str(), "rb");
+    if (fileIn) {
+        uint32_t nVersion;
+        if (fread(header, 1, HEADER_SIZE, fileIn) == HEADER_SIZE) {
+            memcpy(&nVersion, header + MESSAGE_START_SIZE, sizeof(nVersion));
+            if (memcmp(header, pchMessageStart, MESSAGE_START_SIZE) == 0 && nVersion == FILE_VERSION)
+                fNew = false;
+        }
+        fclose(fileIn);
+        if (fNew)
+            LogPrintf("%s: %s is of another network or version, recreating it\n", __func__, path.string());
+    }
+
+    try {
+        if (fNew) {
+            memset(header, 0, HEADER_SIZE);
+            memcpy(header, pchMessageStart, MESSAGE_START_SIZE);
+            uint32_t nVersion = FILE_VERSION;
+            memcpy(header + MESSAGE_START_SIZE, &nVersion, sizeof(nVersion));
+
+            FILE *fileOut = fopen(path.string().c_str(), "wb");
+            if (!fileOut)
+                return error("%s: failed to create %s", __func__, path.string());
+            bool fWritten = fwrite(header, 1, HEADER_SIZE, fileOut) == HEADER_SIZE;
+            fclose(fileOut);
+            if (!fWritten)
+                return error("%s: failed to write %s", __func__, path.string());
+            boost::filesystem::resize_file(path, HEADER_SIZE + GROW_RECORDS * sizeof(Record));
+        }
+        else {
+            // Keep the record area a whole number of records
+            uintmax_t nSize = boost::filesystem::file_size(path);
+            size_t nRecordsOnDisk = (nSize - HEADER_SIZE) / sizeof(Record);
+            if (nRecordsOnDisk == 0)
+                nRecordsOnDisk = GROW_RECORDS;
+            if (nSize != HEADER_SIZE + nRecordsOnDisk * sizeof(Record))
+                boost::filesystem::resize_file(path, HEADER_SIZE + nRecordsOnDisk * sizeof(Record));
+        }
+    } catch (const boost::filesystem::filesystem_error &e) {
+        return error("%s: %s", __func__, e.what());
+    }
+
+    if (!Map(0))
+        return false;
+
+    if (fNew)
+        ImportPrecomputed();
+
+    LogPrintf("Mapped PoW hash index %s with room for %u headers\n", path.string(), nRecords);
+    return true;
+}
+
+void CPoWHashIndex::Close()
+{
+    LOCK(cs);
+    if (records)
+        region.flush();
+    boost::interprocess::mapped_region().swap(region);
+    boost::interprocess::file_mapping().swap(file);
+    records = NULL;
+    nRecords = 0;
+}
+
+bool CPoWHashIndex::IsOpen() const
+{
+    LOCK(cs);
+    return records != NULL;
+}
+
+bool CPoWHashIndex::Map(size_t nRecordsIn)
+{
+    boost::interprocess::mapped_region().swap(region);
+    boost::interprocess::file_mapping().swap(file);
+    records = NULL;
+    nRecords = 0;
+
+    try {
+        if (nRecordsIn > 0)
+            boost::filesystem::resize_file(path, HEADER_SIZE + nRecordsIn * sizeof(Record));
+        boost::interprocess::file_mapping(path.string().c_str(), boost::interprocess::read_write).swap(file);
+        boost::interprocess::mapped_region(file, boost::interprocess::read_write).swap(region);
+    } catch (const std::exception &e) {
+        boost::interprocess::file_mapping().swap(file);
+        return error("%s: failed to map %s: %s", __func__, path.string(), e.what());
+    }
+
+    records = reinterpret_cast<Record *>(static_cast<char *>(region.get_address()) + HEADER_SIZE);
+    nRecords = (region.get_size() - HEADER_SIZE) / sizeof(Record);
+    return true;
+}
+
+uint64_t CPoWHashIndex::Checksum(int nHeight, const uint256 &blockHash, const uint256 &powHash)
+{
+    CSipHasher hasher(0x706f776861736865ULL, 0x73696e6465787632ULL);
+    hasher.Write((uint64_t)nHeight);
+    hasher.Write(blockHash.begin(), blockHash.size());
+    hasher.Write(powHash.begin(), powHash.size());
+    return hasher.Finalize();
+}
+
+void CPoWHashIndex::SetRecord(int nHeight, const uint256 &blockHash, const uint256 &powHash)
+{
+    Record &record = records[nHeight];
+    record.blockHash = blockHash;
+    record.powHash = powHash;
+    record.nChecksum = Checksum(nHeight, blockHash, powHash);
+}
+
+bool CPoWHashIndex::IsValidRecord(int nHeight) const
+{
+    const Record &record = records[nHeight];
+    return !record.powHash.IsNull() && record.nChecksum == Checksum(nHeight, record.blockHash, record.powHash);
+}
+
+bool CPoWHashIndex::Lookup(int nHeight, const uint256 &blockHash, uint256 &powHash) const
+{
+    LOCK(cs);
+    if (!records || nHeight < 0 || (size_t)nHeight >= nRecords)
+        return false;
+
+    const Record &record = records[nHeight];
+    if (!IsValidRecord(nHeight))
+        return false;
+    // A record without block hash is a precomputed one, valid for the height
+    if (!record.blockHash.IsNull() && record.blockHash != blockHash)
+        return false;
+
+    powHash = record.powHash;
+    return true;
+}
+
+void CPoWHashIndex::Add(int nHeight, const uint256 &blockHash, const uint256 &powHash)
+{
+    LOCK(cs);
+    if (!records || nHeight < 0)
+        return;
+
+    if ((size_t)nHeight >= nRecords) {
+        region.flush();
+        if (!Map(((size_t)nHeight / GROW_RECORDS + 1) * GROW_RECORDS))
+            return;
+    }
+
+    // Precomputed hashes stay in place, so they keep answering for any header at their height
+    if (records[nHeight].blockHash.IsNull() && IsValidRecord(nHeight))
+        return;
+
+    SetRecord(nHeight, blockHash, powHash);
+}
+
+void CPoWHashIndex::Flush()
+{
+    LOCK(cs);
+    if (records)
+        region.flush();
+}
+
+void CPoWHashIndex::ImportPrecomputed()
+{
+    // The table was used on every network but testnet, regtest included
+    if (Params().NetworkIDString() == CBaseChainParams::TESTNET)
+        return;
+
+    buildMapPoWHash();
+    for (const auto &entry : mapPoWHash) {
+        if (entry.first < 0)
+            continue;
+        if ((size_t)entry.first >= nRecords && !Map(((size_t)entry.first / GROW_RECORDS + 1) * GROW_RECORDS))
+            return;
+        SetRecord(entry.first, uint256(), entry.second);
+    }
+    LogPrintf("Imported %u precomputed PoW hashes\n", mapPoWHash.size());
+    mapPoWHash.clear();
+    region.flush();
+}
@@ -0,0 +1,77 @@
+#ifndef POWHASHINDEX_H
+#define POWHASHINDEX_H
+
+#include "sync.h"
+#include "uint256.h"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+static const char *const POW_HASH_INDEX_FILENAME = "powhashes.dat";
+
+/**
+ * Persistent table of Lyra2Z hashes of PoW block headers, so headers that were validated once
+ * are never hashed again (header sync after a restart, -reindex, rereading blocks).
+ *
+ * The file is a fixed header followed by one 72-byte record per height, holding the block hash
+ * and the PoW hash of the header at that height. It is memory-mapped and grows as headers are
+ * accepted; lookups are a bounds check and a compare. A record only answers for the header
+ * with the same block hash, except for the legacy hashes imported from the precomputed table,
+ * which are stored without a block hash and keep their height-only semantics.
+ *
+ * Pages of the mapping reach the disk in no particular order, so a crash can leave records
+ * half written. Each record carries a checksum of its height and hashes, and a record failing
+ * it is treated as missing: the hash is computed again and the record rewritten.
+ */
+class CPoWHashIndex
+{
+public:
+    CPoWHashIndex();
+    ~CPoWHashIndex();
+
+    // Maps the file at path, creating it (and importing the precomputed hashes except on testnet) if needed
+    bool Open(const boost::filesystem::path &path);
+    void Close();
+    bool IsOpen() const;
+
+    // Returns the PoW hash stored for the header with the given block hash at nHeight
+    bool Lookup(int nHeight, const uint256 &blockHash, uint256 &powHash) const;
+
+    // Stores the PoW hash of an accepted header, growing the file if needed
+    void Add(int nHeight, const uint256 &blockHash, const uint256 &powHash);
+
+    // Writes modified pages back to disk
+    void Flush();
+
+private:
+    struct Record {
+        uint256 blockHash;
+        uint256 powHash;
+        uint64_t nChecksum;
+    };
+
+    static const uint32_t FILE_VERSION = 2;
+    static const size_t HEADER_SIZE = 64;
+    // The file grows by about 1MiB at a time
+    static const size_t GROW_RECORDS = 16384;
+
+    mutable CCriticalSection cs;
+    boost::filesystem::path path;
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+    Record *records;
+    size_t nRecords;
+
+    static uint64_t Checksum(int nHeight, const uint256 &blockHash, const uint256 &powHash);
+    void SetRecord(int nHeight, const uint256 &blockHash, const uint256 &powHash);
+    // Whether the record at nHeight holds a hash and was completely written
+    bool IsValidRecord(int nHeight) const;
+
+    bool Map(size_t nRecordsIn);
+    void ImportPrecomputed();
+};
+
+extern CPoWHashIndex powHashIndex;
+
+#endif // POWHASHINDEX_H
@@ -14,13 +14,14 @@
 #include "crypto/scrypt.h"
 #include "crypto/Lyra2Z/Lyra2Z.h"
 #include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Lyra2ZContext.h"
 #include "util.h"
 #include <iostream>
 #include <chrono>
 #include <fstream>
 #include <algorithm>
 #include <string>
-#include "precomputed_hash.h"
+#include "powhashindex.h"
 #include "zerocoin.h"
 
 
@@ -50,40 +51,30 @@ uint256 CBlockHeader::GetHash() const
     return SerializeHash(*this);
 }
 
-uint256 CBlockHeader::GetPoWHash(int nHeight) const {
-//    int64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(
-//            std::chrono::system_clock::now().time_since_epoch()).count();
-
-
-    bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET);
-    if (!fTestNet) {
-        if (nHeight < 233001) {
-            if (!mapPoWHash.count(1)) {
-                LogPrintf("Start Build Map\n");
-                buildMapPoWHash();
-            }
-        }
-        if (mapPoWHash.count(nHeight)) {
-//        std::cout << "GetPowHash nHeight=" << nHeight << ", hash= " << mapPoWHash[nHeight].ToString() << std::endl;
-            //LogPrintf("Process POWHASH %d \n", nHeight);
-            return mapPoWHash[nHeight];
-        }
+bool CBlockHeader::ComputePoWHash(int nHeight, uint256 &hash) const {
+    if (IsComputed()) {
+        hash = powHash;
+        return true;
     }
 
-    uint256 powHash;
+    if (powHashIndex.Lookup(nHeight, GetHash(), hash))
+        return true;
+
     try {
-        LYRA2(BEGIN(powHash), 32, BEGIN(nVersion), 80, BEGIN(nVersion), 80, 2, 330, 256);
+        if (Lyra2ZContext::ThreadContext().Hash(BEGIN(nVersion), BEGIN(hash)))
+            return true;
+        LogPrintf("CBlockHeader::ComputePoWHash: can't allocate the Lyra2Z matrix\n");
     } catch (std::exception &e) {
         LogPrintf("excepetion: %s", e.what());
     }
-//    int64_t end = std::chrono::duration_cast<std::chrono::milliseconds>(
-//            std::chrono::system_clock::now().time_since_epoch()).count();
-//    std::cout << "GetPowHash nHeight=" << nHeight << ", hash= " << powHash.ToString() << " done in= " << (end - start) << " miliseconds" << std::endl;
-    //LogPrintf("HEIGHT: %d POW: %s \n", nHeight, powHash.ToString());
-    //mapPoWHash.insert(make_pair(nHeight, powHash));
-//    SetPoWHash(thash);
-    //LogPrintf("Process POWHASH %d \n", nHeight);
-    return powHash;
+    return false;
+}
+
+uint256 CBlockHeader::GetPoWHash(int nHeight) const {
+    uint256 hash;
+    if (!ComputePoWHash(nHeight, hash))
+        memset(hash.begin(), 0xff, hash.size());
+    return hash;
 }
 
 std::string CBlock::ToString() const
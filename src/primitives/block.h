@@ -44,8 +44,9 @@ public:
     static const int CURRENT_VERSION = 2;
 
     // uint32_t lastHeight;
-    uint256 powHash;
-    int32_t isComputed;
+    // PoW hash computed ahead of validation, see SetPoWHash
+    mutable uint256 powHash;
+    mutable int32_t isComputed;
 
     CBlockHeader()
     {
@@ -62,6 +63,10 @@ public:
         READWRITE(nTime);
         READWRITE(nBits);
         READWRITE(nNonce);
+        if (ser_action.ForRead()) {
+            isComputed = -1;
+            powHash.SetNull();
+        }
     }
 
     void SetNull()
@@ -88,15 +93,21 @@ public:
 
     bool IsComputed() const
     {
-        return (isComputed <= 0);
+        return (isComputed > 0);
     }
 
+    // Caches the PoW hash of this header at the height it will be validated at, so it can be
+    // computed on another thread. The cache is dropped when the header is deserialized again
     void SetPoWHash(uint256 hash) const
     {
-//        isComputed = 1;
-//        powHash = hash;
+        isComputed = 1;
+        powHash = hash;
     }
 
+    // Computes the PoW hash of this header at nHeight. Returns false if Lyra2Z can't be evaluated
+    bool ComputePoWHash(int nHeight, uint256 &hash) const;
+
+    // PoW hash of this header at nHeight, or a hash that meets no target if it can't be computed
     uint256 GetPoWHash(int nHeight) const;
 
     uint256 GetHash() const;
@@ -159,7 +159,7 @@ void WalletModel::updateSigmaCoins(const QString &pubCoin, const QString &isUsed
         LOCK2(cs_main, wallet->cs_wallet);
         sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
         std::list<CSigmaEntry> coins;
-        CWalletDB(wallet->strWalletFile).ListSigmaPubCoin(coins);
+        wallet->ListSigmaMints(coins);
 
         int block = cachedNumBlocks;
         for (const auto& coin : coins) {
@@ -214,7 +214,7 @@ void WalletModel::checkSigmaAmount(bool forced)
 {
     if ((cachedHavePendingCoin && cachedNumBlocks > lastBlockCheckSigma) || forced ) {
         std::list<CSigmaEntry> coins;
-        CWalletDB(wallet->strWalletFile).ListSigmaPubCoin(coins);
+        wallet->ListSigmaMints(coins);
 
         std::vector<CSigmaEntry> spendable, pending;
 
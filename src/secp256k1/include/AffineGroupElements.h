@@ -0,0 +1,57 @@
+#ifndef SECP_AFFINE_GROUP_ELEMENTS_H
+#define SECP_AFFINE_GROUP_ELEMENTS_H
+
+#include "../include/GroupElement.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace secp_primitives {
+
+// Array of group elements kept in normalized affine form. Elements are normalized in batches
+// with a single shared field inversion, and take less than half the memory of GroupElement.
+// MultiExponent can consume them without converting every point again.
+class AffineGroupElements {
+public:
+    AffineGroupElements();
+    explicit AffineGroupElements(const std::vector<GroupElement>& elements);
+
+    // Appends elements, normalizing them all at once.
+    void append(const GroupElement* elements, std::size_t n);
+    void append(const std::vector<GroupElement>& elements);
+
+    // Appends elements [begin, end) of another array.
+    void append(const AffineGroupElements& other, std::size_t begin, std::size_t end);
+
+    GroupElement get(std::size_t i) const;
+
+    // Encoding of the elements, both affine coordinates of each in turn as 32 byte big endian
+    // numbers, taken from the normalized storage without any inversion. Meant for persisting the array.
+    std::vector<unsigned char> serialize() const;
+    // Appends the elements of an encoding written by serialize(), throws if it is not valid.
+    // Every element is only checked to be on the curve, no square roots or inversions are needed.
+    void append_serialized(const std::vector<unsigned char>& data);
+
+    std::size_t size() const;
+    bool empty() const;
+
+    // Only shrinking is supported.
+    void resize(std::size_t n);
+    void reserve(std::size_t n);
+    void clear();
+
+    static const std::size_t words_per_element = 8;
+    static const std::size_t serialized_size = 64;
+
+    friend class MultiExponent;
+private:
+    // Returns the secp256k1_ge_storage array.
+    const void * get_value() const;
+
+    std::vector<uint64_t> elements_; // secp256k1_ge_storage[]
+};
+
+} // namespace secp_primitives
+
+#endif // SECP_AFFINE_GROUP_ELEMENTS_H
@@ -0,0 +1,44 @@
+#ifndef SECP_FIXED_BASE_TABLE_H
+#define SECP_FIXED_BASE_TABLE_H
+
+#include "../include/GroupElement.h"
+#include "../include/Scalar.h"
+
+#include <cstddef>
+
+namespace secp_primitives {
+
+// Precomputed multiples of a fixed base, for exponentiations with a base known
+// ahead of time. The exponent is split into windows of window_bits bits, and
+// for window i the table keeps d * 2^(i * window_bits) * base for every
+// non-zero digit d, so a multiplication costs one mixed addition per window and
+// no doublings.
+class FixedBaseTable {
+public:
+    FixedBaseTable(const GroupElement& base, int window_bits);
+    ~FixedBaseTable();
+
+    FixedBaseTable(const FixedBaseTable& other) = delete;
+    FixedBaseTable& operator=(const FixedBaseTable& other) = delete;
+
+    // Returns true if element is the point the table was built for.
+    bool is_base(const GroupElement& element) const;
+
+    GroupElement get_multiple(const Scalar& exponent) const;
+
+    // Adds base * exponent to result_out.
+    void add_multiple(const Scalar& exponent, GroupElement& result_out) const;
+
+    // Bytes of table storage for one base with the given window size.
+    static std::size_t memory_required(int window_bits);
+
+private:
+    GroupElement base_;
+    int window_bits_;
+    int windows_;
+    void *table_; // secp256k1_ge_storage[windows_][2^window_bits_ - 1]
+};
+
+}// namespace secp_primitives
+
+#endif //SECP_FIXED_BASE_TABLE_H
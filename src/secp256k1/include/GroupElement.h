@@ -104,6 +104,8 @@ public:
   std::size_t hash() const;
 
   friend class MultiExponent;
+  friend class FixedBaseTable;
+  friend class AffineGroupElements;
 private:
     // Returns the secp object inside it.
     const void * get_value() const;
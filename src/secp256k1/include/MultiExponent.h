@@ -1,24 +1,48 @@
 #ifndef SECP_MULTIEXPONENT_H
 #define SECP_MULTIEXPONENT_H
 
+#include <cstddef>
 #include <vector>
+#include "../include/AffineGroupElements.h"
 #include "../include/GroupElement.h"
 #include "../include/Scalar.h"
 
 namespace secp_primitives {
 
+// Computes sum(generators[i] * powers[i]).
+//
+// The generators and powers (and the affine elements and their powers) are borrowed, not
+// copied: they must outlive this object and stay unchanged until get_multiple(), and a copy
+// of a MultiExponent borrows the same inputs. Temporary vectors are rejected at compile time.
 class MultiExponent {
 public:
     MultiExponent(const MultiExponent& other);
     MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers);
+    MultiExponent(std::vector<GroupElement>&& generators, const std::vector<Scalar>& powers) = delete;
+    MultiExponent(const std::vector<GroupElement>& generators, std::vector<Scalar>&& powers) = delete;
+    MultiExponent(std::vector<GroupElement>&& generators, std::vector<Scalar>&& powers) = delete;
+    MultiExponent(const GroupElement* generators, const Scalar* powers, std::size_t n);
+
+    // Adds affine_elements[i] * affine_powers[i] to the sum, affine_powers has one scalar per element.
+    MultiExponent(const AffineGroupElements& affine_elements, const Scalar* affine_powers,
+                  const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers);
     ~MultiExponent();
 
     GroupElement get_multiple();
 
+    // Computes results[k] = sum(generators[i] * powers[k * n + i]) for every k < n_outputs. The
+    // generators are normalized once and shared by all the sums, instead of once per sum.
+    static void get_multiples(const GroupElement* generators, std::size_t n,
+                              const Scalar* powers, std::size_t n_outputs, GroupElement* results);
+    static std::vector<GroupElement> get_multiples(const std::vector<GroupElement>& generators,
+                                                   const std::vector<Scalar>& powers, std::size_t n_outputs);
+
 private:
-    void  *sc_; // secp256k1_scalar[]
-    void  *pt_; // secp256k1_gej[]
+    const GroupElement *generators_;
+    const Scalar *powers_;
     int n_points;
+    const AffineGroupElements *affine_;
+    const Scalar *affine_powers_;
 };
 
 }// namespace secp_primitives
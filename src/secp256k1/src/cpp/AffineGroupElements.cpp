@@ -0,0 +1,144 @@
+#include "../include/AffineGroupElements.h"
+
+#include "../include/secp256k1.h"
+#include "../field.h"
+#include "../field_impl.h"
+#include "../group.h"
+#include "../group_impl.h"
+
+#include <stdexcept>
+
+namespace secp_primitives {
+
+static_assert(sizeof(secp256k1_ge_storage) == 8 * sizeof(uint64_t),
+              "AffineGroupElements expects 64 byte secp256k1_ge_storage");
+
+AffineGroupElements::AffineGroupElements()
+{
+}
+
+AffineGroupElements::AffineGroupElements(const std::vector<GroupElement>& elements)
+{
+    append(elements);
+}
+
+void AffineGroupElements::append(const GroupElement* elements, std::size_t n)
+{
+    if (n == 0)
+        return;
+
+    std::vector<secp256k1_gej> points(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        points[i] = *reinterpret_cast<const secp256k1_gej *>(elements[i].get_value());
+        // Storage form has no way to keep the point at infinity.
+        if (points[i].infinity)
+            throw std::invalid_argument("AffineGroupElements: point at infinity");
+    }
+
+    std::vector<secp256k1_ge> affine(n);
+    secp256k1_ge_set_all_gej_var(affine.data(), points.data(), n, NULL);
+
+    std::size_t offset = elements_.size();
+    elements_.resize(offset + n * words_per_element);
+    secp256k1_ge_storage *storage = reinterpret_cast<secp256k1_ge_storage *>(&elements_[offset]);
+    for (std::size_t i = 0; i < n; ++i)
+        secp256k1_ge_to_storage(&storage[i], &affine[i]);
+}
+
+void AffineGroupElements::append(const std::vector<GroupElement>& elements)
+{
+    append(elements.data(), elements.size());
+}
+
+void AffineGroupElements::append(const AffineGroupElements& other, std::size_t begin, std::size_t end)
+{
+    elements_.insert(elements_.end(),
+                     other.elements_.begin() + begin * words_per_element,
+                     other.elements_.begin() + end * words_per_element);
+}
+
+GroupElement AffineGroupElements::get(std::size_t i) const
+{
+    secp256k1_ge ge;
+    secp256k1_gej gej;
+    secp256k1_ge_from_storage(&ge, reinterpret_cast<const secp256k1_ge_storage *>(&elements_[i * words_per_element]));
+    secp256k1_gej_set_ge(&gej, &ge);
+    return GroupElement(&gej);
+}
+
+std::vector<unsigned char> AffineGroupElements::serialize() const
+{
+    const secp256k1_ge_storage *storage = reinterpret_cast<const secp256k1_ge_storage *>(elements_.data());
+    std::vector<unsigned char> data(size() * serialized_size);
+    for (std::size_t i = 0; i < size(); ++i) {
+        secp256k1_ge ge;
+        secp256k1_ge_from_storage(&ge, &storage[i]);
+        secp256k1_fe_normalize(&ge.x);
+        secp256k1_fe_normalize(&ge.y);
+        unsigned char *buffer = &data[i * serialized_size];
+        secp256k1_fe_get_b32(buffer, &ge.x);
+        secp256k1_fe_get_b32(buffer + 32, &ge.y);
+    }
+    return data;
+}
+
+void AffineGroupElements::append_serialized(const std::vector<unsigned char>& data)
+{
+    if (data.size() % serialized_size != 0)
+        throw std::invalid_argument("AffineGroupElements: incomplete element encoding");
+
+    std::size_t n = data.size() / serialized_size;
+    std::size_t offset = elements_.size();
+    elements_.resize(offset + n * words_per_element);
+    secp256k1_ge_storage *storage = reinterpret_cast<secp256k1_ge_storage *>(&elements_[offset]);
+    for (std::size_t i = 0; i < n; ++i) {
+        const unsigned char *buffer = &data[i * serialized_size];
+        secp256k1_fe x, y;
+        secp256k1_ge ge;
+        // both coordinates are stored, only check that the point is on the curve
+        if (!secp256k1_fe_set_b32(&x, buffer) || !secp256k1_fe_set_b32(&y, buffer + 32)) {
+            elements_.resize(offset);
+            throw std::invalid_argument("AffineGroupElements: invalid element encoding");
+        }
+        secp256k1_ge_set_xy(&ge, &x, &y);
+        if (!secp256k1_ge_is_valid_var(&ge)) {
+            elements_.resize(offset);
+            throw std::invalid_argument("AffineGroupElements: invalid element encoding");
+        }
+        secp256k1_ge_to_storage(&storage[i], &ge);
+    }
+}
+
+std::size_t AffineGroupElements::size() const
+{
+    return elements_.size() / words_per_element;
+}
+
+bool AffineGroupElements::empty() const
+{
+    return elements_.empty();
+}
+
+void AffineGroupElements::resize(std::size_t n)
+{
+    if (n > size())
+        throw std::invalid_argument("AffineGroupElements: resize can only shrink");
+    elements_.resize(n * words_per_element);
+}
+
+void AffineGroupElements::reserve(std::size_t n)
+{
+    elements_.reserve(n * words_per_element);
+}
+
+void AffineGroupElements::clear()
+{
+    elements_.clear();
+}
+
+const void * AffineGroupElements::get_value() const
+{
+    return elements_.data();
+}
+
+} // namespace secp_primitives
@@ -0,0 +1,122 @@
+#include "../include/FixedBaseTable.h"
+
+#include "../include/secp256k1.h"
+#include "../field.h"
+#include "../field_impl.h"
+#include "../group.h"
+#include "../group_impl.h"
+#include "../scalar.h"
+#include "../scalar_impl.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace secp_primitives {
+
+static const int SCALAR_BITS = 256;
+
+FixedBaseTable::FixedBaseTable(const GroupElement& base, int window_bits)
+        : base_(base)
+        , window_bits_(window_bits)
+        , windows_(0)
+        , table_(NULL)
+{
+    if (window_bits < 1 || window_bits > 16)
+        throw std::invalid_argument("FixedBaseTable: window size out of range");
+
+    const secp256k1_gej *b = reinterpret_cast<const secp256k1_gej *>(base_.get_value());
+    if (secp256k1_gej_is_infinity(b))
+        return;
+
+    windows_ = (SCALAR_BITS + window_bits_ - 1) / window_bits_;
+    const std::size_t digits = (std::size_t(1) << window_bits_) - 1;
+    const std::size_t size = windows_ * digits;
+
+    // Build every entry in jacobian coordinates, then normalize them all with a
+    // single field inversion.
+    std::vector<secp256k1_gej> points(size);
+    secp256k1_gej window_base = *b;
+    for (int i = 0; i < windows_; ++i) {
+        secp256k1_gej *row = &points[i * digits];
+        row[0] = window_base;
+        for (std::size_t d = 1; d < digits; ++d)
+            secp256k1_gej_add_var(&row[d], &row[d - 1], &window_base, NULL);
+        // 2^window_bits * window_base is the last entry plus one more base.
+        secp256k1_gej_add_var(&window_base, &row[digits - 1], &window_base, NULL);
+    }
+
+    std::vector<secp256k1_ge> affine(size);
+    secp256k1_ge_set_all_gej_var(affine.data(), points.data(), size, NULL);
+
+    secp256k1_ge_storage *table = new secp256k1_ge_storage[size];
+    for (std::size_t i = 0; i < size; ++i)
+        secp256k1_ge_to_storage(&table[i], &affine[i]);
+    table_ = table;
+}
+
+FixedBaseTable::~FixedBaseTable()
+{
+    delete []reinterpret_cast<secp256k1_ge_storage *>(table_);
+}
+
+bool FixedBaseTable::is_base(const GroupElement& element) const
+{
+    const secp256k1_gej *e = reinterpret_cast<const secp256k1_gej *>(element.get_value());
+    // No table is built for the point at infinity
+    if (table_ == NULL || e->infinity)
+        return table_ == NULL && e->infinity;
+
+    // Same test as GroupElement::operator==, but against the affine base kept as the first
+    // entry of the table, so no field inversion is needed: x == X / Z^2 and y == Y / Z^3.
+    secp256k1_ge base;
+    secp256k1_ge_from_storage(&base, reinterpret_cast<const secp256k1_ge_storage *>(table_));
+
+    secp256k1_fe z2, z3, t, u;
+    secp256k1_fe_sqr(&z2, &e->z);
+    secp256k1_fe_mul(&t, &base.x, &z2);
+    u = e->x;
+    secp256k1_fe_normalize_weak(&u);
+    if (!secp256k1_fe_equal_var(&t, &u))
+        return false;
+
+    secp256k1_fe_mul(&z3, &z2, &e->z);
+    secp256k1_fe_mul(&t, &base.y, &z3);
+    u = e->y;
+    secp256k1_fe_normalize_weak(&u);
+    return secp256k1_fe_equal_var(&t, &u);
+}
+
+GroupElement FixedBaseTable::get_multiple(const Scalar& exponent) const
+{
+    GroupElement result;
+    add_multiple(exponent, result);
+    return result;
+}
+
+void FixedBaseTable::add_multiple(const Scalar& exponent, GroupElement& result_out) const
+{
+    const secp256k1_scalar *s = reinterpret_cast<const secp256k1_scalar *>(exponent.get_value());
+    const secp256k1_ge_storage *table = reinterpret_cast<const secp256k1_ge_storage *>(table_);
+    const std::size_t digits = (std::size_t(1) << window_bits_) - 1;
+
+    secp256k1_gej *r = reinterpret_cast<secp256k1_gej *>(result_out.g_);
+    secp256k1_ge ge;
+    for (int i = 0; i < windows_; ++i) {
+        unsigned int offset = i * window_bits_;
+        unsigned int count = std::min(window_bits_, SCALAR_BITS - int(offset));
+        unsigned int d = secp256k1_scalar_get_bits_var(s, offset, count);
+        if (d == 0)
+            continue;
+        secp256k1_ge_from_storage(&ge, &table[i * digits + d - 1]);
+        secp256k1_gej_add_ge_var(r, r, &ge, NULL);
+    }
+}
+
+std::size_t FixedBaseTable::memory_required(int window_bits)
+{
+    std::size_t windows = (SCALAR_BITS + window_bits - 1) / window_bits;
+    return windows * ((std::size_t(1) << window_bits) - 1) * sizeof(secp256k1_ge_storage);
+}
+
+}// namespace secp_primitives
@@ -12,73 +12,191 @@
 #include "../src/scratch_impl.h"
 #include "../src/ecmult_impl.h"
 
+namespace {
+
+// Each thread keeps the scratch space of its last call, sized to a power of two, and its
+// frames keep their buffers between calls. The retained space is capped at what a verification
+// over a full 16384 coin anonymity set needs, larger spaces are allocated per call, so a thread
+// (such as a task pool worker) never holds on to more than that once its work is done.
+const int MIN_POOLED_SCRATCH_CLASS = 12;
+const int MAX_POOLED_SCRATCH_CLASS = 23;
+
+class ScratchPool {
+public:
+    ScratchPool() : space_(NULL), space_size_(0) {
+    }
+
+    ~ScratchPool() {
+        secp256k1_scratch_destroy(space_);
+    }
+
+    secp256k1_scratch* acquire(size_t size) {
+        int size_class = MIN_POOLED_SCRATCH_CLASS;
+        while (size_class <= MAX_POOLED_SCRATCH_CLASS && (size_t(1) << size_class) < size)
+            ++size_class;
+        if (size_class > MAX_POOLED_SCRATCH_CLASS)
+            return secp256k1_scratch_create(NULL, size);
+
+        if (space_ == NULL || space_size_ < (size_t(1) << size_class)) {
+            secp256k1_scratch_destroy(space_);
+            space_size_ = size_t(1) << size_class;
+            space_ = secp256k1_scratch_create(NULL, space_size_);
+            space_->retain_frames = 1;
+        }
+        return space_;
+    }
 
-typedef struct {
-    secp256k1_scalar *sc;
-    secp256k1_gej *pt;
-} ecmult_multi_data;
+    static void release(secp256k1_scratch *scratch) {
+        if (!scratch->retain_frames)
+            secp256k1_scratch_destroy(scratch);
+    }
+
+private:
+    secp256k1_scratch *space_;
+    size_t space_size_;
+};
+
+thread_local ScratchPool scratch_pool;
 
-int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, void *cbdata) {
-    ecmult_multi_data *data = (ecmult_multi_data*) cbdata;
-    *sc = data->sc[idx];
-    *pt = data->pt[idx];
-    return 1;
+secp256k1_scratch* acquire_scratch(size_t n_points) {
+    size_t scratch_size;
+    if (n_points > ECMULT_PIPPENGER_THRESHOLD) {
+        int bucket_window = secp256k1_pippenger_bucket_window(n_points);
+        scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
+    } else {
+        scratch_size = secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT;
+    }
+    return scratch_pool.acquire(scratch_size);
 }
 
+} // namespace
+
 namespace secp_primitives {
 
 MultiExponent::MultiExponent(const MultiExponent& other)
-        : sc_(new secp256k1_scalar[other.n_points])
-        , pt_(new secp256k1_gej[other.n_points])
+        : generators_(other.generators_)
+        , powers_(other.powers_)
         , n_points(other.n_points)
+        , affine_(other.affine_)
+        , affine_powers_(other.affine_powers_)
 {
-    for(int i = 0; i < n_points; ++i)
-    {
-        (reinterpret_cast<secp256k1_scalar *>(sc_))[i] = (reinterpret_cast<secp256k1_scalar *>(other.sc_))[i];
-        (reinterpret_cast<secp256k1_gej *>(pt_))[i] = (reinterpret_cast<secp256k1_gej *>(other.pt_))[i];
-    }
 }
 
-MultiExponent::MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers){
-    sc_ = new secp256k1_scalar[powers.size()];
-    pt_ = new secp256k1_gej[generators.size()];
-    n_points = generators.size();
-    for(int i = 0; i < n_points; ++i)
-    {
-        (reinterpret_cast<secp256k1_scalar *>(sc_))[i] = *reinterpret_cast<const secp256k1_scalar *>(powers[i].get_value());
-        (reinterpret_cast<secp256k1_gej *>(pt_))[i] = *reinterpret_cast<const secp256k1_gej *>(generators[i].get_value());
-    }
+MultiExponent::MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers)
+        : generators_(generators.data())
+        , powers_(powers.data())
+        , n_points(generators.size())
+        , affine_(NULL)
+        , affine_powers_(NULL)
+{
+}
+
+MultiExponent::MultiExponent(const GroupElement* generators, const Scalar* powers, std::size_t n)
+        : generators_(generators)
+        , powers_(powers)
+        , n_points(n)
+        , affine_(NULL)
+        , affine_powers_(NULL)
+{
+}
+
+MultiExponent::MultiExponent(const AffineGroupElements& affine_elements, const Scalar* affine_powers,
+                             const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers)
+        : generators_(generators.data())
+        , powers_(powers.data())
+        , n_points(generators.size())
+        , affine_(&affine_elements)
+        , affine_powers_(affine_powers)
+{
 }
 
 MultiExponent::~MultiExponent(){
-    delete []reinterpret_cast<secp256k1_scalar *>(sc_);
-    delete []reinterpret_cast<secp256k1_gej *>(pt_);
 }
 
 GroupElement MultiExponent::get_multiple() {
     secp256k1_gej r;
 
-    ecmult_multi_data data;
-    data.sc = reinterpret_cast<secp256k1_scalar *>(sc_);
-    data.pt = reinterpret_cast<secp256k1_gej *>(pt_);
-
-    secp256k1_scratch *scratch;
-    if (n_points > ECMULT_PIPPENGER_THRESHOLD) {
-        int bucket_window = secp256k1_pippenger_bucket_window(n_points);
-        size_t scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
-    } else {
-        size_t scratch_size = secp256k1_strauss_scratch_size(n_points);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
-    }
+    // Points and scalars are read straight from the caller's elements as the algorithm
+    // asks for them, instead of being copied into arrays first.
+    auto callback = [](secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, void *cbdata) -> int {
+        const MultiExponent *data = reinterpret_cast<const MultiExponent *>(cbdata);
+        *sc = *reinterpret_cast<const secp256k1_scalar *>(data->powers_[idx].get_value());
+        *pt = *reinterpret_cast<const secp256k1_gej *>(data->generators_[idx].get_value());
+        return 1;
+    };
+
+    // Affine elements come first and are passed on without normalization, the generators
+    // are few and are normalized one by one.
+    auto ge_callback = [](secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) -> int {
+        const MultiExponent *data = reinterpret_cast<const MultiExponent *>(cbdata);
+        std::size_t n_affine = data->affine_->size();
+        if (idx < n_affine) {
+            const secp256k1_ge_storage *storage = reinterpret_cast<const secp256k1_ge_storage *>(data->affine_->get_value());
+            *sc = *reinterpret_cast<const secp256k1_scalar *>(data->affine_powers_[idx].get_value());
+            secp256k1_ge_from_storage(pt, &storage[idx]);
+        } else {
+            secp256k1_gej gej = *reinterpret_cast<const secp256k1_gej *>(data->generators_[idx - n_affine].get_value());
+            *sc = *reinterpret_cast<const secp256k1_scalar *>(data->powers_[idx - n_affine].get_value());
+            secp256k1_ge_set_gej(pt, &gej);
+        }
+        return 1;
+    };
+
+    size_t n_total = n_points + (affine_ ? affine_->size() : 0);
+    secp256k1_scratch *scratch = acquire_scratch(n_total);
 
     secp256k1_ecmult_context ctx;
 
-    secp256k1_ecmult_multi_var(&ctx, scratch, &r, NULL, ecmult_multi_callback, &data, n_points);
+    if (affine_)
+        secp256k1_ecmult_multi_ge_var(&ctx, scratch, &r, NULL, ge_callback, this, n_total);
+    else
+        secp256k1_ecmult_multi_var(&ctx, scratch, &r, NULL, callback, this, n_total);
 
-    secp256k1_scratch_destroy(scratch);
+    ScratchPool::release(scratch);
 
     return  reinterpret_cast<secp256k1_scalar *>(&r);
 }
 
+void MultiExponent::get_multiples(const GroupElement* generators, std::size_t n,
+                                  const Scalar* powers, std::size_t n_outputs, GroupElement* results) {
+    struct SumData {
+        const secp256k1_ge *points;
+        const Scalar *powers;
+    };
+
+    // A single field inversion normalizes all the generators, points at infinity are kept
+    // as such and skipped by the multiplication.
+    std::vector<secp256k1_ge> points(n);
+    {
+        std::vector<secp256k1_gej> jacobian(n);
+        for (std::size_t i = 0; i < n; ++i)
+            jacobian[i] = *reinterpret_cast<const secp256k1_gej *>(generators[i].get_value());
+        secp256k1_ge_set_all_gej_var(points.data(), jacobian.data(), n, NULL);
+    }
+
+    auto callback = [](secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) -> int {
+        const SumData *data = reinterpret_cast<const SumData *>(cbdata);
+        *sc = *reinterpret_cast<const secp256k1_scalar *>(data->powers[idx].get_value());
+        *pt = data->points[idx];
+        return 1;
+    };
+
+    secp256k1_scratch *scratch = acquire_scratch(n);
+    secp256k1_ecmult_context ctx;
+    for (std::size_t k = 0; k < n_outputs; ++k) {
+        SumData data = {points.data(), powers + k * n};
+        secp256k1_gej r;
+        secp256k1_ecmult_multi_ge_var(&ctx, scratch, &r, NULL, callback, &data, n);
+        results[k] = GroupElement(&r);
+    }
+    ScratchPool::release(scratch);
+}
+
+std::vector<GroupElement> MultiExponent::get_multiples(const std::vector<GroupElement>& generators,
+                                                       const std::vector<Scalar>& powers, std::size_t n_outputs) {
+    std::vector<GroupElement> results(n_outputs);
+    get_multiples(generators.data(), generators.size(), powers.data(), n_outputs, results.data());
+    return results;
+}
+
 }// namespace secp_primitives
@@ -53,6 +53,15 @@ typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge
  */
 static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
 
+typedef int (secp256k1_ecmult_multi_ge_callback)(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data);
+
+/**
+ * Same as secp256k1_ecmult_multi_var, but the callback provides points in
+ * affine coordinates. Pippenger uses them as is, instead of normalizing every
+ * point with its own field inversion.
+ */
+static int secp256k1_ecmult_multi_ge_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_ge_callback cb, void *cbdata, size_t n);
+
 
 
 #endif
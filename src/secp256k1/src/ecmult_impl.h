@@ -794,7 +794,8 @@ static size_t secp256k1_pippenger_scratch_size(size_t n_points, int bucket_windo
     return ((1<<bucket_window) * sizeof(secp256k1_gej) + sizeof(struct secp256k1_pippenger_state) + entries * entry_size);
 }
 
-static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+/* Exactly one of cb and cb_ge is used, points from cb_ge are taken without normalization. */
+static int secp256k1_ecmult_pippenger_batch_impl(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, secp256k1_ecmult_multi_ge_callback cb_ge, void *cbdata, size_t n_points, size_t cb_offset) {
     /* Use 2(n+1) with the endomorphism, n+1 without, when calculating batch
      * sizes. The reason for +1 is that we add the G scalar to the list of
      * other scalars. */
@@ -840,12 +841,19 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
     }
 
     while (point_idx < n_points) {
-        secp256k1_gej point;
-        if (!cb(&scalars[idx], &point, point_idx + cb_offset, cbdata)) {
-            secp256k1_scratch_deallocate_frame(scratch);
-            return 0;
+        if (cb_ge != NULL) {
+            if (!cb_ge(&scalars[idx], &points[idx], point_idx + cb_offset, cbdata)) {
+                secp256k1_scratch_deallocate_frame(scratch);
+                return 0;
+            }
+        } else {
+            secp256k1_gej point;
+            if (!cb(&scalars[idx], &point, point_idx + cb_offset, cbdata)) {
+                secp256k1_scratch_deallocate_frame(scratch);
+                return 0;
+            }
+            secp256k1_ge_set_gej(&points[idx], &point);
         }
-        secp256k1_ge_set_gej(&points[idx], &point);
         idx++;
 #ifdef USE_ENDOMORPHISM
         secp256k1_ecmult_endo_split(&scalars[idx - 1], &scalars[idx], &points[idx - 1], &points[idx]);
@@ -872,6 +880,10 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
 }
 
 
+static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    return secp256k1_ecmult_pippenger_batch_impl(ctx, scratch, r, inp_g_sc, cb, NULL, cbdata, n_points, cb_offset);
+}
+
 /* Wrapper for secp256k1_ecmult_multi_func interface */
 static int secp256k1_ecmult_pippenger_batch_single(const secp256k1_ecmult_context *actx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
     return secp256k1_ecmult_pippenger_batch(actx, scratch, r, inp_g_sc, cb, cbdata, n, 0);
@@ -920,13 +932,33 @@ static size_t secp256k1_pippenger_max_points(secp256k1_scratch *scratch) {
 
 
 typedef int (*secp256k1_ecmult_multi_func)(const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t);
-static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+typedef struct {
+    secp256k1_ecmult_multi_ge_callback *cb;
+    void *cbdata;
+} secp256k1_ecmult_multi_ge_data;
+
+/* Adapts an affine point callback for Strauss, which takes jacobian points. */
+static int secp256k1_ecmult_multi_ge_to_gej_callback(secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, void *data) {
+    secp256k1_ecmult_multi_ge_data *ge_data = (secp256k1_ecmult_multi_ge_data *) data;
+    secp256k1_ge ge;
+    if (!ge_data->cb(sc, &ge, idx, ge_data->cbdata)) {
+        return 0;
+    }
+    secp256k1_gej_set_ge(pt, &ge);
+    return 1;
+}
+
+/* Exactly one of cb and cb_ge is used. */
+static int secp256k1_ecmult_multi_var_impl(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, secp256k1_ecmult_multi_ge_callback cb_ge, void *cbdata, size_t n) {
     size_t i;
 
-    int (*f)(const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
+    int use_pippenger;
     size_t max_points;
     size_t n_batches;
     size_t n_batch_points;
+    secp256k1_ecmult_multi_ge_data ge_data;
+    secp256k1_ecmult_multi_callback *strauss_cb = cb;
+    void *strauss_cbdata = cbdata;
 
     secp256k1_gej_set_infinity(r);
     if (inp_g_sc == NULL && n == 0) {
@@ -938,6 +970,13 @@ static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp2
         return 1;
     }
 
+    if (cb_ge != NULL) {
+        ge_data.cb = cb_ge;
+        ge_data.cbdata = cbdata;
+        strauss_cb = secp256k1_ecmult_multi_ge_to_gej_callback;
+        strauss_cbdata = &ge_data;
+    }
+
     max_points = secp256k1_pippenger_max_points(scratch);
     if (max_points == 0) {
         return 0;
@@ -948,7 +987,7 @@ static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp2
     n_batch_points = (n+n_batches-1)/n_batches;
 
     if (n_batch_points >= ECMULT_PIPPENGER_THRESHOLD) {
-        f = secp256k1_ecmult_pippenger_batch;
+        use_pippenger = 1;
     } else {
         max_points = secp256k1_strauss_max_points(scratch);
         if (max_points == 0) {
@@ -956,13 +995,19 @@ static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp2
         }
         n_batches = (n+max_points-1)/max_points;
         n_batch_points = (n+n_batches-1)/n_batches;
-        f = secp256k1_ecmult_strauss_batch;
+        use_pippenger = 0;
     }
     for(i = 0; i < n_batches; i++) {
         size_t nbp = n < n_batch_points ? n : n_batch_points;
         size_t offset = n_batch_points*i;
         secp256k1_gej tmp;
-        if (!f(ctx, scratch, &tmp, i == 0 ? inp_g_sc : NULL, cb, cbdata, nbp, offset)) {
+        int ok;
+        if (use_pippenger) {
+            ok = secp256k1_ecmult_pippenger_batch_impl(ctx, scratch, &tmp, i == 0 ? inp_g_sc : NULL, cb, cb_ge, cbdata, nbp, offset);
+        } else {
+            ok = secp256k1_ecmult_strauss_batch(ctx, scratch, &tmp, i == 0 ? inp_g_sc : NULL, strauss_cb, strauss_cbdata, nbp, offset);
+        }
+        if (!ok) {
             return 0;
         }
         secp256k1_gej_add_var(r, r, &tmp, NULL);
@@ -971,4 +1016,12 @@ static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp2
     return 1;
 }
 
+static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_multi_var_impl(ctx, scratch, r, inp_g_sc, cb, NULL, cbdata, n);
+}
+
+static int secp256k1_ecmult_multi_ge_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_ge_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_multi_var_impl(ctx, scratch, r, inp_g_sc, NULL, cb, cbdata, n);
+}
+
 #endif
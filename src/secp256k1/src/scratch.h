@@ -18,6 +18,12 @@ typedef struct secp256k1_scratch_space_struct {
     size_t frame;
     size_t max_size;
     const secp256k1_callback* error_callback;
+    /* When set, deallocated frames keep their buffers for reuse by later frames
+     * at the same depth, until the scratch space is destroyed. retained_size
+     * is the capacity of the buffer allocated for each depth. */
+    int retain_frames;
+    void *retained[SECP256K1_SCRATCH_MAX_FRAMES];
+    size_t retained_size[SECP256K1_SCRATCH_MAX_FRAMES];
 } secp256k1_scratch;
 
 static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, size_t max_size);
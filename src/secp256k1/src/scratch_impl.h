@@ -27,7 +27,11 @@ static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* err
 
 static void secp256k1_scratch_destroy(secp256k1_scratch* scratch) {
     if (scratch != NULL) {
+        size_t i;
         VERIFY_CHECK(scratch->frame == 0);
+        for (i = 0; i < SECP256K1_SCRATCH_MAX_FRAMES; i++) {
+            free(scratch->retained[i]);
+        }
         free(scratch);
     }
 }
@@ -49,9 +53,17 @@ static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n
 
     if (n <= secp256k1_scratch_max_allocation(scratch, objects)) {
         n += objects * ALIGNMENT;
-        scratch->data[scratch->frame] = checked_malloc(scratch->error_callback, n);
-        if (scratch->data[scratch->frame] == NULL) {
-            return 0;
+        if (scratch->retained[scratch->frame] != NULL && scratch->retained_size[scratch->frame] >= n) {
+            scratch->data[scratch->frame] = scratch->retained[scratch->frame];
+            scratch->retained[scratch->frame] = NULL;
+        } else {
+            free(scratch->retained[scratch->frame]);
+            scratch->retained[scratch->frame] = NULL;
+            scratch->data[scratch->frame] = checked_malloc(scratch->error_callback, n);
+            if (scratch->data[scratch->frame] == NULL) {
+                return 0;
+            }
+            scratch->retained_size[scratch->frame] = n;
         }
         scratch->frame_size[scratch->frame] = n;
         scratch->offset[scratch->frame] = 0;
@@ -65,7 +77,11 @@ static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n
 static void secp256k1_scratch_deallocate_frame(secp256k1_scratch* scratch) {
     VERIFY_CHECK(scratch->frame > 0);
     scratch->frame -= 1;
-    free(scratch->data[scratch->frame]);
+    if (scratch->retain_frames) {
+        scratch->retained[scratch->frame] = scratch->data[scratch->frame];
+    } else {
+        free(scratch->data[scratch->frame]);
+    }
 }
 
 static void *secp256k1_scratch_alloc(secp256k1_scratch* scratch, size_t size) {
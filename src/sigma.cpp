@@ -2,6 +2,8 @@
 #include "sigma.h"
 #include "zerocoin.h" // Mostly for reusing class libzerocoin::SpendMetaData
 #include "timedata.h"
+#include "txdb.h"
+#include "statesnapshot.h"
 #include "chainparams.h"
 #include "util.h"
 #include "base58.h"
@@ -9,6 +11,8 @@
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "crypto/sha256.h"
+#include "memusage.h"
+#include "random.h"
 #include "sigma/coinspend.h"
 #include "sigma/coin.h"
 #include "noirnode-payments.h"
@@ -21,6 +25,7 @@
 #include <chrono>
 
 #include <boost/foreach.hpp>
+#include <boost/thread.hpp>
 
 #include <ios>
 
@@ -31,6 +36,71 @@ sigma::Params* SigmaParams = sigma::Params::get_default();
 
 static CSigmaState sigmaState;
 
+// Sigma records of blocks connected since the last flush of the block index
+static std::map<const CBlockIndex *, CSigmaBlockIndex> unsavedSigmaBlockIndexes;
+// Hashes of the blocks having a sigma record in the block tree database, so that blocks without
+// sigma transactions don't cost a database read each. Not used until loaded by BuildSigmaStateFromIndex
+static std::set<uint256> sigmaBlockIndexHashes;
+static bool fSigmaBlockIndexHashesLoaded = false;
+
+CSigmaProofCache::CSigmaProofCache()
+{
+    GetRandBytes(nonce.begin(), 32);
+}
+
+void CSigmaProofCache::ComputeEntry(
+        uint256& entry,
+        const CScript& spendScript,
+        const SpendMetaData& metadata,
+        CoinDenomination denomination,
+        const uint256& anonymitySetHash,
+        bool fPadding)
+{
+    unsigned char denom = (unsigned char)denomination;
+    unsigned char padding = fPadding ? 1 : 0;
+    uint256 accumulatorId = ArithToUint256(metadata.accumulatorId);
+    CSHA256()
+        .Write(nonce.begin(), 32)
+        .Write(&spendScript[0], spendScript.size())
+        .Write(accumulatorId.begin(), 32)
+        .Write(metadata.blockHash.begin(), 32)
+        .Write(metadata.txHash.begin(), 32)
+        .Write(&denom, 1)
+        .Write(anonymitySetHash.begin(), 32)
+        .Write(&padding, 1)
+        .Finalize(entry.begin());
+}
+
+bool CSigmaProofCache::Get(const uint256& entry)
+{
+    boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+    return setValid.count(entry);
+}
+
+void CSigmaProofCache::Set(const uint256& entry)
+{
+    size_t nMaxCacheSize = GetArg("-maxsigmaproofcachesize", DEFAULT_MAX_SIGMA_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+    if (nMaxCacheSize <= 0) return;
+
+    boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+    while (memusage::DynamicUsage(setValid) > nMaxCacheSize)
+    {
+        map_type::size_type s = GetRand(setValid.bucket_count());
+        map_type::local_iterator it = setValid.begin(s);
+        if (it != setValid.end(s)) {
+            setValid.erase(*it);
+        }
+    }
+
+    setValid.insert(entry);
+}
+
+CSigmaProofCache& GetSigmaProofCache()
+{
+    static CSigmaProofCache proofCache;
+    return proofCache;
+}
+
 static bool CheckSigmaSpendSerial(
         CValidationState &state,
         CSigmaTxInfo *sigmaTxInfo,
@@ -152,6 +222,52 @@ bool CheckSigmaBlock(CValidationState &state, const CBlock& block) {
     return true;
 }
 
+bool CSigmaSpendCheck::operator()() {
+    std::vector<const sigma::CoinSpend*> spends;
+    spends.reserve(nEnd - nBegin);
+    for (std::size_t i = nBegin; i < nEnd; ++i)
+        spends.push_back(batch->spends[i].get());
+
+    std::vector<sigma::SpendMetaData> metadata(batch->metadata.begin() + nBegin, batch->metadata.begin() + nEnd);
+    if (!sigma::CoinSpend::BatchVerify(batch->anonymitySet, spends, metadata, fPadding)) {
+        LogPrintf("CSigmaSpendCheck: verification of %d spends failed\n", spends.size());
+        return false;
+    }
+
+    // the block is usually checked more than once, remember the result for the next time
+    for (std::size_t i = nBegin; i < nEnd; ++i)
+        GetSigmaProofCache().Set(batch->cacheEntries[i]);
+    return true;
+}
+
+void GetSigmaSpendChecks(CSigmaTxInfo *sigmaTxInfo, std::vector<CSigmaSpendCheck> &vChecks, unsigned int nChecksPerBatch) {
+    if (!sigmaTxInfo)
+        return;
+
+    for (const auto& entry : sigmaTxInfo->spendBatches) {
+        std::size_t nSpends = entry.second->spends.size();
+        // Every check pays for the whole anonymity set, so don't split batches into tiny pieces
+        std::size_t nChecks = std::max<std::size_t>(1, std::min<std::size_t>(nChecksPerBatch, nSpends));
+        for (std::size_t i = 0; i < nChecks; ++i) {
+            vChecks.emplace_back(entry.second, nSpends * i / nChecks, nSpends * (i + 1) / nChecks,
+                std::get<3>(entry.first));
+        }
+    }
+
+    sigmaTxInfo->spendBatches.clear();
+}
+
+bool CheckSigmaSpendBatches(CValidationState &state, CSigmaTxInfo *sigmaTxInfo) {
+    std::vector<CSigmaSpendCheck> vChecks;
+    GetSigmaSpendChecks(sigmaTxInfo, vChecks, 1);
+
+    for (auto& check : vChecks) {
+        if (!check())
+            return state.DoS(100, false, REJECT_INVALID, "bad-txns-zerocoin");
+    }
+    return true;
+}
+
 // Will return false for V1, V1.5 and V2 spends.
 // Mixing V2 and sigma spends into the same transaction will fail.
 bool CheckSigmaSpendTransaction(
@@ -215,7 +331,6 @@ bool CheckSigmaSpendTransaction(
                     "CheckSigmaSpendTransaction: Error: no coins were minted with such parameters");
 
         bool passVerify = false;
-        CBlockIndex *index = coinGroup.lastBlock;
         pair<sigma::CoinDenomination, int> denominationAndId = std::make_pair(
             targetDenominations[vinIndex], pubcoinId);
 
@@ -227,24 +342,6 @@ bool CheckSigmaSpendTransaction(
             accumulatorBlockHash,
             txHashForMetadata);
 
-        // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
-        while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
-            index = index->pprev;
-
-        // Build a vector with all the public coins with given denomination and accumulator id before
-        // the block on which the spend occured.
-        // This list of public coins is required by function "Verify" of CoinSpend.
-        std::vector<sigma::PublicCoin> anonymity_set;
-        while(true) {
-            BOOST_FOREACH(const sigma::PublicCoin& pubCoinValue,
-                    index->sigmaMintedPubCoins[denominationAndId]) {
-                anonymity_set.push_back(pubCoinValue);
-            }
-            if (index == coinGroup.firstBlock)
-                break;
-            index = index->pprev;
-        }
-
         bool fPadding = spend->getVersion() >= ZEROCOIN_TX_VERSION_3_1;
         if (!isVerifyDB) {
             auto params = ::Params().GetConsensus();
@@ -257,7 +354,45 @@ bool CheckSigmaSpendTransaction(
                 return state.DoS(1, error("Incorrect sigma spend transaction version"));
         }
 
-        passVerify = spend->Verify(anonymity_set, newMetaData, fPadding);
+        // Spends already verified with the same anonymity set, e.g. when accepted to the mempool, are not
+        // verified again. The stateful serial checks below still run for them.
+        uint256 cacheEntry;
+        GetSigmaProofCache().ComputeEntry(cacheEntry, txin.scriptSig, newMetaData, denominationAndId.first,
+            sigmaState.GetAnonymitySetHash(denominationAndId.first, denominationAndId.second, accumulatorBlockHash),
+            fPadding);
+
+        // When the whole block is being checked proofs are only collected here, spends referring to the
+        // same anonymity set are verified together once all the transactions are seen (see GetSigmaSpendChecks).
+        CSigmaSpendBatch *batch = NULL;
+        if (GetSigmaProofCache().Get(cacheEntry)) {
+            passVerify = true;
+        }
+        else if (sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete) {
+            std::shared_ptr<CSigmaSpendBatch> &batchPtr = sigmaTxInfo->spendBatches[std::make_tuple(
+                denominationAndId.first, denominationAndId.second, accumulatorBlockHash, fPadding)];
+            if (!batchPtr)
+                batchPtr = std::make_shared<CSigmaSpendBatch>();
+            batch = batchPtr.get();
+            if (batch->anonymitySet.empty()) {
+                uint256 blockHash;
+                sigmaState.GetAnonymitySet(denominationAndId.first, denominationAndId.second,
+                    accumulatorBlockHash, blockHash, batch->anonymitySet);
+            }
+            passVerify = true;
+        }
+        else {
+            uint256 blockHash;
+            secp_primitives::AffineGroupElements anonymity_set;
+            sigmaState.GetAnonymitySet(denominationAndId.first, denominationAndId.second,
+                accumulatorBlockHash, blockHash, anonymity_set);
+            // a batch of one is as strict as CoinSpend::Verify and works on the normalized set directly
+            passVerify = sigma::CoinSpend::BatchVerify(anonymity_set,
+                std::vector<const sigma::CoinSpend*>(1, spend.get()),
+                std::vector<sigma::SpendMetaData>(1, newMetaData), fPadding);
+            if (passVerify)
+                GetSigmaProofCache().Set(cacheEntry);
+        }
+
         if (passVerify) {
             Scalar serial = spend->getCoinSerialNumber();
             // do not check for duplicates in case we've seen exact copy of this tx in this block before
@@ -282,6 +417,12 @@ bool CheckSigmaSpendTransaction(
                                 serial, (int)spend->getDenomination()));
                 }
             }
+
+            if (batch) {
+                batch->spends.emplace_back(std::move(spend));
+                batch->metadata.push_back(newMetaData);
+                batch->cacheEntries.push_back(cacheEntry);
+            }
         }
         else {
             LogPrintf("CheckSigmaSpendTransaction: verification failed at block %d\n", nHeight);
@@ -517,15 +658,12 @@ bool ConnectBlockSigma(
         bool fJustCheck) {
     // Add zerocoin transaction information to index
     if (pblock && pblock->sigmaTxInfo) {
-        if (!fJustCheck) {
-            pindexNew->sigmaMintedPubCoins.clear();
-            pindexNew->sigmaSpentSerials.clear();
-        }
-
         if (!CheckSigmaBlock(state, *pblock)) {
             return false;
         }
 
+        CSigmaBlockIndex sigmaIndex;
+
         BOOST_FOREACH(auto& serial, pblock->sigmaTxInfo->spentSerials) {
             if (!CheckSigmaSpendSerial(
                     state,
@@ -538,7 +676,7 @@ bool ConnectBlockSigma(
             }
 
             if (!fJustCheck) {
-                pindexNew->sigmaSpentSerials.insert(serial.first);
+                sigmaIndex.spentSerials.push_back(serial.first);
                 sigmaState.AddSpend(serial.first);
             }
         }
@@ -546,15 +684,34 @@ bool ConnectBlockSigma(
         if (fJustCheck)
             return true;
 
-        // Update pindexNew.sigmaMintedPubCoins
+        // Update sigma index of the block
         BOOST_FOREACH(const sigma::PublicCoin& mint, pblock->sigmaTxInfo->mints) {
             sigma::CoinDenomination denomination = mint.getDenomination();
-            int mintId = sigmaState.AddMint(pindexNew,	mint);
+            int mintId = sigmaState.AssignMint(pindexNew, mint);
 
             LogPrintf("ConnectTipZC: mint added denomination=%d, id=%d\n", denomination, mintId);
             pair<sigma::CoinDenomination, int> denomAndId = make_pair(denomination, mintId);
-            pindexNew->sigmaMintedPubCoins[denomAndId].push_back(mint);
+            sigmaIndex.mintedPubCoins[denomAndId].push_back(mint);
+        }
+
+        // Add coins of every group at once so they are normalized with a single field inversion
+        BOOST_FOREACH(
+            const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int), vector<sigma::PublicCoin>) &pubCoins,
+                sigmaIndex.mintedPubCoins) {
+            std::vector<GroupElement> values;
+            values.reserve(pubCoins.second.size());
+            for (const sigma::PublicCoin &coin : pubCoins.second)
+                values.push_back(coin.getValue());
+            sigmaState.AddCoins(pindexNew, pubCoins.first, values.data(), values.size());
         }
+
+        if (!sigmaIndex.IsNull()) {
+            sigmaBlockIndexHashes.insert(pindexNew->GetBlockHash());
+            unsavedSigmaBlockIndexes[pindexNew] = sigmaIndex;
+        }
+
+        if (!pblock->sigmaTxInfo->mints.empty())
+            sigmaState.AddMintOutPoints(*pblock);
     }
     else if (!fJustCheck) { // TODO(martun): not sure if this else is necessary here. Check again later.
         sigmaState.AddBlock(pindexNew);
@@ -589,9 +746,25 @@ bool GetOutPointFromBlock(COutPoint& outPoint, const GroupElement &pubCoinValue,
     return false;
 }
 
+// Reads the block at mintHeight, remembering the outpoints of all its mints for later lookups
+static bool ReadOutPointFromBlock(COutPoint& outPoint, const GroupElement &pubCoinValue, int mintHeight) {
+    CBlockIndex *mintBlock = chainActive[mintHeight];
+    CBlock block;
+    if(!ReadBlockFromDisk(block, mintBlock, ::Params().GetConsensus())) {
+        LogPrintf("can't read block from disk.\n");
+        return false;
+    }
+
+    sigmaState.AddMintOutPoints(block);
+    return GetOutPointFromBlock(outPoint, pubCoinValue, block);
+}
+
 bool GetOutPoint(COutPoint& outPoint, const sigma::PublicCoin &pubCoin) {
 
     sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    if (sigmaState->GetMintOutPoint(pubCoin.value, outPoint))
+        return true;
+
     auto mintedCoinHeightAndId = sigmaState->GetMintedCoinHeightAndId(pubCoin);
     int mintHeight = mintedCoinHeightAndId.first;
     int coinId = mintedCoinHeightAndId.second;
@@ -599,13 +772,7 @@ bool GetOutPoint(COutPoint& outPoint, const sigma::PublicCoin &pubCoin) {
     if(mintHeight==-1 && coinId==-1)
         return false;
 
-    // get block containing mint
-    CBlockIndex *mintBlock = chainActive[mintHeight];
-    CBlock block;
-    if(!ReadBlockFromDisk(block, mintBlock, ::Params().GetConsensus()))
-        LogPrintf("can't read block from disk.\n");
-
-    return GetOutPointFromBlock(outPoint, pubCoin.value, block);
+    return ReadOutPointFromBlock(outPoint, pubCoin.value, mintHeight);
 }
 
 bool GetOutPoint(COutPoint& outPoint, const GroupElement &pubCoinValue) {
@@ -613,6 +780,9 @@ bool GetOutPoint(COutPoint& outPoint, const GroupElement &pubCoinValue) {
     int coinId = 0;
 
     sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    if (sigmaState->GetMintOutPoint(pubCoinValue, outPoint))
+        return true;
+
     std::vector<sigma::CoinDenomination> denominations;
     GetAllDenoms(denominations);
     BOOST_FOREACH(sigma::CoinDenomination denomination, denominations){
@@ -625,13 +795,8 @@ bool GetOutPoint(COutPoint& outPoint, const GroupElement &pubCoinValue) {
     }
     if(mintHeight==-1 && coinId==-1)
         return false;
-    // get block containing mint
-    CBlockIndex *mintBlock = chainActive[mintHeight];
-    CBlock block;
-    if(!ReadBlockFromDisk(block, mintBlock, ::Params().GetConsensus()))
-        LogPrintf("can't read block from disk.\n");
 
-    return GetOutPointFromBlock(outPoint, pubCoinValue, block);
+    return ReadOutPointFromBlock(outPoint, pubCoinValue, mintHeight);
 }
 
 bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash) {
@@ -643,9 +808,60 @@ bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash) {
 
     return GetOutPoint(outPoint, pubCoinValue);
 }
+static const char *SIGMA_STATE_SNAPSHOT_FILENAME = "sigmastate.dat";
+static const int SIGMA_STATE_SNAPSHOT_VERSION = 3;
+
+bool WriteSigmaStateSnapshot(CChain *chain) {
+    if (chain->Tip() == NULL)
+        return false;
+
+    CDataStream ssState(SER_DISK, CLIENT_VERSION);
+    sigmaState.WriteSnapshot(ssState);
+    return WriteStateSnapshot(SIGMA_STATE_SNAPSHOT_FILENAME, SIGMA_STATE_SNAPSHOT_VERSION, chain->Tip()->GetBlockHash(), ssState);
+}
+
+// Loads the latest snapshot of the state if it was taken at a block of the chain. Returns that block
+static CBlockIndex *ReadSigmaStateSnapshot(CChain *chain) {
+    uint256 blockHash;
+    CDataStream ssState(SER_DISK, CLIENT_VERSION);
+    if (!ReadStateSnapshot(SIGMA_STATE_SNAPSHOT_FILENAME, SIGMA_STATE_SNAPSHOT_VERSION, blockHash, ssState))
+        return NULL;
+
+    BlockMap::iterator mi = mapBlockIndex.find(blockHash);
+    if (mi == mapBlockIndex.end() || !chain->Contains(mi->second)) {
+        LogPrintf("BuildSigmaStateFromIndex: snapshot block %s is not in the chain\n", blockHash.ToString());
+        return NULL;
+    }
+
+    try {
+        if (sigmaState.ReadSnapshot(ssState, chain))
+            return mi->second;
+    }
+    catch (const std::exception &e) {
+        LogPrintf("BuildSigmaStateFromIndex: failed to read snapshot - %s\n", e.what());
+    }
+    sigmaState.Reset();
+    return NULL;
+}
+
 bool BuildSigmaStateFromIndex(CChain *chain) {
     sigmaState.Reset();
-    for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
+
+    sigmaBlockIndexHashes.clear();
+    fSigmaBlockIndexHashesLoaded = pblocktree != NULL && pblocktree->ReadSigmaBlockIndexHashes(sigmaBlockIndexHashes);
+    if (!fSigmaBlockIndexHashesLoaded)
+        sigmaBlockIndexHashes.clear();
+
+    CBlockIndex *blockIndex = ReadSigmaStateSnapshot(chain);
+    if (blockIndex) {
+        LogPrintf("BuildSigmaStateFromIndex: loaded snapshot at height %d\n", blockIndex->nHeight);
+        blockIndex = chain->Next(blockIndex);
+    }
+    else {
+        blockIndex = chain->Genesis();
+    }
+
+    for (; blockIndex; blockIndex=chain->Next(blockIndex))
     {
         sigmaState.AddBlock(blockIndex);
     }
@@ -690,6 +906,15 @@ CSigmaState::CSigmaState() {
 int CSigmaState::AddMint(
         CBlockIndex *index,
         const sigma::PublicCoin &pubCoin) {
+    int mintCoinGroupId = AssignMint(index, pubCoin);
+    sigma::CoinDenomination denomination = pubCoin.getDenomination();
+    AddCoins(index, std::make_pair(denomination, mintCoinGroupId), &pubCoin.getValue(), 1);
+    return mintCoinGroupId;
+}
+
+int CSigmaState::AssignMint(
+        CBlockIndex *index,
+        const sigma::PublicCoin &pubCoin) {
     sigma::CoinDenomination denomination = pubCoin.getDenomination();
 
     if (latestCoinIds[denomination] < 1)
@@ -731,17 +956,64 @@ int CSigmaState::AddMint(
     coinInfo.id = mintCoinGroupId;
     coinInfo.nHeight = index->nHeight;
     mintedPubCoins.insert(std::make_pair(pubCoin, coinInfo));
+
     return mintCoinGroupId;
 }
 
+void CSigmaState::AddCoins(
+        CBlockIndex *index,
+        const std::pair<sigma::CoinDenomination, int> &denominationAndId,
+        const GroupElement *values,
+        std::size_t n) {
+    SigmaCoinGroupCoins &groupCoins = coinGroupCoins[denominationAndId];
+    groupCoins.coins.append(values, n);
+    if (groupCoins.blocks.empty() || groupCoins.blocks.back().first != index)
+        groupCoins.blocks.push_back(std::make_pair(index, groupCoins.coins.size()));
+    else
+        groupCoins.blocks.back().second = groupCoins.coins.size();
+}
+
 void CSigmaState::AddSpend(const Scalar &serial) {
     usedCoinSerials.insert(serial);
 }
 
+// Reads sigma entries of the block, not yet flushed or from the block tree database. Returns false if the block has none
+static bool ReadSigmaBlockIndex(const CBlockIndex *index, CSigmaBlockIndex &sigmaIndex) {
+    if (index->nHeight < ::Params().GetConsensus().nSigmaStartBlock)
+        return false;
+
+    std::map<const CBlockIndex *, CSigmaBlockIndex>::const_iterator it = unsavedSigmaBlockIndexes.find(index);
+    if (it != unsavedSigmaBlockIndexes.end()) {
+        sigmaIndex = it->second;
+        return true;
+    }
+
+    if (pblocktree == NULL || (fSigmaBlockIndexHashesLoaded && sigmaBlockIndexHashes.count(index->GetBlockHash()) == 0))
+        return false;
+    return pblocktree->ReadSigmaBlockIndex(index->GetBlockHash(), sigmaIndex);
+}
+
+void GetUnsavedSigmaBlockIndexes(std::vector<std::pair<const CBlockIndex *, const CSigmaBlockIndex *> > &vSigmaBlocks) {
+    vSigmaBlocks.reserve(unsavedSigmaBlockIndexes.size());
+    for (std::map<const CBlockIndex *, CSigmaBlockIndex>::const_iterator it = unsavedSigmaBlockIndexes.begin();
+            it != unsavedSigmaBlockIndexes.end(); it++)
+        vSigmaBlocks.push_back(make_pair(it->first, &it->second));
+}
+
+void ClearUnsavedSigmaBlockIndexes() {
+    unsavedSigmaBlockIndexes.clear();
+}
+
 void CSigmaState::AddBlock(CBlockIndex *index) {
+    CSigmaBlockIndex sigmaIndex;
+    if (ReadSigmaBlockIndex(index, sigmaIndex))
+        AddBlock(index, sigmaIndex);
+}
+
+void CSigmaState::AddBlock(CBlockIndex *index, const CSigmaBlockIndex &sigmaIndex) {
     BOOST_FOREACH(
         const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int), vector<sigma::PublicCoin>) &pubCoins,
-            index->sigmaMintedPubCoins) {
+            sigmaIndex.mintedPubCoins) {
         if (!pubCoins.second.empty()) {
             SigmaCoinGroupInfo& coinGroup = coinGroups[pubCoins.first];
 
@@ -749,6 +1021,13 @@ void CSigmaState::AddBlock(CBlockIndex *index) {
                 coinGroup.firstBlock = index;
             coinGroup.lastBlock = index;
             coinGroup.nCoins += pubCoins.second.size();
+
+            // normalize coins of the block with a single field inversion
+            std::vector<GroupElement> values;
+            values.reserve(pubCoins.second.size());
+            for (const sigma::PublicCoin &coin : pubCoins.second)
+                values.push_back(coin.getValue());
+            AddCoins(index, pubCoins.first, values.data(), values.size());
         }
 
         latestCoinIds[pubCoins.first.first] = pubCoins.first.second;
@@ -761,42 +1040,56 @@ void CSigmaState::AddBlock(CBlockIndex *index) {
         }
     }
 
-    BOOST_FOREACH(const Scalar &serial, index->sigmaSpentSerials) {
+    BOOST_FOREACH(const Scalar &serial, sigmaIndex.spentSerials) {
         usedCoinSerials.insert(serial);
     }
 }
 
 void CSigmaState::RemoveBlock(CBlockIndex *index) {
-    // roll back accumulator updates
+    CSigmaBlockIndex sigmaIndex;
+    if (ReadSigmaBlockIndex(index, sigmaIndex))
+        RemoveBlock(index, sigmaIndex);
+}
+
+void CSigmaState::RemoveBlock(CBlockIndex *index, const CSigmaBlockIndex &sigmaIndex) {
+    // roll back accumulator updates and cached coins of the groups
     BOOST_FOREACH(
         const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &coin,
-        index->sigmaMintedPubCoins)
+        sigmaIndex.mintedPubCoins)
     {
+        if (coin.second.empty())
+            continue;
+
         SigmaCoinGroupInfo   &coinGroup = coinGroups[coin.first];
         int  nMintsToForget = coin.second.size();
 
         assert(coinGroup.nCoins >= nMintsToForget);
 
+        auto groupCoins = coinGroupCoins.find(coin.first);
+        assert(groupCoins != coinGroupCoins.end());
+        assert(groupCoins->second.blocks.back().first == index);
+        groupCoins->second.blocks.pop_back();
+
         if ((coinGroup.nCoins -= nMintsToForget) == 0) {
             // all the coins of this group have been erased, remove the group altogether
             coinGroups.erase(coin.first);
+            coinGroupCoins.erase(groupCoins);
             // decrease pubcoin id for this denomination
             latestCoinIds[coin.first.first]--;
         }
         else {
-            // roll back lastBlock to previous position
+            // roll back lastBlock to the previous block having coins of the group
             assert(coinGroup.lastBlock == index);
+            assert(!groupCoins->second.blocks.empty());
 
-            do {
-                assert(coinGroup.lastBlock != coinGroup.firstBlock);
-                coinGroup.lastBlock = coinGroup.lastBlock->pprev;
-            } while (coinGroup.lastBlock->sigmaMintedPubCoins.count(coin.first) == 0);
+            coinGroup.lastBlock = groupCoins->second.blocks.back().first;
+            groupCoins->second.coins.resize(groupCoins->second.blocks.back().second);
         }
     }
 
     // roll back mints
     BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &pubCoins,
-                  index->sigmaMintedPubCoins) {
+                  sigmaIndex.mintedPubCoins) {
         BOOST_FOREACH(const sigma::PublicCoin &coin, pubCoins.second) {
             auto coins = mintedPubCoins.equal_range(coin);
             auto coinIt = find_if(
@@ -810,14 +1103,90 @@ void CSigmaState::RemoveBlock(CBlockIndex *index) {
         }
     }
 
-    index->sigmaMintedPubCoins.clear();
-
     // roll back spends
-    BOOST_FOREACH(const Scalar &serial, index->sigmaSpentSerials) {
+    BOOST_FOREACH(const Scalar &serial, sigmaIndex.spentSerials) {
         usedCoinSerials.erase(serial);
     }
 
-    index->sigmaSpentSerials.clear();
+    // forget outpoints of the mints
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &pubCoins,
+                  sigmaIndex.mintedPubCoins) {
+        BOOST_FOREACH(const sigma::PublicCoin &coin, pubCoins.second) {
+            mintOutPoints.erase(coin.getValue());
+        }
+    }
+}
+
+void CSigmaState::WriteSnapshot(CDataStream &stream) const {
+    stream << (uint32_t)coinGroupCoins.size();
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int), SigmaCoinGroupCoins) &group, coinGroupCoins) {
+        stream << group.first;
+
+        std::vector<std::pair<uint256, uint64_t>> blocks;
+        blocks.reserve(group.second.blocks.size());
+        BOOST_FOREACH(const PAIRTYPE(CBlockIndex *, std::size_t) &block, group.second.blocks)
+            blocks.push_back(std::make_pair(block.first->GetBlockHash(), (uint64_t)block.second));
+        stream << blocks;
+
+        // coins are stored with both affine coordinates, loading only checks they are on the curve
+        stream << group.second.coins.serialize();
+    }
+
+    std::vector<std::pair<sigma::CoinDenomination, int>> ids(latestCoinIds.begin(), latestCoinIds.end());
+    stream << ids;
+
+    std::vector<Scalar> serials(usedCoinSerials.begin(), usedCoinSerials.end());
+    stream << serials;
+}
+
+bool CSigmaState::ReadSnapshot(CDataStream &stream, CChain *chain) {
+    uint32_t nGroups;
+    stream >> nGroups;
+    for (uint32_t i = 0; i < nGroups; i++) {
+        std::pair<sigma::CoinDenomination, int> key;
+        stream >> key;
+
+        std::vector<std::pair<uint256, uint64_t>> blocks;
+        stream >> blocks;
+        std::vector<unsigned char> coins;
+        stream >> coins;
+
+        SigmaCoinGroupCoins &groupCoins = coinGroupCoins[key];
+        groupCoins.coins.append_serialized(coins);
+        if (blocks.empty() || blocks.back().second != groupCoins.coins.size())
+            return false;
+
+        std::size_t nFirstCoin = 0;
+        BOOST_FOREACH(const PAIRTYPE(uint256, uint64_t) &block, blocks) {
+            BlockMap::iterator mi = mapBlockIndex.find(block.first);
+            if (mi == mapBlockIndex.end() || !chain->Contains(mi->second) || block.second < nFirstCoin)
+                return false;
+            groupCoins.blocks.push_back(std::make_pair(mi->second, (std::size_t)block.second));
+
+            CMintedCoinInfo coinInfo;
+            coinInfo.denomination = key.first;
+            coinInfo.id = key.second;
+            coinInfo.nHeight = mi->second->nHeight;
+            for (std::size_t j = nFirstCoin; j < block.second; j++)
+                mintedPubCoins.insert(std::make_pair(sigma::PublicCoin(groupCoins.coins.get(j), key.first), coinInfo));
+            nFirstCoin = block.second;
+        }
+
+        SigmaCoinGroupInfo &coinGroup = coinGroups[key];
+        coinGroup.firstBlock = groupCoins.blocks.front().first;
+        coinGroup.lastBlock = groupCoins.blocks.back().first;
+        coinGroup.nCoins = groupCoins.coins.size();
+    }
+
+    std::vector<std::pair<sigma::CoinDenomination, int>> ids;
+    stream >> ids;
+    latestCoinIds.insert(ids.begin(), ids.end());
+
+    std::vector<Scalar> serials;
+    stream >> serials;
+    usedCoinSerials.insert(serials.begin(), serials.end());
+
+    return true;
 }
 
 bool CSigmaState::GetCoinGroupInfo(
@@ -860,35 +1229,110 @@ int CSigmaState::GetCoinSetForSpend(
         uint256& blockHash_out,
         std::vector<sigma::PublicCoin>& coins_out) {
 
-    pair<sigma::CoinDenomination, int> denomAndId = std::make_pair(denomination, coinGroupID);
+    auto groupCoins = coinGroupCoins.find(std::make_pair(denomination, coinGroupID));
+    if (groupCoins == coinGroupCoins.end())
+        return 0;
+
+    const SigmaCoinGroupCoins &group = groupCoins->second;
 
-    if (coinGroups.count(denomAndId) == 0)
+    // find latest block satisfying given conditions
+    std::size_t last = CountBlocksUpToHeight(group, maxHeight);
+    if (last == 0)
         return 0;
+    last--;
 
-    SigmaCoinGroupInfo coinGroup = coinGroups[denomAndId];
-
-    int numberOfCoins = 0;
-    for (CBlockIndex *block = coinGroup.lastBlock;
-            ;
-            block = block->pprev) {
-        if (block->sigmaMintedPubCoins[denomAndId].size() > 0) {
-            if (block->nHeight <= maxHeight) {
-                if (numberOfCoins == 0) {
-                    // latest block satisfying given conditions
-                    // remember block hash
-                    blockHash_out = block->GetBlockHash();
-                }
-                numberOfCoins += block->sigmaMintedPubCoins[denomAndId].size();
-                coins_out.insert(coins_out.end(),
-                        block->sigmaMintedPubCoins[denomAndId].begin(),
-                        block->sigmaMintedPubCoins[denomAndId].end());
-            }
-        }
-        if (block == coinGroup.firstBlock) {
-            break ;
-        }
+    blockHash_out = group.blocks[last].first->GetBlockHash();
+
+    coins_out.reserve(coins_out.size() + group.blocks[last].second);
+    for (std::size_t i = last + 1; i-- > 0; ) {
+        std::size_t begin = i == 0 ? 0 : group.blocks[i - 1].second;
+        for (std::size_t j = begin; j < group.blocks[i].second; ++j)
+            coins_out.push_back(sigma::PublicCoin(group.coins.get(j), denomination));
+    }
+    return group.blocks[last].second;
+}
+
+int CSigmaState::GetCoinSetSizeForSpend(
+        int maxHeight,
+        sigma::CoinDenomination denomination,
+        int coinGroupID) const {
+
+    auto groupCoins = coinGroupCoins.find(std::make_pair(denomination, coinGroupID));
+    if (groupCoins == coinGroupCoins.end())
+        return 0;
+
+    // every block of the group comes with the size of the group at the end of it
+    std::size_t count = CountBlocksUpToHeight(groupCoins->second, maxHeight);
+    return count == 0 ? 0 : groupCoins->second.blocks[count - 1].second;
+}
+
+std::size_t CSigmaState::CountBlocksUpToHeight(const SigmaCoinGroupCoins &group, int maxHeight) const {
+    // usually only the latest few blocks are too high, so walk back from the end
+    std::size_t count = group.blocks.size();
+    while (count > 0 && group.blocks[count - 1].first->nHeight > maxHeight)
+        count--;
+    return count;
+}
+
+int CSigmaState::GetAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int coinGroupID,
+        const uint256& accumulatorBlockHash,
+        uint256& blockHash_out,
+        secp_primitives::AffineGroupElements& coins_out) {
+
+    auto groupCoins = coinGroupCoins.find(std::make_pair(denomination, coinGroupID));
+    if (groupCoins == coinGroupCoins.end())
+        return 0;
+
+    const SigmaCoinGroupCoins &group = groupCoins->second;
+    std::size_t last = FindAnonymitySetBlock(group, accumulatorBlockHash);
+
+    blockHash_out = group.blocks[last].first->GetBlockHash();
+
+    // Coins are stored in the order of the chain, while the anonymity set starts with the latest block
+    coins_out.reserve(coins_out.size() + group.blocks[last].second);
+    for (std::size_t i = last + 1; i-- > 0; ) {
+        std::size_t begin = i == 0 ? 0 : group.blocks[i - 1].second;
+        coins_out.append(group.coins, begin, group.blocks[i].second);
     }
-    return numberOfCoins;
+    return group.blocks[last].second;
+}
+
+uint256 CSigmaState::GetAnonymitySetHash(
+        sigma::CoinDenomination denomination,
+        int coinGroupID,
+        const uint256& accumulatorBlockHash) {
+
+    auto groupCoins = coinGroupCoins.find(std::make_pair(denomination, coinGroupID));
+    if (groupCoins == coinGroupCoins.end())
+        return uint256();
+
+    const SigmaCoinGroupCoins &group = groupCoins->second;
+    return group.blocks[FindAnonymitySetBlock(group, accumulatorBlockHash)].first->GetBlockHash();
+}
+
+std::size_t CSigmaState::FindAnonymitySetBlock(
+        const SigmaCoinGroupCoins &group,
+        const uint256& accumulatorBlockHash) const {
+    // Spends normally refer to the latest block with coins of the group they have seen
+    std::size_t last = group.blocks.size();
+    while (last > 0 && group.blocks[last - 1].first->GetBlockHash() != accumulatorBlockHash)
+        last--;
+
+    if (last == 0) {
+        // The block may have no coins of this group at all. Find it in the chain and take
+        // all the coins up to it, use first block of the group if it's not there.
+        CBlockIndex *index = group.blocks.back().first;
+        CBlockIndex *firstBlock = group.blocks.front().first;
+        while (index != firstBlock && index->GetBlockHash() != accumulatorBlockHash)
+            index = index->pprev;
+
+        last = group.blocks.size();
+        while (last > 1 && group.blocks[last - 1].first->nHeight > index->nHeight)
+            last--;
+    }
+    return last - 1;
 }
 
 std::pair<int, int> CSigmaState::GetMintedCoinHeightAndId(
@@ -937,12 +1381,36 @@ bool CSigmaState::CanAddSpendToMempool(const Scalar& coinSerial) {
 
 void CSigmaState::Reset() {
     coinGroups.clear();
+    coinGroupCoins.clear();
     usedCoinSerials.clear();
     latestCoinIds.clear();
     mintedPubCoins.clear();
+    mintOutPoints.clear();
     mempoolCoinSerials.clear();
 }
 
+void CSigmaState::AddMintOutPoints(const CBlock &block) {
+    BOOST_FOREACH(const CTransaction &tx, block.vtx) {
+        if (!tx.IsSigmaMint())
+            continue;
+
+        for (uint32_t i = 0; i < tx.vout.size(); i++) {
+            const CScript &script = tx.vout[i].scriptPubKey;
+            if (script.IsSigmaMint())
+                mintOutPoints[ParseSigmaMintScript(script)] = COutPoint(tx.GetHash(), i);
+        }
+    }
+}
+
+bool CSigmaState::GetMintOutPoint(const GroupElement &pubCoinValue, COutPoint &outPoint) const {
+    auto it = mintOutPoints.find(pubCoinValue);
+    if (it == mintOutPoints.end())
+        return false;
+
+    outPoint = it->second;
+    return true;
+}
+
 CSigmaState* CSigmaState::GetState() {
     return &sigmaState;
 }
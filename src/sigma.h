@@ -12,13 +12,99 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
 #include "hash_functions.h"
 
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/unordered_set.hpp>
+
 namespace sigma {
 
+// DoS prevention: limit sigma proof cache size to less than 8MB
+static const unsigned int DEFAULT_MAX_SIGMA_PROOF_CACHE_SIZE = 8;
+
 // zerocoin parameters
 extern Params *SigmaParams;
 
+class CSigmaProofCacheHasher
+{
+public:
+    size_t operator()(const uint256& key) const {
+        return key.GetCheapHash();
+    }
+};
+
+/**
+ * Valid sigma proof cache, to avoid verifying a spend twice (once when accepted into
+ * memory pool, and again when the block containing it is checked and connected).
+ * An entry commits to everything the verification depends on: the serialized spend
+ * with its proof and signature, the metadata and the anonymity set, which is identified
+ * by its coin group and the latest block contributing to it.
+ */
+class CSigmaProofCache
+{
+private:
+    //! Entries are SHA256(nonce || serialized spend || metadata || denomination || anonymity set block || padding)
+    uint256 nonce;
+    typedef boost::unordered_set<uint256, CSigmaProofCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CSigmaProofCache();
+
+    void ComputeEntry(
+            uint256& entry,
+            const CScript& spendScript,
+            const SpendMetaData& metadata,
+            CoinDenomination denomination,
+            const uint256& anonymitySetHash,
+            bool fPadding);
+
+    bool Get(const uint256& entry);
+
+    void Set(const uint256& entry);
+};
+
+CSigmaProofCache& GetSigmaProofCache();
+
+// Sigma spends of the block referring to the same anonymity set. Proofs of such spends are
+// verified together, this is much cheaper than verifying them one by one.
+class CSigmaSpendBatch {
+public:
+    secp_primitives::AffineGroupElements anonymitySet;
+    std::vector<std::shared_ptr<sigma::CoinSpend>> spends;
+    std::vector<sigma::SpendMetaData> metadata;
+    // Proof cache entries of the spends, stored once the batch is verified
+    std::vector<uint256> cacheEntries;
+};
+
+// Closure representing verification of a part of CSigmaSpendBatch. It doesn't depend on any chain state
+// so it can be run by the check queue workers.
+class CSigmaSpendCheck {
+private:
+    std::shared_ptr<const CSigmaSpendBatch> batch;
+    std::size_t nBegin;
+    std::size_t nEnd;
+    bool fPadding;
+
+public:
+    CSigmaSpendCheck(): nBegin(0), nEnd(0), fPadding(false) {}
+    CSigmaSpendCheck(const std::shared_ptr<const CSigmaSpendBatch> &batchIn, std::size_t nBeginIn, std::size_t nEndIn, bool fPaddingIn) :
+        batch(batchIn), nBegin(nBeginIn), nEnd(nEndIn), fPadding(fPaddingIn) {}
+
+    bool operator()();
+
+    void swap(CSigmaSpendCheck &check) {
+        batch.swap(check.batch);
+        std::swap(nBegin, check.nBegin);
+        std::swap(nEnd, check.nEnd);
+        std::swap(fPadding, check.fPadding);
+    }
+};
+
 // Zerocoin transaction info, added to the CBlock to ensure zerocoin mint/spend transactions got their info stored into
 // index
 class CSigmaTxInfo {
@@ -32,6 +118,10 @@ public:
     // serial for every spend (map from serial to denomination)
     std::unordered_map<Scalar, int, sigma::CScalarHash> spentSerials;
 
+    // spends waiting for verification, keyed by denomination, coin group id, accumulator block hash
+    // and padding flag
+    std::map<std::tuple<sigma::CoinDenomination, int, uint256, bool>, std::shared_ptr<CSigmaSpendBatch>> spendBatches;
+
     // information about transactions in the block is complete
     bool fInfoIsComplete;
 
@@ -59,6 +149,13 @@ bool CheckSigmaTransaction(
   bool isCheckWallet,
   CSigmaTxInfo *zerocoinTxInfo);
 
+// Move spends collected in sigmaTxInfo by CheckSigmaTransaction into checks, every anonymity set
+// is split into at most nChecksPerBatch checks
+void GetSigmaSpendChecks(CSigmaTxInfo *sigmaTxInfo, std::vector<CSigmaSpendCheck> &vChecks, unsigned int nChecksPerBatch);
+
+// Verify all the spends collected in sigmaTxInfo by CheckSigmaTransaction in the current thread
+bool CheckSigmaSpendBatches(CValidationState &state, CSigmaTxInfo *sigmaTxInfo);
+
 void DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete);
 
 bool ConnectBlockSigma(
@@ -78,8 +175,17 @@ bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash);
 
 uint256 GetPubCoinValueHash(const secp_primitives::GroupElement& bnValue);
 
+// Builds the state from the latest snapshot, if any, and the blocks of the chain after it
 bool BuildSigmaStateFromIndex(CChain *chain);
 
+// Writes a snapshot of the state at the tip of the chain
+bool WriteSigmaStateSnapshot(CChain *chain);
+
+// Sigma records of blocks connected since the last flush, they are written by FlushStateToDisk in the
+// same batch as the block index
+void GetUnsavedSigmaBlockIndexes(std::vector<std::pair<const CBlockIndex *, const CSigmaBlockIndex *> > &vSigmaBlocks);
+void ClearUnsavedSigmaBlockIndexes();
+
 Scalar GetSigmaSpendSerialNumber(const CTransaction &tx, const CTxIn &txin);
 CAmount GetSigmaSpendInput(const CTransaction &tx);
 
@@ -100,6 +206,14 @@ public:
         int nCoins;
     };
 
+    // Values of all the coins of a group in the order they were added to the chain. They are kept
+    // normalized, so anonymity sets can be fed to the multi-exponentiation as is.
+    struct SigmaCoinGroupCoins {
+        secp_primitives::AffineGroupElements coins;
+        // Every block having coins of the group along with the number of coins in the group at the end of it
+        std::vector<std::pair<CBlockIndex *, std::size_t>> blocks;
+    };
+
     struct CMintedCoinInfo {
         sigma::CoinDenomination denomination;
 
@@ -124,14 +238,29 @@ public:
         CBlockIndex *index,
         const sigma::PublicCoin& pubCoin);
 
+    // Assign mint to a coin group like AddMint does, without adding its value to the group coins.
+    // AddCoins must be called for the mint afterwards. Returns id of the coin group
+    int AssignMint(
+        CBlockIndex *index,
+        const sigma::PublicCoin& pubCoin);
+
+    // Append coin values of the block to the given coin group, normalizing them with a single field inversion
+    void AddCoins(
+        CBlockIndex *index,
+        const std::pair<sigma::CoinDenomination, int> &denominationAndId,
+        const GroupElement *values,
+        std::size_t n);
+
     // Add serial to the list of used ones
     void AddSpend(const Scalar& serial);
 
-    // Add everything from the block to the state
+    // Add everything from the block to the state, reading its sigma entries from the block tree database
     void AddBlock(CBlockIndex *index);
+    void AddBlock(CBlockIndex *index, const CSigmaBlockIndex &sigmaIndex);
 
     // Disconnect block from the chain rolling back mints and spends
     void RemoveBlock(CBlockIndex *index);
+    void RemoveBlock(CBlockIndex *index, const CSigmaBlockIndex &sigmaIndex);
 
     // Query coin group with given denomination and id
     bool GetCoinGroupInfo(sigma::CoinDenomination denomination,
@@ -156,12 +285,50 @@ public:
         uint256& blockHash_out,
         std::vector<sigma::PublicCoin>& coins_out);
 
+    // Returns number of coins GetCoinSetForSpend would return, without copying them
+    int GetCoinSetSizeForSpend(
+        int maxHeight,
+        sigma::CoinDenomination denomination,
+        int id) const;
+
+    // Given denomination and id returns the anonymity set for a spend referring to the block with
+    // accumulatorBlockHash, that is all the coins of the group up to this block, latest block first.
+    // If there is no such block in the group coins of its first block are returned.
+    // blockHash_out is set to the hash of the latest block contributing to the set.
+    // Returns number of coins in the set
+    int GetAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int id,
+        const uint256& accumulatorBlockHash,
+        uint256& blockHash_out,
+        secp_primitives::AffineGroupElements& coins_out);
+
+    // Returns hash of the latest block contributing to the anonymity set GetAnonymitySet would return,
+    // without building the set. Returns zero hash if there are no coins in the group.
+    uint256 GetAnonymitySetHash(
+        sigma::CoinDenomination denomination,
+        int id,
+        const uint256& accumulatorBlockHash);
+
     // Return height of mint transaction and id of minted coin
     std::pair<int, int> GetMintedCoinHeightAndId(const sigma::PublicCoin& pubCoin);
 
+    // Remember the outpoints of all the mints of the block
+    void AddMintOutPoints(const CBlock &block);
+
+    // Query the outpoint of a mint with given pubCoin value recorded by AddMintOutPoints
+    bool GetMintOutPoint(const GroupElement &pubCoinValue, COutPoint &outPoint) const;
+
     // Reset to initial values
     void Reset();
 
+    // Serialize coin groups, spent serials and latest ids, referring to blocks by hash
+    void WriteSnapshot(CDataStream &stream) const;
+
+    // Restore the state written by WriteSnapshot into an empty state. Returns false if the
+    // snapshot refers to blocks not in the chain or is inconsistent
+    bool ReadSnapshot(CDataStream &stream, CChain *chain);
+
     // Check if there is a conflicting tx in the blockchain or mempool
     bool CanAddSpendToMempool(const Scalar& coinSerial);
 
@@ -187,10 +354,17 @@ public:
     // Collection of coin groups. Map from <denomination,id> to SigmaCoinGroupInfo structure
     std::unordered_map<pair<sigma::CoinDenomination, int>, SigmaCoinGroupInfo, pairhash> coinGroups;
 
+    // Coins of every group, maintained along with coinGroups to avoid walking the chain on every spend
+    std::unordered_map<pair<sigma::CoinDenomination, int>, SigmaCoinGroupCoins, pairhash> coinGroupCoins;
+
     // Set of all minted pubCoin values, keyed by the public coin.
     // Used for checking if the given coin already exists.
     unordered_map<sigma::PublicCoin, CMintedCoinInfo, sigma::CPublicCoinHash> mintedPubCoins;
 
+    // Outpoints of the mints of connected blocks by pubCoin value. Blocks loaded from the index or a
+    // snapshot are only added when a mint of theirs is looked up by GetOutPoint.
+    std::unordered_map<GroupElement, COutPoint> mintOutPoints;
+
     // Latest IDs of coins by denomination
     std::unordered_map<sigma::CoinDenomination, int> latestCoinIds;
 
@@ -200,6 +374,12 @@ public:
     // serials of spends currently in the mempool mapped to tx hashes
     std::unordered_map<Scalar, uint256, sigma::CScalarHash> mempoolCoinSerials;
 
+private:
+    // Position in group.blocks of the latest block contributing to the anonymity set for accumulatorBlockHash
+    std::size_t FindAnonymitySetBlock(const SigmaCoinGroupCoins &group, const uint256& accumulatorBlockHash) const;
+
+    // Number of blocks in group.blocks with height not exceeding maxHeight
+    std::size_t CountBlocksUpToHeight(const SigmaCoinGroupCoins &group, int maxHeight) const;
 };
 
 } // end of namespace sigma.
@@ -236,7 +236,7 @@ void PrivateCoin::mintCoin(const CoinDenomination denomination){
 
     randomness.randomize();
     GroupElement commit = SigmaPrimitives<Scalar, GroupElement>::commit(
-            params->get_g(), serialNumber, params->get_h0(), randomness);
+            params->get_g(), serialNumber, params->get_h0(), randomness, params);
     publicCoin = PublicCoin(commit, denomination);
 }
 
@@ -9,7 +9,8 @@ CoinSpend::CoinSpend(
     const PrivateCoin& coin,
     const std::vector<sigma::PublicCoin>& anonymity_set,
     const SpendMetaData& m,
-    bool fPadding)
+    bool fPadding,
+    const ParallelForExecutor& parallel_for)
     :
     params(p),
     denomination(coin.getPublicCoin().getDenomination()),
@@ -26,7 +27,9 @@ CoinSpend::CoinSpend(
         params->get_g(),
         params->get_h(),
         params->get_n(),
-        params->get_m());
+        params->get_m(),
+        params,
+        parallel_for);
     //compute inverse of g^s
     GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
@@ -101,14 +104,62 @@ bool CoinSpend::Verify(
         const std::vector<sigma::PublicCoin>& anonymity_set,
         const SpendMetaData& m,
         bool fPadding) const {
-    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m());
+    std::vector<GroupElement> values;
+    values.reserve(anonymity_set.size());
+    for (std::size_t j = 0; j < anonymity_set.size(); ++j)
+        values.emplace_back(anonymity_set[j].getValue());
+    return Verify(values, m, fPadding);
+}
+
+bool CoinSpend::Verify(
+        const std::vector<GroupElement>& anonymity_set,
+        const SpendMetaData& m,
+        bool fPadding) const {
+    if (!VerifySignature(m))
+        return false;
+
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m(), params);
     //compute inverse of g^s
     GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
     C_.reserve(anonymity_set.size());
     for(std::size_t j = 0; j < anonymity_set.size(); ++j)
-        C_.emplace_back(anonymity_set[j].getValue() + gs);
+        C_.emplace_back(anonymity_set[j] + gs);
+
+    // Now verify the sigma proof itself.
+    return sigmaVerifier.verify(C_, sigmaProof, fPadding);
+}
+
+bool CoinSpend::BatchVerify(
+        const secp_primitives::AffineGroupElements& anonymity_set,
+        const std::vector<const CoinSpend*>& spends,
+        const std::vector<SpendMetaData>& metadata,
+        bool fPadding) {
+    if (spends.size() != metadata.size()) {
+        LogPrintf("Sigma batch verification failed due to spends and metadata count mismatch.");
+        return false;
+    }
+    if (spends.empty())
+        return true;
+
+    const Params* params = spends[0]->params;
+    std::vector<Scalar> serials;
+    std::vector<SigmaPlusProof<Scalar, GroupElement>> proofs;
+    serials.reserve(spends.size());
+    proofs.reserve(spends.size());
+    for (std::size_t i = 0; i < spends.size(); ++i) {
+        if (!spends[i]->VerifySignature(metadata[i]))
+            return false;
+        serials.emplace_back(spends[i]->coinSerialNumber);
+        proofs.emplace_back(spends[i]->sigmaProof);
+    }
+
+    // Serial numbers are applied to the anonymity set inside batch verification, so public coins are used as is.
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m(), params);
+    return sigmaVerifier.batch_verify(anonymity_set, serials, proofs, fPadding);
+}
 
+bool CoinSpend::VerifySignature(const SpendMetaData& m) const {
     uint256 metahash = signatureHash(m);
 
     // Verify ecdsa_signature, to make sure someone did not change the output of transaction.
@@ -144,8 +195,7 @@ bool CoinSpend::Verify(
         return false;
     }
 
-    // Now verify the sigma proof itself.
-    return sigmaVerifier.verify(C_, sigmaProof, fPadding);
+    return true;
 }
 
 const Scalar& CoinSpend::getCoinSerialNumber() {
@@ -22,11 +22,13 @@ public:
         }
 
 
+    // parallel_for, if given, spreads the proof over several threads
     CoinSpend(const Params* p,
               const PrivateCoin& coin,
               const std::vector<sigma::PublicCoin>& anonymity_set,
               const SpendMetaData& m,
-              bool fPadding);
+              bool fPadding,
+              const ParallelForExecutor& parallel_for = ParallelForExecutor());
 
     void updateMetaData(const PrivateCoin& coin, const SpendMetaData& m);
 
@@ -52,6 +54,15 @@ public:
 
     bool Verify(const std::vector<sigma::PublicCoin>& anonymity_set, const SpendMetaData &m, bool fPadding) const;
 
+    bool Verify(const std::vector<GroupElement>& anonymity_set, const SpendMetaData &m, bool fPadding) const;
+
+    // Verify several spends referring to the same anonymity set, metadata[i] belongs to spends[i].
+    static bool BatchVerify(
+            const secp_primitives::AffineGroupElements& anonymity_set,
+            const std::vector<const CoinSpend*>& spends,
+            const std::vector<SpendMetaData>& metadata,
+            bool fPadding);
+
     ADD_SERIALIZE_METHODS;
     template <typename Stream, typename Operation>
     void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
@@ -74,6 +85,9 @@ public:
     
     uint256 signatureHash(const SpendMetaData& m) const;
 
+private:
+    bool VerifySignature(const SpendMetaData& m) const;
+
 private:
     const Params* params;
     unsigned int version = 0;
@@ -3,6 +3,8 @@
 namespace sigma {
 
 Params* Params::instance;
+std::size_t Params::fixed_base_memory = DEFAULT_FIXED_BASE_MEMORY;
+
 Params* Params::get_default() {
     if(instance != nullptr)
         return instance;
@@ -59,4 +61,66 @@ uint64_t Params::get_m() const{
     return m_;
 }
 
+void Params::set_fixed_base_memory(std::size_t bytes) {
+    fixed_base_memory = bytes;
+}
+
+void Params::build_fixed_base_tables() const {
+    // Pick the widest window for which tables of g and all of h_ fit in the limit.
+    // Below 4 bits the tables are no faster than the generic multiexponentiation,
+    // beyond 8 bits they grow much faster than the multiplications speed up.
+    const std::size_t bases = h_.size() + 1;
+    int window_bits = 0;
+    for (int w = 4; w <= 8; ++w) {
+        if (FixedBaseTable::memory_required(w) * bases <= fixed_base_memory)
+            window_bits = w;
+    }
+    if (window_bits == 0)
+        return;
+
+    g_table_.reset(new FixedBaseTable(g_, window_bits));
+    h_tables_.reserve(h_.size());
+    for (std::size_t i = 0; i < h_.size(); ++i)
+        h_tables_.emplace_back(new FixedBaseTable(h_[i], window_bits));
+}
+
+bool Params::fixed_base_commit(const GroupElement& g,
+                               const std::vector<GroupElement>& h,
+                               const std::vector<Scalar>& exp,
+                               const Scalar& r,
+                               GroupElement& result_out) const {
+    std::call_once(fixed_base_once_, &Params::build_fixed_base_tables, this);
+    if (!g_table_ || h.size() > h_tables_.size() || exp.size() != h.size())
+        return false;
+    if (!g_table_->is_base(g))
+        return false;
+    for (std::size_t i = 0; i < h.size(); ++i) {
+        if (!h_tables_[i]->is_base(h[i]))
+            return false;
+    }
+
+    g_table_->add_multiple(r, result_out);
+    for (std::size_t i = 0; i < h.size(); ++i)
+        h_tables_[i]->add_multiple(exp[i], result_out);
+    return true;
+}
+
+bool Params::fixed_base_commit(const GroupElement& g,
+                               const Scalar& m,
+                               const GroupElement& h,
+                               const Scalar& r,
+                               GroupElement& result_out) const {
+    std::call_once(fixed_base_once_, &Params::build_fixed_base_tables, this);
+    if (!g_table_ || !g_table_->is_base(g))
+        return false;
+    for (std::size_t i = 0; i < h_tables_.size(); ++i) {
+        if (h_tables_[i]->is_base(h)) {
+            result_out = g_table_->get_multiple(m);
+            h_tables_[i]->add_multiple(r, result_out);
+            return true;
+        }
+    }
+    return false;
+}
+
 } //namespace sigma
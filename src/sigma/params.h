@@ -2,12 +2,19 @@
 #define NOIR_SIGMA_PARAMS_H
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
+#include <secp256k1/include/FixedBaseTable.h>
 #include <serialize.h>
 
+#include <memory>
+#include <mutex>
+
 using namespace secp_primitives;
 
 namespace sigma {
 
+/** Default memory limit for the fixed-base tables of g and h_, in bytes. */
+static const std::size_t DEFAULT_FIXED_BASE_MEMORY = 16 << 20;
+
 class Params {
 public:
     static Params* get_default();
@@ -17,16 +24,46 @@ public:
     uint64_t get_n() const;
     uint64_t get_m() const;
 
+    /** Sets the memory limit for the fixed-base tables. Tables are built on first use,
+     *  so this only has an effect if called before any commitment is computed.
+     *  A limit too small for the smallest window disables the tables.
+     */
+    static void set_fixed_base_memory(std::size_t bytes);
+
+    /** Adds g * r + sum(h[i] * exp[i]) to result_out with the precomputed tables. Returns false,
+     *  leaving result_out untouched, if the tables are disabled or g and h are not this object's
+     *  generators.
+     */
+    bool fixed_base_commit(const GroupElement& g,
+                           const std::vector<GroupElement>& h,
+                           const std::vector<Scalar>& exp,
+                           const Scalar& r,
+                           GroupElement& result_out) const;
+
+    /** Same as above for g * m + h * r, where h is one of this object's h_. */
+    bool fixed_base_commit(const GroupElement& g,
+                           const Scalar& m,
+                           const GroupElement& h,
+                           const Scalar& r,
+                           GroupElement& result_out) const;
+
 private:
    Params(const GroupElement& g, int n, int m);
     ~Params();
 
+    void build_fixed_base_tables() const;
+
 private:
     static Params* instance;
+    static std::size_t fixed_base_memory;
     GroupElement g_;
     std::vector<GroupElement> h_;
     int m_;
     int n_;
+
+    mutable std::once_flag fixed_base_once_;
+    mutable std::unique_ptr<FixedBaseTable> g_table_;
+    mutable std::vector<std::unique_ptr<FixedBaseTable>> h_tables_;
 };
 
 }//namespace sigma
@@ -15,7 +15,8 @@ public:
                      const std::vector<Exponent>& b,
                      const Exponent& r,
                      int n,
-                     int m);
+                     int m,
+                     const Params* params = NULL);
 
     // Returns commitment B.
     const GroupElement& get_B() const;
@@ -67,6 +68,9 @@ private:
     int n_;
     int m_;
 
+    // Precomputed tables for the generators, if any
+    const Params* params_;
+
 };
 
 } // namespace sigma
@@ -7,15 +7,17 @@ R1ProofGenerator<Exponent,GroupElement>::R1ProofGenerator(
         const std::vector<Exponent>& b,
         const Exponent& r,
         int n ,
-        int m)
+        int m,
+        const Params* params)
     : g_(g)
     , h_(h_gens)
     , b_(b)
     , r(r)
     , n_(n)
     , m_(m)
+    , params_(params)
 {
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, b_, r, B_Commit);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, b_, r, B_Commit, params_);
 }
 
 template<class Exponent, class GroupElement>
@@ -51,7 +53,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement A;
     while(!A.isMember() || A.isInfinity()) {
         rA_.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a_out, rA_, A);
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a_out, rA_, A, params_);
     }
     proof_out.A_ = A;
 
@@ -64,7 +66,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement C;
     while(!C.isMember() || C.isInfinity()) {
         rC_.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC_, C);
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC_, C, params_);
     }
     proof_out.C_ = C;
 
@@ -77,7 +79,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement D;
     while(!D.isMember() || D.isInfinity()) {
         rD_.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, d, rD_, D);
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, d, rD_, D, params_);
     }
     proof_out.D_ = D;
 
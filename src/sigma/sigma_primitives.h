@@ -4,6 +4,7 @@
 #include "../secp256k1/include/MultiExponent.h"
 #include "../secp256k1/include/GroupElement.h"
 #include "../secp256k1/include/Scalar.h"
+#include "params.h"
 
 #include <algorithm>
 #include <vector>
@@ -14,13 +15,19 @@ template<class Exponent, class GroupElement>
 class SigmaPrimitives {
 
 public:
+    /** \brief Adds g * r + sum(h[i] * exp[i]) to result_out.
+     *  \param[in] params If given and g, h are its generators, their precomputed tables are used.
+     */
     static void commit(const GroupElement& g,
             const std::vector<GroupElement>& h,
             const std::vector<Exponent>& exp,
             const Exponent& r,
-            GroupElement& result_out);
+            GroupElement& result_out,
+            const Params* params = NULL);
 
-    static GroupElement commit(const GroupElement& g, const Exponent m, const GroupElement h, const Exponent r);
+    /** \brief Returns g * m + h * r, with the precomputed tables of params as above. */
+    static GroupElement commit(const GroupElement& g, const Exponent m, const GroupElement h, const Exponent r,
+            const Params* params = NULL);
 
     static void convert_to_sigma(uint64_t num, uint64_t n, uint64_t m, std::vector<Exponent>& out);
 
@@ -34,6 +41,23 @@ public:
      */
     static void new_factor(const Exponent& x, const Exponent& a, std::vector<Exponent>& coefficients);
 
+    /** \brief Computes coefficients 0..m-1 of the polynomials P_i(x) = \prod_j (sigma_{j,i_j}x + a_{j,i_j}), where
+     *  i_j are the n-ary digits of i, for every i in [begin, end). Digits are advanced incrementally and the
+     *  product of the factors of the higher digits is shared by consecutive indices.
+     *  \param[in] sigma Bit table as built by convert_to_sigma, every entry must be 0 or 1 (asserted in debug
+     *  builds). Any other value gives wrong polynomials.
+     *  \param[out] coefficients Coefficient k of P_i is written to coefficients[k * stride + i].
+     */
+    static void compute_polynomials(const std::vector<Exponent>& sigma, const std::vector<Exponent>& a,
+                                    uint64_t n, uint64_t m, std::size_t begin, std::size_t end,
+                                    Exponent* coefficients, std::size_t stride);
+
+    /** \brief Computes f_i = \prod_j f_{j,i_j} for every i in [begin, end) into f_i_out[i], in the same
+     *  incremental way as compute_polynomials. Unlike sigma there, the entries of f may take any value.
+     */
+    static void compute_f_products(const std::vector<Exponent>& f, uint64_t n, uint64_t m,
+                                   std::size_t begin, std::size_t end, Exponent* f_i_out);
+
     };
 
 } // namespace sigma
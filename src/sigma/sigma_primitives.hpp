@@ -1,5 +1,7 @@
 #include "../../crypto/sha256.h"
 
+#include <cassert>
+
 namespace sigma {
 
 template<class Exponent, class GroupElement>
@@ -7,7 +9,10 @@ void SigmaPrimitives<Exponent, GroupElement>::commit(const GroupElement& g,
         const std::vector<GroupElement>& h,
         const std::vector<Exponent>& exp,
         const Exponent& r,
-        GroupElement& result_out) {
+        GroupElement& result_out,
+        const Params* params) {
+    if (params && params->fixed_base_commit(g, h, exp, r, result_out))
+        return;
     secp_primitives::MultiExponent mult(h, exp);
     result_out += g * r + mult.get_multiple();
 }
@@ -17,7 +22,11 @@ GroupElement SigmaPrimitives<Exponent, GroupElement>::commit(
         const GroupElement& g,
         const Exponent m,
         const GroupElement h,
-        const Exponent r){
+        const Exponent r,
+        const Params* params){
+    GroupElement result;
+    if (params && params->fixed_base_commit(g, m, h, r, result))
+        return result;
     return g * m + h * r;
 }
 
@@ -92,4 +101,88 @@ void SigmaPrimitives<Exponent, GroupElement>::new_factor(
     coefficients[0] *= a;
 }
 
+template<class Exponent, class GroupElement>
+void SigmaPrimitives<Exponent, GroupElement>::compute_polynomials(
+        const std::vector<Exponent>& sigma,
+        const std::vector<Exponent>& a,
+        uint64_t n,
+        uint64_t m,
+        std::size_t begin,
+        std::size_t end,
+        Exponent* coefficients,
+        std::size_t stride) {
+    if (begin >= end)
+        return;
+
+#ifdef DEBUG
+    // The factors below are only right for a bit table
+    for (const Exponent& bit : sigma)
+        assert(bit.isZero() || bit == Exponent(uint64_t(1)));
+#endif
+
+    // Level j holds the product of the factors of digits j..m-1, a polynomial of degree m-j.
+    std::vector<Exponent> levels((m + 1) * (m + 1));
+    levels[m * (m + 1)] = Exponent(uint64_t(1));
+    std::vector<uint64_t> digits = convert_to_nal(begin, n, m);
+    uint64_t changed = m;
+
+    for (std::size_t i = begin; i < end; ++i) {
+        for (uint64_t j = changed; j-- > 0; ) {
+            const Exponent* p = &levels[(j + 1) * (m + 1)];
+            Exponent* q = &levels[j * (m + 1)];
+            std::size_t degree = m - j - 1;
+            const Exponent& factor_a = a[j * n + digits[j]];
+            // sigma is a bit table, so its factor only decides whether p shifts into q
+            if (sigma[j * n + digits[j]].isZero()) {
+                for (std::size_t d = 0; d <= degree; ++d)
+                    q[d] = factor_a * p[d];
+                q[degree + 1] = Exponent(uint64_t(0));
+            } else {
+                q[0] = factor_a * p[0];
+                for (std::size_t d = 1; d <= degree; ++d)
+                    q[d] = factor_a * p[d] + p[d - 1];
+                q[degree + 1] = p[degree];
+            }
+        }
+
+        for (uint64_t k = 0; k < m; ++k)
+            coefficients[k * stride + i] = levels[k];
+
+        // Advance the digits, every digit up to the last carry needs its level rebuilt.
+        changed = 0;
+        while (changed < m && ++digits[changed] == n)
+            digits[changed++] = 0;
+        changed = std::min<uint64_t>(changed + 1, m);
+    }
+}
+
+template<class Exponent, class GroupElement>
+void SigmaPrimitives<Exponent, GroupElement>::compute_f_products(
+        const std::vector<Exponent>& f,
+        uint64_t n,
+        uint64_t m,
+        std::size_t begin,
+        std::size_t end,
+        Exponent* f_i_out) {
+    if (begin >= end)
+        return;
+
+    // products[j] is the product of f_{k,i_k} for the digits k >= j.
+    std::vector<Exponent> products(m + 1);
+    products[m] = Exponent(uint64_t(1));
+    std::vector<uint64_t> digits = convert_to_nal(begin, n, m);
+    uint64_t changed = m;
+
+    for (std::size_t i = begin; i < end; ++i) {
+        for (uint64_t j = changed; j-- > 0; )
+            products[j] = products[j + 1] * f[j * n + digits[j]];
+        f_i_out[i] = products[0];
+
+        changed = 0;
+        while (changed < m && ++digits[changed] == n)
+            digits[changed++] = 0;
+        changed = std::min<uint64_t>(changed + 1, m);
+    }
+}
+
 } // namespace sigma
@@ -5,15 +5,25 @@
 #include "sigmaplus_proof.h"
 
 #include <cstddef>
+#include <functional>
 
 namespace sigma {
 
+// Calls fn(begin, end) on ranges covering [begin, end) of at least min_range items each, possibly on
+// other threads, and returns once all of them are done
+typedef std::function<void(std::size_t begin, std::size_t end, std::size_t min_range,
+    const std::function<void(std::size_t, std::size_t)>& fn)> ParallelForExecutor;
+
 template <class Exponent, class GroupElement>
 class SigmaPlusProver{
 
 public:
+    // params, if given, provides precomputed tables for the generators. parallel_for, if given,
+    // spreads the computation of the polynomials, which otherwise runs on the calling thread.
     SigmaPlusProver(const GroupElement& g,
-                    const std::vector<GroupElement>& h_gens, int n, int m);
+                    const std::vector<GroupElement>& h_gens, int n, int m,
+                    const Params* params = NULL,
+                    const ParallelForExecutor& parallel_for = ParallelForExecutor());
     void proof(const std::vector<GroupElement>& commits,
                std::size_t l,
                const Exponent& r,
@@ -21,10 +31,15 @@ public:
                SigmaPlusProof<Exponent, GroupElement>& proof_out);
 
 private:
+    // Polynomials below this count are not worth a thread of their own
+    static const std::size_t MIN_POLYNOMIALS_PER_THREAD = 1024;
+
     GroupElement g_;
     std::vector<GroupElement> h_;
     int n_;
     int m_;
+    const Params* params_;
+    ParallelForExecutor parallel_for_;
 };
 
 } // namespace sigma
@@ -6,11 +6,15 @@ SigmaPlusProver<Exponent, GroupElement>::SigmaPlusProver(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const Params* params,
+        const ParallelForExecutor& parallel_for)
     : g_(g)
     , h_(h_gens)
     , n_(n)
-    , m_(m) {
+    , m_(m)
+    , params_(params)
+    , parallel_for_(parallel_for) {
 }
 
 template<class Exponent, class GroupElement>
@@ -35,26 +39,25 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
     for (int k = 0; k < m_; ++k) {
         Pk[k].randomize();
     }
-    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_);
+    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_, params_);
     proof_out.B_ = r1prover.get_B();
     std::vector<Exponent> a;
     r1prover.proof(a, proof_out.r1Proof_, true /*Skip generation of final response*/);
 
-    // Compute coefficients of Polynomials P_I(x), for all I from [0..N].
+    // Compute coefficients of Polynomials P_I(x), for all I from [0..N], into an m x N matrix, coefficient k
+    // of P_I being at P_k_i[k * N + I]. Polynomials are independent, large sets are split between the cores.
     std::size_t N = setSize;
-    std::vector <std::vector<Exponent>> P_i_k;
-    P_i_k.resize(N);
+    std::vector<Exponent> P_k_i(m_ * N);
 
     // last polynomial is special case if fPadding is true
-    for (std::size_t i = 0; i < (fPadding ? N-1 : N); ++i) {
-        std::vector<Exponent>& coefficients = P_i_k[i];
-        std::vector<uint64_t> I = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n_, m_);
-        coefficients.push_back(a[I[0]]);
-        coefficients.push_back(sigma[I[0]]);
-        for (int j = 1; j < m_; ++j) {
-            SigmaPrimitives<Exponent, GroupElement>::new_factor(sigma[j * n_ + I[j]], a[j * n_ + I[j]], coefficients);
-        }
-    }
+    std::size_t n_polynomials = fPadding ? N - 1 : N;
+    auto compute_polynomials = [&](std::size_t begin, std::size_t end) {
+        SigmaPrimitives<Exponent, GroupElement>::compute_polynomials(sigma, a, n_, m_, begin, end, P_k_i.data(), N);
+    };
+    if (parallel_for_)
+        parallel_for_(0, n_polynomials, MIN_POLYNOMIALS_PER_THREAD, compute_polynomials);
+    else
+        compute_polynomials(0, n_polynomials);
 
     if (fPadding) {
         /*
@@ -104,22 +107,14 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
                 p_i_sum[j + k] += polynomial[k];
         }
 
-        P_i_k[N-1] = p_i_sum;
+        for (int k = 0; k < m_; ++k)
+            P_k_i[k * N + N - 1] = p_i_sum[k];
     }
 
-    //computing G_k`s;
-    std::vector <GroupElement> Gk;
-    Gk.reserve(m_);
+    //computing G_k`s, all m sums run over the same commitments so they share one normalization of them;
+    std::vector <GroupElement> Gk = secp_primitives::MultiExponent::get_multiples(commits, P_k_i, m_);
     for (int k = 0; k < m_; ++k) {
-        std::vector <Exponent> P_i;
-        P_i.reserve(N);
-        for (size_t i = 0; i < N; ++i) {
-            P_i.emplace_back(P_i_k[i][k]);
-        }
-        secp_primitives::MultiExponent mult(commits, P_i);
-        GroupElement c_k = mult.get_multiple();
-        c_k += SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], Pk[k]);
-        Gk.emplace_back(c_k);
+        Gk[k] += SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], Pk[k], params_);
     }
     proof_out.Gk_ = Gk;
 
@@ -9,19 +9,38 @@ template<class Exponent, class GroupElement>
 class SigmaPlusVerifier{
 
 public:
+    // params, if given, provides precomputed tables for the generators
     SigmaPlusVerifier(const GroupElement& g,
                       const std::vector<GroupElement>& h_gens,
-                      int n, int m_);
+                      int n, int m_,
+                      const Params* params = NULL);
 
     bool verify(const std::vector<GroupElement>& commits,
                 const SigmaPlusProof<Exponent, GroupElement>& proof,
                 bool fPadding) const;
 
+    /** \brief Verifies several proofs which share the same anonymity set.
+     *  Proof j is checked against commitments commits[i] - g * serials[j]. All the final
+     *  checks are folded into a single multi-exponentiation using random weights.
+     */
+    bool batch_verify(const secp_primitives::AffineGroupElements& commits,
+                      const std::vector<Exponent>& serials,
+                      const std::vector<SigmaPlusProof<Exponent, GroupElement>>& proofs,
+                      bool fPadding) const;
+
 private:
+    // Checks everything except the final equation and computes powers of the commitments.
+    bool compute_fis(const SigmaPlusProof<Exponent, GroupElement>& proof,
+                     std::size_t N,
+                     bool fPadding,
+                     Exponent& challenge_x_out,
+                     std::vector<Exponent>& f_i_out) const;
+
     GroupElement g_;
     std::vector<GroupElement> h_;
     int n;
     int m;
+    const Params* params_;
 };
 
 } // namespace sigma
@@ -5,11 +5,13 @@ SigmaPlusVerifier<Exponent, GroupElement>::SigmaPlusVerifier(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const Params* params)
     : g_(g)
     , h_(h_gens)
     , n(n)
-    , m(m){
+    , m(m)
+    , params_(params){
 }
 
 template<class Exponent, class GroupElement>
@@ -17,8 +19,115 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         const std::vector<GroupElement>& commits,
         const SigmaPlusProof<Exponent, GroupElement>& proof,
         bool fPadding) const {
+    Exponent challenge_x;
+    std::vector<Exponent> f_i_;
+    if (!compute_fis(proof, commits.size(), fPadding, challenge_x, f_i_))
+        return false;
+
+    secp_primitives::MultiExponent mult(commits, f_i_);
+    GroupElement t1 = mult.get_multiple();
+
+    GroupElement t2;
+    Exponent x_k(uint64_t(1));
+    for(int k = 0; k < m; ++k){
+        t2 += (proof.Gk_[k] * (x_k.negate()));
+        x_k *= challenge_x;
+    }
+
+    GroupElement left(t1 + t2);
+    if (left != SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], proof.z_, params_)) {
+        LogPrintf("Sigma spend failed due to final proof verification failure.");
+        return false;
+    }
+
+    return true;
+}
 
-    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m);
+template<class Exponent, class GroupElement>
+bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
+        const secp_primitives::AffineGroupElements& commits,
+        const std::vector<Exponent>& serials,
+        const std::vector<SigmaPlusProof<Exponent, GroupElement>>& proofs,
+        bool fPadding) const {
+    if (serials.size() != proofs.size()) {
+        LogPrintf("Sigma batch verification failed due to serials and proofs count mismatch.");
+        return false;
+    }
+    if (proofs.empty())
+        return true;
+
+    /*
+     * Every proof j has to satisfy (TeX notation):
+     *
+     *   \sum_{i=0}^{N-1}f_{j,i}(A_i - s_j g) - \sum_{k=0}^{m-1}x_j^k G_{j,k} - z_j h_0 = 0
+     *
+     * Multiplying each equation by a random weight y_j and summing them up gives a single
+     * equation with common anonymity set points A_i, so the expensive part is computed once.
+     */
+    std::size_t N = commits.size();
+    std::vector<Exponent> exponents(N, Exponent(uint64_t(0)));
+    Exponent g_exp(uint64_t(0)), h0_exp(uint64_t(0));
+    std::vector<GroupElement> Gk_points;
+    std::vector<Exponent> Gk_exps;
+    Gk_points.reserve(m * proofs.size());
+    Gk_exps.reserve(m * proofs.size());
+
+    for (std::size_t j = 0; j < proofs.size(); ++j) {
+        Exponent challenge_x;
+        std::vector<Exponent> f_i_;
+        if (!compute_fis(proofs[j], N, fPadding, challenge_x, f_i_))
+            return false;
+
+        Exponent y;
+        y.randomize();
+
+        Exponent f_sum(uint64_t(0));
+        for (std::size_t i = 0; i < N; ++i) {
+            f_sum += f_i_[i];
+            exponents[i] += f_i_[i] * y;
+        }
+        g_exp -= serials[j] * f_sum * y;
+        h0_exp -= proofs[j].z_ * y;
+
+        Exponent x_k(y);
+        for (int k = 0; k < m; ++k) {
+            Gk_points.emplace_back(proofs[j].Gk_[k]);
+            Gk_exps.emplace_back(x_k.negate());
+            x_k *= challenge_x;
+        }
+    }
+
+    std::vector<GroupElement> points;
+    points.reserve(2 + Gk_points.size());
+    points.emplace_back(g_);
+    points.emplace_back(h_[0]);
+    points.insert(points.end(), Gk_points.begin(), Gk_points.end());
+
+    std::vector<Exponent> point_exps;
+    point_exps.reserve(points.size());
+    point_exps.emplace_back(g_exp);
+    point_exps.emplace_back(h0_exp);
+    point_exps.insert(point_exps.end(), Gk_exps.begin(), Gk_exps.end());
+
+    // The anonymity set is already normalized, only the per proof points need converting.
+    secp_primitives::MultiExponent mult(commits, exponents.data(), points, point_exps);
+    if (!mult.get_multiple().isInfinity()) {
+        LogPrintf("Sigma spend failed due to final batch verification failure.");
+        return false;
+    }
+
+    return true;
+}
+
+template<class Exponent, class GroupElement>
+bool SigmaPlusVerifier<Exponent, GroupElement>::compute_fis(
+        const SigmaPlusProof<Exponent, GroupElement>& proof,
+        std::size_t N,
+        bool fPadding,
+        Exponent& challenge_x,
+        std::vector<Exponent>& f_i_) const {
+
+    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m, params_);
     std::vector<Exponent> f;
     const R1Proof<Exponent, GroupElement>& r1Proof = proof.r1Proof_;
     if (!r1ProofVerifier.verify(r1Proof, f, true /* Skip verification of final response */)) {
@@ -44,7 +153,6 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         r1Proof.A_, proof.B_, r1Proof.C_, r1Proof.D_};
 
     group_elements.insert(group_elements.end(), Gk.begin(), Gk.end());
-    Exponent challenge_x;
     SigmaPrimitives<Exponent, GroupElement>::generate_challenge(group_elements, challenge_x);
 
     // Now verify the final response of r1 proof. Values of "f" are finalized only after this call.
@@ -58,24 +166,15 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         return false;
     }
 
-    if (commits.empty()) {
+    if (N == 0) {
         LogPrintf("No mints in the anonymity set");
         return false;
     }
 
-    std::size_t N = commits.size();
-    std::vector<Exponent> f_i_;
-    f_i_.reserve(N);
+    f_i_.resize(N);
 
     // if fPadding is true last index is special
-    for (std::size_t i = 0; i < (fPadding ? N-1 : N); ++i) {
-        std::vector<uint64_t> I = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n, m);
-        Exponent f_i(uint64_t(1));
-        for(int j = 0; j < m; ++j){
-            f_i *= f[j*n + I[j]];
-        }
-        f_i_.emplace_back(f_i);
-    }
+    SigmaPrimitives<Exponent, GroupElement>::compute_f_products(f, n, m, 0, fPadding ? N-1 : N, f_i_.data());
 
     if (fPadding) {
         /*
@@ -109,23 +208,7 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
             pow += fi_sum * xj * f_part_product[m - j - 1];
             xj *= challenge_x;
         }
-        f_i_.emplace_back(pow);
-    }
-
-    secp_primitives::MultiExponent mult(commits, f_i_);
-    GroupElement t1 = mult.get_multiple();
-    
-    GroupElement t2;
-    Exponent x_k(uint64_t(1));
-    for(int k = 0; k < m; ++k){
-        t2 += (Gk[k] * (x_k.negate()));
-        x_k *= challenge_x;
-    }
-
-    GroupElement left(t1 + t2);
-    if (left != SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], proof.z_)) {
-        LogPrintf("Sigma spend failed due to final proof verification failure.");
-        return false;
+        f_i_[N - 1] = pow;
     }
 
     return true;
@@ -0,0 +1,115 @@
+#include "../sigma_primitives.h"
+#include "../params.h"
+
+#include "../../secp256k1/include/FixedBaseTable.h"
+#include "../../secp256k1/include/GroupElement.h"
+#include "../../secp256k1/include/Scalar.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(sigma_fixed_base_table_tests)
+
+BOOST_AUTO_TEST_CASE(multiplication_test)
+{
+    secp_primitives::GroupElement base;
+    base.randomize();
+
+    std::vector<secp_primitives::Scalar> exponents;
+    exponents.push_back(secp_primitives::Scalar(uint64_t(0)));
+    exponents.push_back(secp_primitives::Scalar(uint64_t(1)));
+    // Order - 1
+    exponents.push_back(secp_primitives::Scalar(uint64_t(1)).negate());
+    for (int i = 0; i < 10; ++i) {
+        secp_primitives::Scalar exponent;
+        exponent.randomize();
+        exponents.push_back(exponent);
+    }
+
+    // 1 and 256 don't divide each other, the last window is a partial one for 3 and 7
+    for (int window_bits : {1, 3, 4, 7, 8}) {
+        secp_primitives::FixedBaseTable table(base, window_bits);
+        for (const secp_primitives::Scalar& exponent : exponents) {
+            BOOST_CHECK(table.get_multiple(exponent) == base * exponent);
+
+            secp_primitives::GroupElement other;
+            other.randomize();
+            secp_primitives::GroupElement result(other);
+            table.add_multiple(exponent, result);
+            BOOST_CHECK(result == other + base * exponent);
+        }
+    }
+
+    BOOST_CHECK(secp_primitives::FixedBaseTable(base, 8).get_multiple(exponents[0]).isInfinity());
+    BOOST_CHECK(secp_primitives::FixedBaseTable(base, 8).get_multiple(exponents[2]) == base.inverse());
+}
+
+BOOST_AUTO_TEST_CASE(is_base_test)
+{
+    secp_primitives::GroupElement base, other;
+    base.randomize();
+    other.randomize();
+    secp_primitives::FixedBaseTable table(base, 4);
+
+    secp_primitives::GroupElement copy(base);
+    BOOST_CHECK(table.is_base(copy));
+    // The same point with another projective representation
+    secp_primitives::GroupElement same = (base + other) + other.inverse();
+    BOOST_CHECK(table.is_base(same));
+
+    BOOST_CHECK(!table.is_base(other));
+    BOOST_CHECK(!table.is_base(base.inverse()));
+    BOOST_CHECK(!table.is_base(secp_primitives::GroupElement()));
+
+    secp_primitives::FixedBaseTable infinity_table(secp_primitives::GroupElement(), 4);
+    BOOST_CHECK(infinity_table.is_base(secp_primitives::GroupElement()));
+    BOOST_CHECK(!infinity_table.is_base(base));
+}
+
+BOOST_AUTO_TEST_CASE(commit_with_tables_test)
+{
+    typedef sigma::SigmaPrimitives<secp_primitives::Scalar, secp_primitives::GroupElement> Primitives;
+    const sigma::Params* params = sigma::Params::get_default();
+
+    // Generators equal to the ones of params, but not copies of them
+    secp_primitives::GroupElement other;
+    other.randomize();
+    secp_primitives::GroupElement g = (params->get_g() + other) + other.inverse();
+    std::vector<secp_primitives::GroupElement> h;
+    for (const secp_primitives::GroupElement& h_i : params->get_h())
+        h.push_back((h_i + other) + other.inverse());
+
+    std::vector<secp_primitives::Scalar> exp(h.size());
+    for (secp_primitives::Scalar& e : exp)
+        e.randomize();
+    secp_primitives::Scalar r;
+    r.randomize();
+
+    // The generators of params themselves, then the equal ones
+    for (int copies = 1; copies >= 0; --copies) {
+        const secp_primitives::GroupElement& g_i = copies ? params->get_g() : g;
+        const std::vector<secp_primitives::GroupElement>& h_i = copies ? params->get_h() : h;
+
+        secp_primitives::GroupElement with_tables, without_tables;
+        Primitives::commit(g_i, h_i, exp, r, with_tables, params);
+        Primitives::commit(g_i, h_i, exp, r, without_tables);
+        BOOST_CHECK(with_tables == without_tables);
+        BOOST_CHECK(with_tables == g_i * r + secp_primitives::MultiExponent(h_i, exp).get_multiple());
+        // and the tables were used
+        secp_primitives::GroupElement direct;
+        BOOST_CHECK(params->fixed_base_commit(g_i, h_i, exp, r, direct));
+        BOOST_CHECK(direct == with_tables);
+
+        BOOST_CHECK(Primitives::commit(g_i, exp[0], h_i[0], r, params) == Primitives::commit(g_i, exp[0], h_i[0], r));
+    }
+
+    // Other generators are committed to without the tables
+    secp_primitives::GroupElement with_params, without_params;
+    Primitives::commit(other, h, exp, r, with_params, params);
+    Primitives::commit(other, h, exp, r, without_params);
+    BOOST_CHECK(with_params == without_params);
+    secp_primitives::GroupElement direct;
+    BOOST_CHECK(!params->fixed_base_commit(other, h, exp, r, direct));
+    BOOST_CHECK(Primitives::commit(g, r, other, exp[0], params) == g * r + other * exp[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -169,4 +169,62 @@ BOOST_AUTO_TEST_CASE(commit2_homomorphic_test)
     BOOST_CHECK(t1+t2 == t3);
 }
 
+BOOST_AUTO_TEST_CASE(multiexponent_multiples_test)
+{
+    // Several sums over one generator set, one of them at infinity, must match separate sums
+    const std::size_t n = 40, outputs = 3;
+    std::vector<secp_primitives::GroupElement> gens(n);
+    for (std::size_t i = 1; i < n; ++i)
+        gens[i].randomize();
+
+    std::vector<secp_primitives::Scalar> powers(n * outputs);
+    for (std::size_t i = 0; i < powers.size(); ++i)
+        powers[i].randomize();
+
+    std::vector<secp_primitives::GroupElement> results =
+        secp_primitives::MultiExponent::get_multiples(gens, powers, outputs);
+    BOOST_CHECK(results.size() == outputs);
+
+    for (std::size_t k = 0; k < outputs; ++k) {
+        secp_primitives::MultiExponent mult(gens.data(), powers.data() + k * n, n);
+        BOOST_CHECK(results[k] == mult.get_multiple());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(polynomials_incremental_test)
+{
+    // Polynomials and f products computed over a sub-range with incremental digits must match
+    // the per-index computation
+    typedef sigma::SigmaPrimitives<secp_primitives::Scalar, secp_primitives::GroupElement> primitives;
+    const uint64_t n = 4, m = 4;
+    const std::size_t N = 256, begin = 7, end = 250;
+
+    std::vector<secp_primitives::Scalar> sigma, a(n * m), f(n * m);
+    primitives::convert_to_sigma(99, n, m, sigma);
+    for (std::size_t i = 0; i < n * m; ++i) {
+        a[i].randomize();
+        f[i].randomize();
+    }
+
+    std::vector<secp_primitives::Scalar> P_k_i(m * N), f_i(N);
+    primitives::compute_polynomials(sigma, a, n, m, begin, end, P_k_i.data(), N);
+    primitives::compute_f_products(f, n, m, begin, end, f_i.data());
+
+    for (std::size_t i = begin; i < end; ++i) {
+        std::vector<uint64_t> I = primitives::convert_to_nal(i, n, m);
+        std::vector<secp_primitives::Scalar> coefficients;
+        coefficients.push_back(a[I[0]]);
+        coefficients.push_back(sigma[I[0]]);
+        secp_primitives::Scalar f_product(uint64_t(1));
+        f_product *= f[I[0]];
+        for (uint64_t j = 1; j < m; ++j) {
+            primitives::new_factor(sigma[j * n + I[j]], a[j * n + I[j]], coefficients);
+            f_product *= f[j * n + I[j]];
+        }
+        for (uint64_t k = 0; k < m; ++k)
+            BOOST_CHECK(P_k_i[k * N + i] == coefficients[k]);
+        BOOST_CHECK(f_i[i] == f_product);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
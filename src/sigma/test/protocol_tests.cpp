@@ -161,4 +161,57 @@ BOOST_AUTO_TEST_CASE(prove_coin_not_in_set)
     BOOST_CHECK(!verifier.verify(commits,proof));
 }
 
+BOOST_AUTO_TEST_CASE(batch_verify)
+{
+    auto params = sigma::Params::get_default();
+    int N = 1024;
+    int n = params->get_n();
+    int m = params->get_m();
+    std::vector<int> indexes = {0, 17, 511};
+
+    secp_primitives::GroupElement g;
+    g.randomize();
+    std::vector<secp_primitives::GroupElement> h_gens;
+    h_gens.resize(n * m);
+    for(int i = 0; i < n * m; ++i ){
+        h_gens[i].randomize();
+    }
+    sigma::SigmaPlusProver<secp_primitives::Scalar,secp_primitives::GroupElement> prover(g,h_gens, n, m);
+    sigma::SigmaPlusVerifier<secp_primitives::Scalar,secp_primitives::GroupElement> verifier(g, h_gens, n, m);
+
+    std::vector<secp_primitives::GroupElement> commits;
+    for(int i = 0; i < N; ++i){
+        commits.push_back(secp_primitives::GroupElement());
+        commits[i].randomize();
+    }
+
+    std::vector<secp_primitives::Scalar> serials(indexes.size()), randoms(indexes.size());
+    for (std::size_t j = 0; j < indexes.size(); ++j) {
+        serials[j].randomize();
+        randoms[j].randomize();
+        commits[indexes[j]] = sigma::SigmaPrimitives<secp_primitives::Scalar,secp_primitives::GroupElement>::commit(
+            g, serials[j], h_gens[0], randoms[j]);
+    }
+
+    std::vector<sigma::SigmaPlusProof<secp_primitives::Scalar,secp_primitives::GroupElement>> proofs;
+    for (std::size_t j = 0; j < indexes.size(); ++j) {
+        secp_primitives::GroupElement gs = (g * serials[j]).inverse();
+        std::vector<secp_primitives::GroupElement> C;
+        for (const auto& commit : commits)
+            C.push_back(commit + gs);
+
+        sigma::SigmaPlusProof<secp_primitives::Scalar,secp_primitives::GroupElement> proof(params);
+        prover.proof(C, indexes[j], randoms[j], true, proof);
+        BOOST_CHECK(verifier.verify(C, proof, true));
+        proofs.push_back(proof);
+    }
+
+    secp_primitives::AffineGroupElements affineCommits(commits);
+    BOOST_CHECK(verifier.batch_verify(affineCommits, serials, proofs, true));
+
+    // A single wrong serial breaks the whole batch
+    std::swap(serials[0], serials[1]);
+    BOOST_CHECK(!verifier.batch_verify(affineCommits, serials, proofs, true));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,8 @@
 #include "../sigmaplus_prover.h"
 #include "../sigmaplus_verifier.h"
 
+#include <secp256k1/include/AffineGroupElements.h>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(sigma_serialize_tests)
@@ -27,6 +29,29 @@ BOOST_AUTO_TEST_CASE(group_element_serialize_infinity)
     BOOST_CHECK(initial == resulted);
 }
 
+BOOST_AUTO_TEST_CASE(affine_group_elements_serialize)
+{
+    std::vector<secp_primitives::GroupElement> elements(5);
+    for (auto& element : elements)
+        element.randomize();
+    secp_primitives::AffineGroupElements initial(elements);
+    std::vector<unsigned char> data = initial.serialize();
+    BOOST_CHECK_EQUAL(data.size(), elements.size() * secp_primitives::AffineGroupElements::serialized_size);
+
+    secp_primitives::AffineGroupElements resulted;
+    resulted.append_serialized(data);
+    BOOST_REQUIRE_EQUAL(resulted.size(), elements.size());
+    for (std::size_t i = 0; i < elements.size(); ++i)
+        BOOST_CHECK(resulted.get(i) == elements[i]);
+
+    // a point off the curve is rejected and nothing is appended
+    data[data.size() - 1] ^= 1;
+    BOOST_CHECK_THROW(resulted.append_serialized(data), std::invalid_argument);
+    BOOST_CHECK_EQUAL(resulted.size(), elements.size());
+    data.pop_back();
+    BOOST_CHECK_THROW(resulted.append_serialized(data), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(scalar_serialize)
 {
     secp_primitives::Scalar initial;
@@ -0,0 +1,107 @@
+#include "statesnapshot.h"
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "hash.h"
+#include "random.h"
+#include "util.h"
+
+#include <boost/filesystem.hpp>
+
+bool WriteStateSnapshot(const std::string &strFilename, int nSnapshotVersion, const uint256 &blockHash, const CDataStream &ssData) {
+    // Generate random temporary filename
+    unsigned short randv = 0;
+    GetRandBytes((unsigned char *) &randv, sizeof(randv));
+    std::string tmpfn = strprintf("%s.%04x", strFilename, randv);
+
+    // serialize header and state, checksum data up to that point, then append csum
+    CDataStream ssSnapshot(SER_DISK, CLIENT_VERSION);
+    ssSnapshot << FLATDATA(Params().MessageStart());
+    ssSnapshot << nSnapshotVersion;
+    ssSnapshot << blockHash;
+    ssSnapshot << ssData;
+    uint256 hash = Hash(ssSnapshot.begin(), ssSnapshot.end());
+    ssSnapshot << hash;
+
+    // open temp output file, and associate with CAutoFile
+    boost::filesystem::path pathTmp = GetDataDir() / tmpfn;
+    FILE *file = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+    if (fileout.IsNull())
+        return error("%s: Failed to open file %s", __func__, pathTmp.string());
+
+    // Write and commit header, data
+    try {
+        fileout << ssSnapshot;
+    }
+    catch (const std::exception &e) {
+        return error("%s: Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout.Get());
+    fileout.fclose();
+
+    // replace existing snapshot, if any, with the new one
+    if (!RenameOver(pathTmp, GetDataDir() / strFilename))
+        return error("%s: Rename-into-place failed", __func__);
+
+    return true;
+}
+
+bool ReadStateSnapshot(const std::string &strFilename, int nSnapshotVersion, uint256 &blockHash, CDataStream &ssData) {
+    boost::filesystem::path path = GetDataDir() / strFilename;
+    if (!boost::filesystem::exists(path))
+        return false;
+
+    // open input file, and associate with CAutoFile
+    FILE *file = fopen(path.string().c_str(), "rb");
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: Failed to open file %s", __func__, path.string());
+
+    // use file size to size memory buffer
+    uint64_t fileSize = boost::filesystem::file_size(path);
+    uint64_t dataSize = 0;
+    // Don't try to resize to a negative number if file is small
+    if (fileSize >= sizeof(uint256))
+        dataSize = fileSize - sizeof(uint256);
+    std::vector<char> vchData;
+    vchData.resize(dataSize);
+    uint256 hashIn;
+
+    // read data and checksum from file
+    try {
+        filein.read(vchData.data(), dataSize);
+        filein >> hashIn;
+    }
+    catch (const std::exception &e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+    filein.fclose();
+
+    // verify stored checksum matches input data
+    uint256 hashTmp = Hash(vchData.begin(), vchData.end());
+    if (hashIn != hashTmp)
+        return error("%s: Checksum mismatch, data corrupted", __func__);
+
+    ssData.clear();
+    ssData.write(vchData.data(), vchData.size());
+
+    unsigned char pchMsgTmp[4];
+    int nVersionIn = 0;
+    try {
+        ssData >> FLATDATA(pchMsgTmp);
+        ssData >> nVersionIn;
+        ssData >> blockHash;
+    }
+    catch (const std::exception &e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    // verify the network and format match ours
+    if (memcmp(pchMsgTmp, Params().MessageStart(), sizeof(pchMsgTmp)))
+        return error("%s: Invalid network magic number", __func__);
+    if (nVersionIn != nSnapshotVersion)
+        return error("%s: Unsupported snapshot version %d", __func__, nVersionIn);
+
+    return true;
+}
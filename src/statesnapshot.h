@@ -0,0 +1,22 @@
+#ifndef MAIN_STATESNAPSHOT_H
+#define MAIN_STATESNAPSHOT_H
+
+#include "streams.h"
+#include "uint256.h"
+
+#include <string>
+
+/**
+ * Snapshots of in-memory chain states (zerocoin, sigma) stored in the data directory, so they
+ * don't have to be rebuilt from the whole chain on every start. A snapshot is tied to the hash
+ * of the block it was taken at.
+ */
+
+// Atomically replaces the snapshot file with ssData, tagged with the format version and block hash
+bool WriteStateSnapshot(const std::string &strFilename, int nSnapshotVersion, const uint256 &blockHash, const CDataStream &ssData);
+
+// Reads the snapshot file into ssData and the block hash it was taken at. Fails if the file is
+// missing, corrupted, of another network or of another format version
+bool ReadStateSnapshot(const std::string &strFilename, int nSnapshotVersion, uint256 &blockHash, CDataStream &ssData);
+
+#endif // MAIN_STATESNAPSHOT_H
@@ -0,0 +1,231 @@
+#include "taskpool.h"
+
+#include "util.h"
+
+#include <algorithm>
+
+CTaskPool taskPool;
+
+// The pool and deque the current thread works for, the shared deque for threads outside pools
+static thread_local CTaskPool* pCurrentPool = NULL;
+static thread_local size_t nCurrentDeque = 0;
+
+CTaskPool::CTaskPool() : nDequesUsed(1), nThreads(0), nQueued(0), fStop(false)
+{
+    for (int i = 0; i <= MAX_THREADS; i++)
+        deques.emplace_back(new TaskDeque());
+}
+
+CTaskPool::~CTaskPool()
+{
+    Stop();
+}
+
+void CTaskPool::Start(int nThreadsIn)
+{
+    Stop();
+    nThreadsIn = std::min(nThreadsIn, MAX_THREADS);
+    if ((size_t)nThreadsIn + 1 > nDequesUsed)
+        nDequesUsed = nThreadsIn + 1;
+    for (int i = 0; i < nThreadsIn; i++)
+        threads.emplace_back(&CTaskPool::ThreadMain, this, i + 1);
+    nThreads = nThreadsIn;
+}
+
+void CTaskPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fStop = true;
+    }
+    cond.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+    threads.clear();
+    nThreads = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fStop = false;
+    }
+
+    // The tasks the workers left run here, no deque is left holding any
+    Task task;
+    while (Pop(task))
+        task();
+}
+
+int CTaskPool::GetThreadCount() const
+{
+    return nThreads;
+}
+
+void CTaskPool::Submit(Task task)
+{
+    TaskDeque& deque = *deques[pCurrentPool == this ? nCurrentDeque : 0];
+    {
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tasks.push_back(std::move(task));
+        nQueued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    cond.notify_one();
+}
+
+bool CTaskPool::Pop(Task& task)
+{
+    if (nQueued == 0)
+        return false;
+
+    // Newest task of the own deque first
+    size_t nOwn = pCurrentPool == this ? nCurrentDeque : 0;
+    if (nOwn != 0) {
+        TaskDeque& deque = *deques[nOwn];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if (!deque.tasks.empty()) {
+            task = std::move(deque.tasks.back());
+            deque.tasks.pop_back();
+            nQueued--;
+            return true;
+        }
+    }
+
+    // Then steal the oldest task of another deque
+    size_t nDeques = nDequesUsed;
+    for (size_t i = 1; i <= nDeques; i++) {
+        size_t nDeque = (nOwn + i) % nDeques;
+        if (nDeque == nOwn && nOwn != 0)
+            continue;
+        TaskDeque& deque = *deques[nDeque];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if (!deque.tasks.empty()) {
+            task = std::move(deque.tasks.front());
+            deque.tasks.pop_front();
+            nQueued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CTaskPool::ThreadMain(size_t nDeque)
+{
+    RenameThread("noir-worker");
+    pCurrentPool = this;
+    nCurrentDeque = nDeque;
+
+    // A stopping worker leaves the tasks still queued to Stop, so submitters that keep the queue
+    // full can't hold it up
+    while (!fStop) {
+        Task task;
+        if (Pop(task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (fStop)
+            return;
+        cond.wait(lock, [this] { return nQueued > 0 || fStop; });
+    }
+}
+
+CTaskGroup::CTaskGroup(CTaskPool& poolIn) : pool(poolIn), state(std::make_shared<State>())
+{
+    state->nPending = 0;
+}
+
+CTaskGroup::~CTaskGroup()
+{
+    try {
+        Wait();
+    } catch (...) {
+    }
+}
+
+void CTaskGroup::Execute(const std::shared_ptr<State>& state, const std::function<void()>& task)
+{
+    std::exception_ptr error;
+    try {
+        task();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (error && !state->error)
+        state->error = error;
+    if (--state->nPending == 0)
+        state->cond.notify_all();
+}
+
+void CTaskGroup::Run(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->tasks.push_back(std::move(task));
+        state->nPending++;
+    }
+    if (pool.GetThreadCount() == 0)
+        return;
+
+    std::shared_ptr<State> ticketState = state;
+    pool.Submit([ticketState] {
+        std::function<void()> next;
+        {
+            std::lock_guard<std::mutex> lock(ticketState->mutex);
+            if (ticketState->tasks.empty())
+                return;
+            next = std::move(ticketState->tasks.front());
+            ticketState->tasks.pop_front();
+        }
+        Execute(ticketState, next);
+    });
+}
+
+void CTaskGroup::Wait()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (state->tasks.empty()) {
+                state->cond.wait(lock, [this] { return state->nPending == 0; });
+                break;
+            }
+            task = std::move(state->tasks.back());
+            state->tasks.pop_back();
+        }
+        Execute(state, task);
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        std::swap(error, state->error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void ParallelFor(size_t nBegin, size_t nEnd, size_t nMinRange, const std::function<void(size_t, size_t)>& fn)
+{
+    if (nEnd <= nBegin)
+        return;
+
+    size_t nCount = nEnd - nBegin;
+    size_t nRanges = std::min<size_t>(taskPool.GetThreadCount() + 1, std::max<size_t>(1, nCount / std::max<size_t>(1, nMinRange)));
+    if (nRanges == 1) {
+        fn(nBegin, nEnd);
+        return;
+    }
+
+    CTaskGroup group;
+    for (size_t i = 0; i < nRanges; i++) {
+        size_t nRangeBegin = nBegin + nCount * i / nRanges;
+        size_t nRangeEnd = nBegin + nCount * (i + 1) / nRanges;
+        group.Run([&fn, nRangeBegin, nRangeEnd] { fn(nRangeBegin, nRangeEnd); });
+    }
+    group.Wait();
+}
@@ -0,0 +1,112 @@
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing pool that runs the parallel work of the node: script, sigma spend and header PoW
+ * checks, zerocoin proofs, sigma proving and wallet signing.
+ *
+ * Every worker has its own deque, pushing and popping its tasks at the back, while idle workers
+ * steal from the front of the others. Threads outside the pool submit to a shared deque that is
+ * stolen from the same way. The pool is sized from -par, the thread that waits for the work
+ * being the last worker.
+ */
+class CTaskPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // Most workers a pool runs, as many as -par allows besides the waiting thread
+    static const int MAX_THREADS = 16;
+
+    CTaskPool();
+    ~CTaskPool();
+
+    // Starts nThreads workers (at most MAX_THREADS), after stopping the current ones. Start and
+    // Stop are called by one thread, while any thread may keep submitting.
+    void Start(int nThreads);
+    // Joins the workers, then runs the tasks they left on the calling thread
+    void Stop();
+    int GetThreadCount() const;
+
+    // Queues a task, which must not throw
+    void Submit(Task task);
+
+private:
+    struct TaskDeque {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // The shared deque first, then one per worker. They are all created with the pool and never
+    // freed before it, so submitting and stealing need no lock on the vector.
+    std::vector<std::unique_ptr<TaskDeque>> deques;
+    // Deques that have ever been used, the ones that can hold tasks
+    std::atomic<size_t> nDequesUsed;
+    std::vector<std::thread> threads;
+    std::atomic<int> nThreads;
+    std::atomic<int> nQueued;
+
+    // Guards the sleep of idle workers and the changes of fStop
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::atomic<bool> fStop;
+
+    bool Pop(Task& task);
+    void ThreadMain(size_t nDeque);
+};
+
+extern CTaskPool taskPool;
+
+/**
+ * Fork/join helper: runs tasks on the pool and waits for all of them. The first exception thrown
+ * by a task is rethrown by Wait.
+ *
+ * The group keeps its tasks and gives the pool one ticket per task, which runs whichever task of
+ * the group is still not started. Wait runs the tasks not started yet on the waiting thread, so
+ * nested groups neither deadlock nor need more threads, and a waiting thread never runs work of
+ * another group, which could need a lock it holds. Without pool threads the tasks run inside Wait.
+ */
+class CTaskGroup
+{
+public:
+    explicit CTaskGroup(CTaskPool& poolIn = taskPool);
+    // Waits for the tasks left, dropping their exceptions
+    ~CTaskGroup();
+
+    void Run(std::function<void()> task);
+    // Runs the tasks not started yet, then waits for the others
+    void Wait();
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<std::function<void()>> tasks;
+        // Tasks not finished yet, queued or running
+        int nPending;
+        std::exception_ptr error;
+    };
+
+    static void Execute(const std::shared_ptr<State>& state, const std::function<void()>& task);
+
+    CTaskPool& pool;
+    std::shared_ptr<State> state;
+};
+
+/**
+ * Calls fn(begin, end) on consecutive ranges covering [nBegin, nEnd), one per thread of the pool
+ * and the calling thread, each of at least nMinRange items. Rethrows the first exception of fn.
+ */
+void ParallelFor(size_t nBegin, size_t nEnd, size_t nMinRange, const std::function<void(size_t, size_t)>& fn);
+
+#endif // TASKPOOL_H
@@ -9,6 +9,11 @@
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Sponge.h"
+#include "crypto/Lyra2Z/Lyra2ZContext.h"
+#include "hash.h"
+#include "primitives/block.h"
 #include "random.h"
 #include "utilstrencodings.h"
 #include "test/test_bitcoin.h"
@@ -439,4 +444,81 @@ BOOST_AUTO_TEST_CASE(aes_cbc_testvectors) {
                   "b2eb05e2c39be9fcda6c19078c6a9d1b3f461796d6b0d6b2e0c2a72b4d80e644");
 }
 
+static void TestLyra2ZRowOps(const SpongeRowOps *ops) {
+    Lyra2Context generic, simd;
+    BOOST_REQUIRE(LYRA2_context_init(&generic, 330, 256) == 0);
+    BOOST_REQUIRE(LYRA2_context_init(&simd, 330, 256) == 0);
+    generic.ops = &spongeRowOpsGeneric;
+    simd.ops = ops;
+
+    for (int i = 0; i < 8; i++) {
+        unsigned char header[80];
+        for (unsigned int j = 0; j < sizeof(header); j++)
+            header[j] = insecure_rand();
+        unsigned char expected[32], actual[32];
+        LYRA2_context(&generic, expected, 32, header, 80, header, 80, 2);
+        LYRA2_context(&simd, actual, 32, header, 80, header, 80, 2);
+        BOOST_CHECK_MESSAGE(memcmp(expected, actual, 32) == 0, ops->name);
+    }
+
+    LYRA2_context_free(&generic);
+    LYRA2_context_free(&simd);
+}
+
+BOOST_AUTO_TEST_CASE(lyra2z_simd_sponge) {
+#if defined(LYRA2_HAVE_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3"))
+        TestLyra2ZRowOps(&spongeRowOpsSSSE3);
+    if (__builtin_cpu_supports("avx2"))
+        TestLyra2ZRowOps(&spongeRowOpsAVX2);
+#endif
+    TestLyra2ZRowOps(selectSpongeRowOps());
+}
+
+BOOST_AUTO_TEST_CASE(lyra2z_known_answer) {
+    // Mainnet genesis header, whose Lyra2Z hash meets its nBits
+    CBlockHeader genesis;
+    genesis.nVersion = 2;
+    genesis.hashPrevBlock.SetNull();
+    genesis.hashMerkleRoot = uint256S("0x4f193d83c304ebd3bf2319611cbb84f26af7960f23d06dd243b6c93ebf4d7797");
+    genesis.nTime = 1478117691;
+    genesis.nBits = 520159231;
+    genesis.nNonce = 104780;
+    const uint256 expected = uint256S("0x0000b1fea8dd863d5427c145ca33105e59d1205187512d4b969bfc4e10036189");
+
+    uint256 hash;
+    BOOST_CHECK(genesis.ComputePoWHash(0, hash));
+    BOOST_CHECK_EQUAL(hash.GetHex(), expected.GetHex());
+    BOOST_CHECK_EQUAL(genesis.GetPoWHash(0).GetHex(), expected.GetHex());
+    BOOST_CHECK(!genesis.IsComputed());
+
+    // Same answer from the generic sponge, whatever the thread context selected
+    Lyra2Context generic;
+    BOOST_REQUIRE(LYRA2_context_init(&generic, Lyra2ZContext::N_ROWS, Lyra2ZContext::N_COLS) == 0);
+    generic.ops = &spongeRowOpsGeneric;
+    uint256 genericHash;
+    LYRA2_context(&generic, BEGIN(genericHash), 32, BEGIN(genesis.nVersion), 80, BEGIN(genesis.nVersion), 80, Lyra2ZContext::TIME_COST);
+    LYRA2_context_free(&generic);
+    BOOST_CHECK_EQUAL(genericHash.GetHex(), expected.GetHex());
+}
+
+BOOST_AUTO_TEST_CASE(sha256d_shared_prefix) {
+    unsigned char prefix[64];
+    GetRandBytes(prefix, sizeof(prefix));
+    // Counts around the 4 and 8 lane widths, and tails up to the largest that fits one block
+    for (size_t tailLen = 0; tailLen <= 55; tailLen += 11) {
+        for (size_t n = 1; n <= 17; n++) {
+            std::vector<unsigned char> tails(tailLen * n + 1), out(32 * n);
+            GetRandBytes(&tails[0], tails.size());
+            SHA256DSharedPrefix(&out[0], prefix, &tails[0], tailLen, n);
+            for (size_t i = 0; i < n; i++) {
+                unsigned char hash[32];
+                CHash256().Write(prefix, sizeof(prefix)).Write(&tails[i * tailLen], tailLen).Finalize(hash);
+                BOOST_CHECK(memcmp(hash, &out[i * 32], 32) == 0);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+#include "libzerocoin/FixedBaseExp.h"
+#include "zerocoin.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace libzerocoin;
+
+BOOST_FIXTURE_TEST_SUITE(fixedbaseexp_tests, BasicTestingSetup)
+
+// Powers of g from the table and from the Montgomery context must be those of CBigNum::pow_mod
+static void CheckPowers(const Bignum& g, const Bignum& modulus, const std::vector<Bignum>& exponents)
+{
+    FixedBaseExp gExp(g, modulus);
+    std::shared_ptr<const MontgomeryModulus> mont = MontgomeryModulus::Get(modulus);
+
+    for (const Bignum& e : exponents) {
+        Bignum expected = g.pow_mod(e, modulus);
+        BOOST_CHECK(gExp.pow_mod(e) == expected);
+        BOOST_CHECK(mont->pow_mod(g, e) == expected);
+    }
+}
+
+static std::vector<Bignum> TestExponents(const IntegerGroupParams& group)
+{
+    // Tables cover exponents of up to twice the bits of the modulus
+    int nTableBits = 2 * group.modulus.bitSize();
+    std::vector<Bignum> exponents = {
+        0, 1, -1, 31, 32, group.groupOrder, group.groupOrder - 1,
+        Bignum(2).pow(nTableBits) - 1, Bignum(2).pow(nTableBits), Bignum(2).pow(nTableBits) * -1,
+    };
+    for (int i = 0; i < 10; i++) {
+        exponents.push_back(Bignum::randBignum(group.groupOrder));
+        exponents.push_back(Bignum::randBignum(group.groupOrder) * -1);
+        exponents.push_back(Bignum::randBignum(Bignum(2).pow(nTableBits)));
+        // longer than the table
+        exponents.push_back(Bignum::randBignum(Bignum(2).pow(3 * group.modulus.bitSize())));
+        exponents.push_back(Bignum::randBignum(Bignum(2).pow(3 * group.modulus.bitSize())) * -1);
+    }
+    return exponents;
+}
+
+BOOST_AUTO_TEST_CASE(fixedbaseexp_matches_pow_mod)
+{
+    for (const Params* params : {ZCParams, ZCParamsV2}) {
+        const IntegerGroupParams* groups[] = {&params->coinCommitmentGroup, &params->serialNumberSoKCommitmentGroup,
+                                              &params->accumulatorParams.accumulatorPoKCommitmentGroup};
+        for (const IntegerGroupParams* group : groups) {
+            std::vector<Bignum> exponents = TestExponents(*group);
+            CheckPowers(group->g, group->modulus, exponents);
+            CheckPowers(group->h, group->modulus, exponents);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fixedbaseexp_even_modulus)
+{
+    // Even moduli have no Montgomery context and no table, powers go through CBigNum::pow_mod
+    const IntegerGroupParams& group = ZCParams->coinCommitmentGroup;
+    Bignum modulus = group.modulus + 1;
+    BOOST_REQUIRE(!BN_is_odd(&modulus));
+    BOOST_CHECK(MontgomeryModulus::Get(modulus)->getContext() == NULL);
+
+    // Negative exponents need a base invertible modulo 2^k * m, so an odd base coprime to the modulus
+    Bignum g = 3;
+    while (g.gcd(modulus) != 1)
+        g += 2;
+    std::vector<Bignum> exponents = {0, 1, 31, group.groupOrder, Bignum(2).pow(3 * modulus.bitSize()) + 1};
+    for (int i = 0; i < 10; i++) {
+        exponents.push_back(Bignum::randBignum(group.groupOrder));
+        exponents.push_back(Bignum::randBignum(group.groupOrder) * -1);
+    }
+    CheckPowers(g, modulus, exponents);
+    CheckPowers(group.g, modulus, {0, 1, Bignum::randBignum(group.groupOrder)});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
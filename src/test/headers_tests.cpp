@@ -0,0 +1,92 @@
+#include "main.h"
+#include "chainparams.h"
+#include "consensus/validation.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(headers_tests, TestingSetup)
+
+// Continuous headers following pindexPrev. Their PoW meets no target
+static std::vector<CBlockHeader> BuildHeaders(const CBlockIndex *pindexPrev, int n, uint32_t nNonce)
+{
+    std::vector<CBlockHeader> headers;
+    uint256 hashPrev = pindexPrev->GetBlockHash();
+    uint32_t nTime = pindexPrev->nTime;
+    for (int i = 0; i < n; i++) {
+        CBlockHeader header;
+        header.hashPrevBlock = hashPrev;
+        header.nTime = ++nTime;
+        header.nBits = pindexPrev->nBits;
+        header.nNonce = nNonce;
+        headers.push_back(header);
+        hashPrev = header.GetHash();
+    }
+    return headers;
+}
+
+// Processes the headers the way a headers message is, returns the DoS score of an invalid batch or -1
+static int ProcessHeaders(const std::vector<CBlockHeader> &headers, bool fPrecompute, CBlockIndex *&pindexLast)
+{
+    if (fPrecompute)
+        PrecomputeHeadersPoW(headers, Params().GetConsensus());
+    CValidationState state;
+    pindexLast = NULL;
+    int nDoS = -1;
+    if (!ProcessNewBlockHeaders(headers, state, Params(), &pindexLast))
+        BOOST_CHECK(state.IsInvalid(nDoS));
+    return nDoS;
+}
+
+static bool HaveHeader(const CBlockHeader &header)
+{
+    LOCK(cs_main);
+    return mapBlockIndex.count(header.GetHash()) > 0;
+}
+
+BOOST_AUTO_TEST_CASE(headers_precomputed_pow)
+{
+    const CBlockIndex *genesis = chainActive.Genesis();
+    BOOST_REQUIRE(genesis);
+
+    // Precomputing the PoW hashes changes nothing to what is accepted
+    for (int fPrecompute = 0; fPrecompute < 2; fPrecompute++) {
+        uint32_t nNonce = 100 * fPrecompute;
+        CBlockIndex *pindexLast;
+
+        // PoW isn't checked for headers messages, it's left to the blocks
+        std::vector<CBlockHeader> headers = BuildHeaders(genesis, 3, nNonce);
+        BOOST_CHECK_EQUAL(ProcessHeaders(headers, fPrecompute, pindexLast), -1);
+        BOOST_REQUIRE(pindexLast);
+        BOOST_CHECK(pindexLast->GetBlockHash() == headers.back().GetHash());
+        BOOST_CHECK_EQUAL(pindexLast->nHeight, 3);
+        for (std::size_t i = 0; i < headers.size(); i++) {
+            BOOST_CHECK(headers[i].IsComputed() == (fPrecompute != 0));
+            if (fPrecompute) {
+                CBlockHeader header = headers[i];
+                header.isComputed = -1;
+                BOOST_CHECK(headers[i].powHash == header.GetPoWHash(i + 1));
+            }
+        }
+
+        // Known headers are accepted again
+        BOOST_CHECK_EQUAL(ProcessHeaders(headers, fPrecompute, pindexLast), -1);
+        BOOST_CHECK(pindexLast->GetBlockHash() == headers.back().GetHash());
+
+        // A header older than the median time past is rejected, the ones before it are kept
+        headers = BuildHeaders(genesis, 3, nNonce + 1);
+        headers[2].nTime = genesis->nTime;
+        BOOST_CHECK_EQUAL(ProcessHeaders(headers, fPrecompute, pindexLast), 0);
+        BOOST_CHECK(HaveHeader(headers[1]));
+        BOOST_CHECK(!HaveHeader(headers[2]));
+
+        // as is a sequence that isn't continuous
+        headers = BuildHeaders(genesis, 3, nNonce + 2);
+        headers[2].hashPrevBlock = headers[0].GetHash();
+        BOOST_CHECK_EQUAL(ProcessHeaders(headers, fPrecompute, pindexLast), 20);
+        BOOST_CHECK(HaveHeader(headers[1]));
+        BOOST_CHECK(!HaveHeader(headers[2]));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,60 @@
+#include "chain.h"
+#include "chainparams.h"
+#include "hash.h"
+#include "pos.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(pos_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(stake_kernel_table)
+{
+    CBlockIndex index;
+    index.nHeight = Params().GetConsensus().nLastPOWBlock + 1;
+    index.nTime = 1560000000;
+    index.nStakeModifier = Hash(BEGIN(index.nTime), END(index.nTime));
+
+    // Outputs of 1 to 40 coins, some of zero value, all served from the stake cache
+    std::map<COutPoint, CStakeCache> cache;
+    std::vector<COutPoint> vPrevouts;
+    for (uint32_t i = 0; i < 40; i++) {
+        CMutableTransaction tx;
+        tx.vout.resize(2);
+        tx.vout[0].nValue = (i + 1) * COIN;
+        tx.vout[1].nValue = 0;
+        COutPoint prevout(Hash(BEGIN(i), END(i)), i % 7 == 0 ? 1 : 0);
+        cache.insert({prevout, CStakeCache(uint256(), CTransaction(tx))});
+        vPrevouts.push_back(prevout);
+    }
+
+    // About one kernel per output and window, part of which lies before the previous block
+    const unsigned int nBits = 0x1c080000;
+    const int64_t nTime = index.nTime + 30;
+    const unsigned int nInterval = 60;
+
+    std::vector<size_t> vExpected;
+    for (size_t nPos = 0; nPos < vPrevouts.size(); nPos++) {
+        for (unsigned int n = 0; n < nInterval; n++) {
+            int64_t nBlockTime;
+            if (CheckKernel(&index, nBits, nTime - n, vPrevouts[nPos], cache, &nBlockTime)) {
+                vExpected.push_back(nPos);
+                break;
+            }
+        }
+    }
+    BOOST_CHECK(!vExpected.empty() && vExpected.size() < vPrevouts.size());
+
+    CStakeKernelTable table;
+    BOOST_CHECK(!table.IsBuiltFor(&index, nBits, vPrevouts));
+    table.Build(&index, nBits, vPrevouts, cache);
+    BOOST_CHECK(table.IsBuiltFor(&index, nBits, vPrevouts));
+    BOOST_CHECK(!table.IsBuiltFor(&index, nBits + 1, vPrevouts));
+
+    std::vector<size_t> vFound;
+    for (size_t nPos = 0; table.Search(nTime, nInterval, nPos); nPos++)
+        vFound.push_back(nPos);
+    BOOST_CHECK(vFound == vExpected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
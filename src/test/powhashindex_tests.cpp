@@ -0,0 +1,97 @@
+#include "powhashindex.h"
+#include "chainparamsbase.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+struct PoWHashIndexSetup : public TestingSetup {
+    PoWHashIndexSetup() : TestingSetup(CBaseChainParams::REGTEST) {}
+};
+
+BOOST_FIXTURE_TEST_SUITE(powhashindex_tests, PoWHashIndexSetup)
+
+// Heights above the precomputed table, which regtest imports too
+static const int nHeight = 50000;
+
+BOOST_AUTO_TEST_CASE(powhashindex_lookup)
+{
+    boost::filesystem::path path = pathTemp / POW_HASH_INDEX_FILENAME;
+    uint256 blockHash = uint256S("0x0102"), otherBlockHash = uint256S("0x0103");
+    uint256 powHash = uint256S("0x0000ff"), result;
+
+    CPoWHashIndex index;
+    BOOST_CHECK(!index.Lookup(nHeight, blockHash, result));
+    BOOST_REQUIRE(index.Open(path));
+    BOOST_CHECK(!index.Lookup(nHeight, blockHash, result));
+
+    index.Add(nHeight, blockHash, powHash);
+    BOOST_CHECK(index.Lookup(nHeight, blockHash, result));
+    BOOST_CHECK(result == powHash);
+    // Another header at the same height, or the same header at another height, must be hashed
+    BOOST_CHECK(!index.Lookup(nHeight, otherBlockHash, result));
+    BOOST_CHECK(!index.Lookup(nHeight + 1, blockHash, result));
+    BOOST_CHECK(!index.Lookup(-1, blockHash, result));
+
+    // Heights past the end grow the file
+    index.Add(100000, otherBlockHash, powHash);
+    BOOST_CHECK(index.Lookup(100000, otherBlockHash, result));
+
+    // Records survive a reopen
+    index.Close();
+    BOOST_CHECK(!index.IsOpen());
+    BOOST_REQUIRE(index.Open(path));
+    BOOST_CHECK(index.Lookup(nHeight, blockHash, result));
+    BOOST_CHECK(index.Lookup(100000, otherBlockHash, result));
+    BOOST_CHECK(result == powHash);
+}
+
+BOOST_AUTO_TEST_CASE(powhashindex_torn_record)
+{
+    boost::filesystem::path path = pathTemp / POW_HASH_INDEX_FILENAME;
+    uint256 blockHash = uint256S("0x0102"), powHash = uint256S("0x0000ff"), result;
+
+    CPoWHashIndex index;
+    BOOST_REQUIRE(index.Open(path));
+    index.Add(nHeight, blockHash, powHash);
+    index.Close();
+
+    // Flip a byte of the PoW hash of the record at nHeight (64-byte header, 72-byte records),
+    // as if only part of it reached the disk
+    FILE *file = fopen(path.string().c_str(), "r+b");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE(fseek(file, 64 + (long)nHeight * 72 + 32, SEEK_SET) == 0);
+    int c = fgetc(file);
+    BOOST_REQUIRE(c != EOF);
+    BOOST_REQUIRE(fseek(file, 64 + (long)nHeight * 72 + 32, SEEK_SET) == 0);
+    fputc(c ^ 1, file);
+    fclose(file);
+
+    // The record is ignored, then replaced once the hash is computed again
+    BOOST_REQUIRE(index.Open(path));
+    BOOST_CHECK(!index.Lookup(nHeight, blockHash, result));
+    index.Add(nHeight, blockHash, powHash);
+    BOOST_CHECK(index.Lookup(nHeight, blockHash, result));
+    BOOST_CHECK(result == powHash);
+}
+
+BOOST_AUTO_TEST_CASE(powhashindex_precomputed)
+{
+    boost::filesystem::path path = pathTemp / POW_HASH_INDEX_FILENAME;
+    uint256 blockHash = uint256S("0x0102"), otherBlockHash = uint256S("0x0103"), result, otherResult;
+
+    // A new index imports the precomputed hashes, which answer for any header at their height
+    CPoWHashIndex index;
+    BOOST_REQUIRE(index.Open(path));
+    BOOST_CHECK(index.Lookup(1, blockHash, result));
+    BOOST_CHECK(!result.IsNull());
+    BOOST_CHECK(index.Lookup(1, otherBlockHash, otherResult));
+    BOOST_CHECK(result == otherResult);
+
+    // and are never replaced
+    index.Add(1, blockHash, uint256S("0x0000ff"));
+    BOOST_CHECK(index.Lookup(1, otherBlockHash, otherResult));
+    BOOST_CHECK(result == otherResult);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,210 @@
+#include "sigma.h"
+#include "chainparams.h"
+#include "main.h"
+#include "streams.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(sigma_proof_cache_tests, TestingSetup)
+
+static const sigma::CoinDenomination denomination = sigma::CoinDenomination::SIGMA_DENOM_1;
+
+static std::vector<sigma::PrivateCoin> GenerateCoins(int n)
+{
+    std::vector<sigma::PrivateCoin> coins;
+    for (int i = 0; i < n; i++)
+        coins.push_back(sigma::PrivateCoin(sigma::SigmaParams, denomination));
+    return coins;
+}
+
+static std::vector<sigma::PublicCoin> GetPublicCoins(const std::vector<sigma::PrivateCoin> &coins)
+{
+    std::vector<sigma::PublicCoin> publicCoins;
+    for (const sigma::PrivateCoin &coin : coins)
+        publicCoins.push_back(coin.getPublicCoin());
+    return publicCoins;
+}
+
+static bool ConnectMints(CBlockIndex *index, const std::vector<sigma::PublicCoin> &mints)
+{
+    CBlock block;
+    block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
+    block.sigmaTxInfo->mints = mints;
+    block.sigmaTxInfo->fInfoIsComplete = true;
+    CValidationState state;
+    return sigma::ConnectBlockSigma(state, Params(), index, &block);
+}
+
+// Transaction spending coin of the group 1, the anonymity set ends at the block blockHash
+static CTransaction BuildSpend(const sigma::PrivateCoin &coin, const std::vector<sigma::PublicCoin> &anonymitySet,
+    const uint256 &blockHash, bool fPadding)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout.n = 1;
+    tx.vout.push_back(CTxOut(1 * COIN, CScript() << OP_TRUE));
+
+    sigma::SpendMetaData metadata(1, blockHash, tx.GetHash());
+    sigma::CoinSpend spend(sigma::SigmaParams, coin, anonymitySet, metadata, fPadding);
+    spend.setVersion(fPadding ? ZEROCOIN_TX_VERSION_3_1 : ZEROCOIN_TX_VERSION_3);
+
+    CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+    serialized << spend;
+    tx.vin[0].scriptSig = CScript() << OP_SIGMASPEND;
+    tx.vin[0].scriptSig.insert(tx.vin[0].scriptSig.end(), serialized.begin(), serialized.end());
+    return tx;
+}
+
+// Cache entry of the spend of tx, the way CheckSigmaSpendTransaction computes it
+static uint256 GetCacheEntry(const CTransaction &tx, const uint256 &blockHash, int groupId,
+    const uint256 &anonymitySetHash, bool fPadding)
+{
+    CMutableTransaction txTemp = tx;
+    txTemp.vin[0].scriptSig.clear();
+    sigma::SpendMetaData metadata(groupId, blockHash, txTemp.GetHash());
+    uint256 entry;
+    sigma::GetSigmaProofCache().ComputeEntry(entry, tx.vin[0].scriptSig, metadata, denomination,
+        anonymitySetHash, fPadding);
+    return entry;
+}
+
+// Checks tx as the memory pool does, or collects its spends in sigmaTxInfo as block validation does
+static bool CheckSpend(const CTransaction &tx, sigma::CSigmaTxInfo *sigmaTxInfo = NULL)
+{
+    CValidationState state;
+    // both padded and not padded spends are accepted at this height
+    return sigma::CheckSigmaTransaction(tx, state, tx.GetHash(), false,
+        Params().GetConsensus().nSigmaPaddingBlock, false, sigmaTxInfo);
+}
+
+// Runs the checks of the spends collected in sigmaTxInfo
+static bool RunSpendChecks(sigma::CSigmaTxInfo &sigmaTxInfo)
+{
+    std::vector<sigma::CSigmaSpendCheck> vChecks;
+    sigma::GetSigmaSpendChecks(&sigmaTxInfo, vChecks, 1);
+    BOOST_CHECK_EQUAL(vChecks.size(), 1);
+    bool fValid = true;
+    for (sigma::CSigmaSpendCheck &check : vChecks)
+        fValid = check() && fValid;
+    return fValid;
+}
+
+BOOST_AUTO_TEST_CASE(sigma_proof_cache_hasher)
+{
+    sigma::CSigmaProofCacheHasher hasher;
+    uint256 a = uint256S("0x0102030405060708"), b = uint256S("0x0807060504030201");
+    BOOST_CHECK_EQUAL(hasher(a), a.GetCheapHash());
+    BOOST_CHECK_EQUAL(hasher(a), hasher(uint256(a)));
+    BOOST_CHECK(hasher(a) != hasher(b));
+}
+
+BOOST_AUTO_TEST_CASE(sigma_proof_cache_hit)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    sigmaState->Reset();
+
+    uint256 hash1 = uint256S("0x01");
+    CBlockIndex index1;
+    index1.phashBlock = &hash1;
+    index1.nHeight = Params().GetConsensus().nSigmaStartBlock;
+
+    std::vector<sigma::PrivateCoin> coins = GenerateCoins(3);
+    std::vector<sigma::PublicCoin> mints = GetPublicCoins(coins);
+    BOOST_REQUIRE(ConnectMints(&index1, mints));
+    BOOST_REQUIRE(sigmaState->GetAnonymitySetHash(denomination, 1, hash1) == hash1);
+
+    // A verified spend is cached
+    CTransaction tx = BuildSpend(coins[0], mints, hash1, true);
+    uint256 entry = GetCacheEntry(tx, hash1, 1, hash1, true);
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(entry));
+    BOOST_CHECK(CheckSpend(tx));
+    BOOST_CHECK(sigma::GetSigmaProofCache().Get(entry));
+
+    // and isn't queued for verification with the block the next time
+    sigma::CSigmaTxInfo sigmaTxInfo;
+    BOOST_CHECK(CheckSpend(tx, &sigmaTxInfo));
+    BOOST_CHECK(sigmaTxInfo.spendBatches.empty());
+
+    // Spends verified with the block are cached once their batch is verified
+    CTransaction tx2 = BuildSpend(coins[1], mints, hash1, false);
+    uint256 entry2 = GetCacheEntry(tx2, hash1, 1, hash1, false);
+    sigma::CSigmaTxInfo sigmaTxInfo2;
+    BOOST_CHECK(CheckSpend(tx2, &sigmaTxInfo2));
+    BOOST_CHECK_EQUAL(sigmaTxInfo2.spendBatches.size(), 1);
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(entry2));
+    BOOST_CHECK(RunSpendChecks(sigmaTxInfo2));
+    BOOST_CHECK(sigma::GetSigmaProofCache().Get(entry2));
+
+    sigma::CSigmaTxInfo sigmaTxInfo3;
+    BOOST_CHECK(CheckSpend(tx2, &sigmaTxInfo3));
+    BOOST_CHECK(sigmaTxInfo3.spendBatches.empty());
+
+    // The same spend with another anonymity set block, group id or padding flag misses
+    uint256 hash2 = uint256S("0x02");
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(GetCacheEntry(tx, hash1, 1, hash2, true)));
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(GetCacheEntry(tx, hash1, 2, hash1, true)));
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(GetCacheEntry(tx, hash1, 1, hash1, false)));
+
+    sigma::ClearUnsavedSigmaBlockIndexes();
+    sigmaState->Reset();
+}
+
+BOOST_AUTO_TEST_CASE(sigma_proof_cache_failures)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    sigmaState->Reset();
+
+    int nStartBlock = Params().GetConsensus().nSigmaStartBlock;
+    uint256 hash1 = uint256S("0x01"), hash2 = uint256S("0x02");
+    CBlockIndex index1, index2;
+    index1.phashBlock = &hash1;
+    index1.nHeight = nStartBlock;
+    index2.phashBlock = &hash2;
+    index2.nHeight = nStartBlock + 1;
+    index2.pprev = &index1;
+
+    std::vector<sigma::PrivateCoin> coins = GenerateCoins(2);
+    std::vector<sigma::PublicCoin> mints1 = GetPublicCoins(coins);
+    BOOST_REQUIRE(ConnectMints(&index1, mints1));
+
+    // The spend refers to a block the group has no coins in yet, its anonymity set ends at the first block
+    CTransaction tx = BuildSpend(coins[0], mints1, hash2, true);
+    BOOST_REQUIRE(sigmaState->GetAnonymitySetHash(denomination, 1, hash2) == hash1);
+    uint256 entry1 = GetCacheEntry(tx, hash2, 1, hash1, true);
+    BOOST_CHECK(CheckSpend(tx));
+    BOOST_CHECK(sigma::GetSigmaProofCache().Get(entry1));
+
+    // Once that block adds coins to the group the anonymity set changes: the cached result isn't
+    // used and the proof, made for the old set, fails and isn't cached
+    std::vector<sigma::PrivateCoin> coins2 = GenerateCoins(2);
+    BOOST_REQUIRE(ConnectMints(&index2, GetPublicCoins(coins2)));
+    BOOST_REQUIRE(sigmaState->GetAnonymitySetHash(denomination, 1, hash2) == hash2);
+    uint256 entry2 = GetCacheEntry(tx, hash2, 1, hash2, true);
+    BOOST_CHECK(!CheckSpend(tx));
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(entry2));
+
+    sigma::CSigmaTxInfo sigmaTxInfo;
+    BOOST_CHECK(CheckSpend(tx, &sigmaTxInfo));
+    BOOST_CHECK_EQUAL(sigmaTxInfo.spendBatches.size(), 1);
+    BOOST_CHECK(!RunSpendChecks(sigmaTxInfo));
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(entry2));
+
+    // A spend whose signature doesn't match the transaction is never cached either
+    CMutableTransaction txChanged = BuildSpend(coins[1], mints1, hash1, true);
+    txChanged.vout[0].nValue = 2 * COIN;
+    CTransaction txInvalid = txChanged;
+    uint256 entryInvalid = GetCacheEntry(txInvalid, hash1, 1, hash1, true);
+    BOOST_CHECK(!CheckSpend(txInvalid));
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(entryInvalid));
+
+    sigma::CSigmaTxInfo sigmaTxInfo2;
+    BOOST_CHECK(CheckSpend(txInvalid, &sigmaTxInfo2));
+    BOOST_CHECK(!RunSpendChecks(sigmaTxInfo2));
+    BOOST_CHECK(!sigma::GetSigmaProofCache().Get(entryInvalid));
+
+    sigma::ClearUnsavedSigmaBlockIndexes();
+    sigmaState->Reset();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,278 @@
+#include "sigma.h"
+#include "chainparams.h"
+#include "main.h"
+#include "streams.h"
+#include "txdb.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(sigma_state_tests, TestingSetup)
+
+static std::vector<sigma::PublicCoin> GenerateMints(sigma::CoinDenomination denomination, int n)
+{
+    std::vector<sigma::PublicCoin> mints;
+    for (int i = 0; i < n; i++) {
+        GroupElement value;
+        value.randomize();
+        mints.push_back(sigma::PublicCoin(value, denomination));
+    }
+    return mints;
+}
+
+static bool ConnectMints(CBlockIndex *index, const std::vector<sigma::PublicCoin> &mints,
+    const std::vector<Scalar> &serials = std::vector<Scalar>())
+{
+    CBlock block;
+    block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
+    block.sigmaTxInfo->mints = mints;
+    for (const Scalar &serial : serials)
+        block.sigmaTxInfo->spentSerials[serial] = 0;
+    block.sigmaTxInfo->fInfoIsComplete = true;
+    CValidationState state;
+    return sigma::ConnectBlockSigma(state, Params(), index, &block);
+}
+
+// Writes sigma records of the connected blocks the way FlushStateToDisk does
+static bool FlushSigmaBlockIndexes()
+{
+    std::vector<std::pair<const CBlockIndex *, const CSigmaBlockIndex *> > vSigmaBlocks;
+    sigma::GetUnsavedSigmaBlockIndexes(vSigmaBlocks);
+    if (!pblocktree->WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo *> >(), 0,
+            std::vector<const CBlockIndex *>(), vSigmaBlocks))
+        return false;
+    sigma::ClearUnsavedSigmaBlockIndexes();
+    return true;
+}
+
+// Serializes the bytes of a stream as they are, to write hand made records to the database
+struct CRawValue
+{
+    const CDataStream &ss;
+
+    explicit CRawValue(const CDataStream &ssIn) : ss(ssIn) {}
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        return ss.size();
+    }
+    template<typename Stream>
+    void Serialize(Stream &s, int nType, int nVersion) const {
+        s.write(&ss[0], ss.size());
+    }
+};
+
+static void CheckAnonymitySet(sigma::CSigmaState *sigmaState, sigma::CoinDenomination denomination,
+    const CBlockIndex *index, const std::vector<sigma::PublicCoin> &expected)
+{
+    uint256 blockHash;
+    secp_primitives::AffineGroupElements coins;
+    BOOST_CHECK_EQUAL(sigmaState->GetAnonymitySet(denomination, 1, index->GetBlockHash(), blockHash, coins),
+        expected.size());
+    BOOST_CHECK(blockHash == index->GetBlockHash());
+    BOOST_REQUIRE_EQUAL(coins.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); i++)
+        BOOST_CHECK(coins.get(i) == expected[i].getValue());
+}
+
+BOOST_AUTO_TEST_CASE(sigma_connect_block_mints)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    sigmaState->Reset();
+
+    uint256 hash1 = uint256S("0x01"), hash2 = uint256S("0x02");
+    CBlockIndex index1, index2;
+    index1.phashBlock = &hash1;
+    index1.nHeight = 1;
+    index2.phashBlock = &hash2;
+    index2.nHeight = 2;
+    index2.pprev = &index1;
+
+    // Several mints of the same denomination in a block are added to the group together
+    std::vector<sigma::PublicCoin> mints1 = GenerateMints(sigma::CoinDenomination::SIGMA_DENOM_1, 3);
+    std::vector<sigma::PublicCoin> mints10 = GenerateMints(sigma::CoinDenomination::SIGMA_DENOM_10, 2);
+    std::vector<sigma::PublicCoin> block1Mints = {mints1[0], mints10[0], mints1[1], mints1[2], mints10[1]};
+    BOOST_REQUIRE(ConnectMints(&index1, block1Mints));
+
+    sigma::CSigmaState::SigmaCoinGroupInfo group;
+    BOOST_REQUIRE(sigmaState->GetCoinGroupInfo(sigma::CoinDenomination::SIGMA_DENOM_1, 1, group));
+    BOOST_CHECK_EQUAL(group.nCoins, 3);
+    BOOST_CHECK(group.firstBlock == &index1);
+    BOOST_CHECK(group.lastBlock == &index1);
+    CheckAnonymitySet(sigmaState, sigma::CoinDenomination::SIGMA_DENOM_1, &index1, mints1);
+    CheckAnonymitySet(sigmaState, sigma::CoinDenomination::SIGMA_DENOM_10, &index1, mints10);
+
+    for (const sigma::PublicCoin &mint : block1Mints) {
+        BOOST_CHECK(sigmaState->HasCoin(mint));
+        BOOST_CHECK(sigmaState->GetMintedCoinHeightAndId(mint) == std::make_pair(1, 1));
+    }
+
+    CSigmaBlockIndex sigmaIndex;
+    BOOST_REQUIRE(FlushSigmaBlockIndexes());
+    BOOST_REQUIRE(pblocktree->ReadSigmaBlockIndex(hash1, sigmaIndex));
+    BOOST_CHECK(sigmaIndex.mintedPubCoins[std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_1, 1)] == mints1);
+    BOOST_CHECK(sigmaIndex.mintedPubCoins[std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_10, 1)] == mints10);
+
+    // The anonymity set starts with the coins of the latest block
+    std::vector<sigma::PublicCoin> block2Mints = GenerateMints(sigma::CoinDenomination::SIGMA_DENOM_1, 2);
+    BOOST_REQUIRE(ConnectMints(&index2, block2Mints));
+
+    BOOST_REQUIRE(sigmaState->GetCoinGroupInfo(sigma::CoinDenomination::SIGMA_DENOM_1, 1, group));
+    BOOST_CHECK_EQUAL(group.nCoins, 5);
+    BOOST_CHECK(group.firstBlock == &index1);
+    BOOST_CHECK(group.lastBlock == &index2);
+
+    std::vector<sigma::PublicCoin> expected = block2Mints;
+    expected.insert(expected.end(), mints1.begin(), mints1.end());
+    CheckAnonymitySet(sigmaState, sigma::CoinDenomination::SIGMA_DENOM_1, &index2, expected);
+    CheckAnonymitySet(sigmaState, sigma::CoinDenomination::SIGMA_DENOM_1, &index1, mints1);
+
+    sigmaState->Reset();
+}
+
+BOOST_AUTO_TEST_CASE(sigma_block_index_connect_disconnect)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    sigmaState->Reset();
+
+    int nStartBlock = Params().GetConsensus().nSigmaStartBlock;
+    uint256 hash1 = uint256S("0x01"), hash2 = uint256S("0x02");
+    CBlockIndex index1, index2;
+    index1.phashBlock = &hash1;
+    index1.nHeight = nStartBlock;
+    index2.phashBlock = &hash2;
+    index2.nHeight = nStartBlock + 1;
+    index2.pprev = &index1;
+
+    std::vector<sigma::PublicCoin> mints1 = GenerateMints(sigma::CoinDenomination::SIGMA_DENOM_1, 2);
+    std::vector<sigma::PublicCoin> mints2 = GenerateMints(sigma::CoinDenomination::SIGMA_DENOM_1, 3);
+    Scalar serial;
+    serial.randomize();
+    BOOST_REQUIRE(ConnectMints(&index1, mints1));
+    BOOST_REQUIRE(ConnectMints(&index2, mints2, {serial}));
+
+    // Records are only written with the block index
+    CSigmaBlockIndex sigmaIndex;
+    BOOST_CHECK(!pblocktree->ReadSigmaBlockIndex(hash2, sigmaIndex));
+    BOOST_REQUIRE(FlushSigmaBlockIndexes());
+
+    BOOST_REQUIRE(pblocktree->ReadSigmaBlockIndex(hash2, sigmaIndex));
+    BOOST_CHECK(sigmaIndex.mintedPubCoins[std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_1, 1)] == mints2);
+    BOOST_REQUIRE_EQUAL(sigmaIndex.spentSerials.size(), 1);
+    BOOST_CHECK(sigmaIndex.spentSerials[0] == serial);
+
+    std::set<uint256> blockHashes;
+    BOOST_REQUIRE(pblocktree->ReadSigmaBlockIndexHashes(blockHashes));
+    BOOST_CHECK_EQUAL(blockHashes.size(), 2);
+    BOOST_CHECK(blockHashes.count(hash1) && blockHashes.count(hash2));
+
+    // Coin group entries are iterated in chain order
+    std::vector<std::pair<CSigmaCoinGroupKey, std::vector<sigma::PublicCoin> > > groupEntries;
+    BOOST_REQUIRE(pblocktree->ReadSigmaCoinGroup(sigma::CoinDenomination::SIGMA_DENOM_1, 1, groupEntries));
+    BOOST_REQUIRE_EQUAL(groupEntries.size(), 2);
+    BOOST_CHECK(groupEntries[0].first.blockHash == hash1);
+    BOOST_CHECK_EQUAL(groupEntries[0].first.nHeight, nStartBlock);
+    BOOST_CHECK(groupEntries[0].second == mints1);
+    BOOST_CHECK(groupEntries[1].first.blockHash == hash2);
+    BOOST_CHECK(groupEntries[1].second == mints2);
+
+    groupEntries.clear();
+    BOOST_REQUIRE(pblocktree->ReadSigmaCoinGroup(sigma::CoinDenomination::SIGMA_DENOM_10, 1, groupEntries));
+    BOOST_CHECK(groupEntries.empty());
+
+    std::vector<std::pair<uint256, int> > spendingBlocks;
+    BOOST_REQUIRE(pblocktree->ReadSigmaSpentSerial(serial, spendingBlocks));
+    BOOST_REQUIRE_EQUAL(spendingBlocks.size(), 1);
+    BOOST_CHECK(spendingBlocks[0].first == hash2);
+    BOOST_CHECK_EQUAL(spendingBlocks[0].second, nStartBlock + 1);
+
+    // Disconnecting the tip rolls back its mints and spends from the record
+    CBlock block2;
+    sigma::DisconnectTipSigma(block2, &index2);
+    BOOST_CHECK(!sigmaState->IsUsedCoinSerial(serial));
+    for (const sigma::PublicCoin &mint : mints2)
+        BOOST_CHECK(!sigmaState->HasCoin(mint));
+    sigma::CSigmaState::SigmaCoinGroupInfo group;
+    BOOST_REQUIRE(sigmaState->GetCoinGroupInfo(sigma::CoinDenomination::SIGMA_DENOM_1, 1, group));
+    BOOST_CHECK_EQUAL(group.nCoins, 2);
+    BOOST_CHECK(group.lastBlock == &index1);
+    CheckAnonymitySet(sigmaState, sigma::CoinDenomination::SIGMA_DENOM_1, &index1, mints1);
+
+    // and the state is rebuilt from the records alone
+    sigmaState->Reset();
+    sigmaState->AddBlock(&index1);
+    sigmaState->AddBlock(&index2);
+    BOOST_CHECK(sigmaState->IsUsedCoinSerial(serial));
+    std::vector<sigma::PublicCoin> expected = mints2;
+    expected.insert(expected.end(), mints1.begin(), mints1.end());
+    CheckAnonymitySet(sigmaState, sigma::CoinDenomination::SIGMA_DENOM_1, &index2, expected);
+
+    sigmaState->Reset();
+}
+
+BOOST_AUTO_TEST_CASE(sigma_block_index_migration)
+{
+    sigma::CSigmaState *sigmaState = sigma::CSigmaState::GetState();
+    sigmaState->Reset();
+
+    CBlockIndex legacy;
+    legacy.nHeight = Params().GetConsensus().nSigmaStartBlock;
+    legacy.nTime = 1;
+    uint256 hash = CDiskBlockIndex(&legacy).GetBlockHash();
+
+    std::map<std::pair<sigma::CoinDenomination, int>, std::vector<sigma::PublicCoin> > sigmaMintedPubCoins;
+    sigmaMintedPubCoins[std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_1, 1)] =
+        GenerateMints(sigma::CoinDenomination::SIGMA_DENOM_1, 2);
+    std::unordered_set<Scalar, sigma::CScalarHash> sigmaSpentSerials;
+    Scalar serial;
+    serial.randomize();
+    sigmaSpentSerials.insert(serial);
+
+    // Block index record as written before sigma entries moved to records of their own
+    int nVersion = ZC_ADVANCED_INDEX_VERSION_CHAIN;
+    uint256 hashPrev;
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << VARINT(nVersion) << VARINT(legacy.nHeight) << VARINT(legacy.nStatus) << VARINT(legacy.nTx);
+    ss << legacy.nVersion << hashPrev << legacy.hashMerkleRoot << legacy.nTime << legacy.nBits << legacy.nNonce;
+    ss << legacy.mintedPubCoins << legacy.accumulatorChanges << legacy.spentSerials;
+    ss << sigmaMintedPubCoins << sigmaSpentSerials;
+    BOOST_REQUIRE(pblocktree->Write(std::make_pair('b', hash), CRawValue(ss)));
+
+    std::map<uint256, CBlockIndex *> blockIndexes;
+    BOOST_REQUIRE(pblocktree->LoadBlockIndexGuts([&blockIndexes](const uint256 &blockHash) -> CBlockIndex * {
+        if (blockHash.IsNull())
+            return NULL;
+        CBlockIndex *&index = blockIndexes[blockHash];
+        if (index == NULL)
+            index = new CBlockIndex();
+        return index;
+    }));
+    BOOST_CHECK_EQUAL(blockIndexes.size(), 1);
+
+    CSigmaBlockIndex sigmaIndex;
+    BOOST_REQUIRE(pblocktree->ReadSigmaBlockIndex(hash, sigmaIndex));
+    BOOST_CHECK(sigmaIndex.mintedPubCoins == sigmaMintedPubCoins);
+    BOOST_REQUIRE_EQUAL(sigmaIndex.spentSerials.size(), 1);
+    BOOST_CHECK(sigmaIndex.spentSerials[0] == serial);
+
+    std::vector<std::pair<CSigmaCoinGroupKey, std::vector<sigma::PublicCoin> > > groupEntries;
+    BOOST_REQUIRE(pblocktree->ReadSigmaCoinGroup(sigma::CoinDenomination::SIGMA_DENOM_1, 1, groupEntries));
+    BOOST_REQUIRE_EQUAL(groupEntries.size(), 1);
+    BOOST_CHECK(groupEntries[0].first.blockHash == hash);
+
+    std::vector<std::pair<uint256, int> > spendingBlocks;
+    BOOST_REQUIRE(pblocktree->ReadSigmaSpentSerial(serial, spendingBlocks));
+    BOOST_CHECK_EQUAL(spendingBlocks.size(), 1);
+
+    // The block index record is rewritten without sigma entries, at a version older binaries refuse
+    CDiskBlockIndex diskindex;
+    BOOST_REQUIRE(pblocktree->Read(std::make_pair('b', hash), diskindex));
+    BOOST_CHECK(diskindex.GetBlockHash() == hash);
+    BOOST_CHECK(diskindex.nDiskBlockVersion >= SIGMA_BLOCK_INDEX_VERSION);
+    BOOST_CHECK(diskindex.sigmaMintedPubCoins.empty());
+    BOOST_CHECK(diskindex.sigmaSpentSerials.empty());
+
+    for (std::map<uint256, CBlockIndex *>::iterator it = blockIndexes.begin(); it != blockIndexes.end(); it++)
+        delete it->second;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+#include "taskpool.h"
+#include "test/test_bitcoin.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(taskpool_tests, BasicTestingSetup)
+
+static void CheckNestedWork()
+{
+    // Every range of the outer loop splits its work again, as a sigma verify inside a block connect would
+    std::atomic<uint64_t> nSum(0);
+    ParallelFor(0, 64, 1, [&nSum](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            ParallelFor(0, 1000, 10, [&nSum, i](size_t begin2, size_t end2) {
+                uint64_t nPart = 0;
+                for (size_t j = begin2; j < end2; j++)
+                    nPart += i * j;
+                nSum += nPart;
+            });
+        }
+    });
+    BOOST_CHECK_EQUAL(nSum.load(), (uint64_t)(63 * 64 / 2) * (999 * 1000 / 2));
+
+    // Groups nested deeper than there are threads
+    std::atomic<int> nLeaves(0);
+    std::function<void(int)> fork = [&](int nDepth) {
+        if (nDepth == 0) {
+            nLeaves++;
+            return;
+        }
+        CTaskGroup group;
+        for (int i = 0; i < 4; i++)
+            group.Run([&fork, nDepth] { fork(nDepth - 1); });
+        group.Wait();
+    };
+    fork(5);
+    BOOST_CHECK_EQUAL(nLeaves.load(), 1024);
+}
+
+BOOST_AUTO_TEST_CASE(taskpool_nested)
+{
+    CheckNestedWork();
+    taskPool.Start(3);
+    BOOST_CHECK_EQUAL(taskPool.GetThreadCount(), 3);
+    CheckNestedWork();
+    taskPool.Stop();
+    BOOST_CHECK_EQUAL(taskPool.GetThreadCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(taskpool_exceptions)
+{
+    taskPool.Start(3);
+    CTaskGroup group;
+    std::atomic<int> nRun(0);
+    for (int i = 0; i < 20; i++) {
+        group.Run([i, &nRun] {
+            nRun++;
+            if (i == 7)
+                throw std::runtime_error("task failed");
+        });
+    }
+    BOOST_CHECK_THROW(group.Wait(), std::runtime_error);
+    BOOST_CHECK_EQUAL(nRun.load(), 20);
+
+    // The group can be used again once the error was reported
+    group.Run([&nRun] { nRun++; });
+    group.Wait();
+    BOOST_CHECK_EQUAL(nRun.load(), 21);
+    taskPool.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(taskpool_restart)
+{
+    // Tasks keep coming from another thread while the pool restarts with other thread counts
+    std::atomic<bool> fDone(false);
+    std::atomic<int> nSubmitted(0), nRun(0), nWrongSums(0);
+    std::thread submitter([&] {
+        while (!fDone) {
+            taskPool.Submit([&nRun] { nRun++; });
+            nSubmitted++;
+            std::atomic<uint64_t> nSum(0);
+            ParallelFor(0, 100, 10, [&nSum](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    nSum += i;
+            });
+            if (nSum != 4950)
+                nWrongSums++;
+        }
+    });
+    for (int i = 0; i < 50; i++) {
+        taskPool.Start(1 + i % 4);
+        taskPool.Stop();
+    }
+    taskPool.Start(CTaskPool::MAX_THREADS + 4);
+    BOOST_CHECK_EQUAL(taskPool.GetThreadCount(), CTaskPool::MAX_THREADS);
+    fDone = true;
+    submitter.join();
+
+    // Nothing submitted is lost with the workers
+    taskPool.Stop();
+    BOOST_CHECK_EQUAL(nRun.load(), nSubmitted.load());
+    BOOST_CHECK_EQUAL(nWrongSums.load(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -14,6 +14,7 @@
 #include "miner.h"
 #include "pubkey.h"
 #include "random.h"
+#include "taskpool.h"
 #include "txdb.h"
 #include "txmempool.h"
 #include "ui_interface.h"
@@ -66,8 +67,7 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
             BOOST_CHECK(ok);
         }
         nScriptCheckThreads = 3;
-        for (int i=0; i < nScriptCheckThreads-1; i++)
-            threadGroup.create_thread(&ThreadScriptCheck);
+        taskPool.Start(nScriptCheckThreads - 1);
         RegisterNodeSignals(GetNodeSignals());
 }
 
@@ -76,6 +76,7 @@ TestingSetup::~TestingSetup()
         UnregisterNodeSignals(GetNodeSignals());
         threadGroup.interrupt_all();
         threadGroup.join_all();
+        taskPool.Stop();
         UnloadBlockIndex();
         delete pcoinsTip;
         delete pcoinsdbview;
@@ -118,7 +119,7 @@ TestChain100Setup::CreateAndProcessBlock(const std::vector<CMutableTransaction>&
     while (!CheckProofOfWork(block.GetHash(), block.nBits, chainparams.GetConsensus())) ++block.nNonce;
 
     CValidationState state;
-    ProcessNewBlock(state, chainparams, NULL, &block, true, NULL, false);
+    ProcessNewBlock(state, chainparams, NULL, std::make_shared<const CBlock>(block), true, NULL, false);
 
     CBlock result = block;
     delete pblocktemplate;
@@ -25,6 +25,10 @@ static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
 static const char DB_BLOCK_INDEX = 'b';
+static const char DB_SIGMA_BLOCK_INDEX = 'g';
+static const char DB_SIGMA_COIN_GROUP = 'G';
+static const char DB_SIGMA_SPENT_SERIAL = 'S';
+static const char DB_ALTERNATIVE_ACCUMULATOR_CHANGES = 'z';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_FLAG = 'F';
@@ -141,7 +145,20 @@ void CCoinsViewDBCursor::Next()
         keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
 }
 
-bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
+// Writes the sigma record of a block along with its entries in the coin group and spent serial indexes
+static void WriteSigmaBlockIndex(CDBBatch &batch, const uint256 &blockHash, int nHeight, const CSigmaBlockIndex &sigmaIndex) {
+    batch.Write(make_pair(DB_SIGMA_BLOCK_INDEX, blockHash), sigmaIndex);
+    for (std::map<std::pair<sigma::CoinDenomination, int>, std::vector<sigma::PublicCoin> >::const_iterator it=sigmaIndex.mintedPubCoins.begin(); it != sigmaIndex.mintedPubCoins.end(); it++) {
+        CSigmaCoinGroupKey key(it->first.first, it->first.second, nHeight, blockHash);
+        batch.Write(make_pair(DB_SIGMA_COIN_GROUP, key), it->second);
+    }
+    for (std::vector<secp_primitives::Scalar>::const_iterator it=sigmaIndex.spentSerials.begin(); it != sigmaIndex.spentSerials.end(); it++) {
+        batch.Write(make_pair(DB_SIGMA_SPENT_SERIAL, make_pair(*it, blockHash)), nHeight);
+    }
+}
+
+bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                                  const std::vector<std::pair<const CBlockIndex*, const CSigmaBlockIndex*> >& sigmaInfo) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<int, const CBlockFileInfo*> >::const_iterator it=fileInfo.begin(); it != fileInfo.end(); it++) {
         batch.Write(make_pair(DB_BLOCK_FILES, it->first), *it->second);
@@ -150,6 +167,9 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
     	batch.Write(make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
     }
+    for (std::vector<std::pair<const CBlockIndex*, const CSigmaBlockIndex*> >::const_iterator it=sigmaInfo.begin(); it != sigmaInfo.end(); it++) {
+        WriteSigmaBlockIndex(batch, it->first->GetBlockHash(), it->first->nHeight, *it->second);
+    }
     return WriteBatch(batch, true);
 }
 
@@ -306,11 +326,95 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+bool CBlockTreeDB::ReadSigmaBlockIndex(const uint256 &blockHash, CSigmaBlockIndex &sigmaIndex) {
+    return Read(make_pair(DB_SIGMA_BLOCK_INDEX, blockHash), sigmaIndex);
+}
+
+bool CBlockTreeDB::ReadSigmaBlockIndexHashes(std::set<uint256> &blockHashes) {
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(make_pair(DB_SIGMA_BLOCK_INDEX, uint256()));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, uint256> key;
+        if (pcursor->GetKey(key) && key.first == DB_SIGMA_BLOCK_INDEX) {
+            blockHashes.insert(key.second);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CBlockTreeDB::ReadSigmaCoinGroup(sigma::CoinDenomination denomination, int id,
+                                      std::vector<std::pair<CSigmaCoinGroupKey, std::vector<sigma::PublicCoin> > > &entries) {
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(make_pair(DB_SIGMA_COIN_GROUP, CSigmaCoinGroupKey(denomination, id, 0, uint256())));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CSigmaCoinGroupKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_SIGMA_COIN_GROUP && key.second.denomination == denomination && key.second.id == id) {
+            std::vector<sigma::PublicCoin> coins;
+            if (!pcursor->GetValue(coins))
+                return error("failed to get sigma coin group value");
+            entries.push_back(make_pair(key.second, coins));
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CBlockTreeDB::ReadSigmaSpentSerial(const secp_primitives::Scalar &serial, std::vector<std::pair<uint256, int> > &blocks) {
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(make_pair(DB_SIGMA_SPENT_SERIAL, make_pair(serial, uint256())));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, std::pair<secp_primitives::Scalar, uint256> > key;
+        if (pcursor->GetKey(key) && key.first == DB_SIGMA_SPENT_SERIAL && key.second.first == serial) {
+            int nHeight;
+            if (!pcursor->GetValue(nHeight))
+                return error("failed to get sigma spent serial value");
+            blocks.push_back(make_pair(key.second.second, nHeight));
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CBlockTreeDB::WriteAlternativeAccumulatorChanges(const std::vector<const CBlockIndex*> &blocks) {
+    CDBBatch batch(*this);
+    for (std::vector<const CBlockIndex*>::const_iterator it=blocks.begin(); it != blocks.end(); it++) {
+        batch.Write(make_pair(DB_ALTERNATIVE_ACCUMULATOR_CHANGES, (*it)->GetBlockHash()), (*it)->alternativeAccumulatorChanges);
+    }
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadAlternativeAccumulatorChanges(const uint256 &blockHash, std::map<std::pair<int,int>, std::pair<CBigNum,int> > &changes) {
+    return Read(make_pair(DB_ALTERNATIVE_ACCUMULATOR_CHANGES, blockHash), changes);
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
     LogPrintf("CBlockTreeDB::LoadBlockIndexGuts\n");
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
+    // Sigma entries found in block index records are moved to their own records
+    CDBBatch sigmaBatch(*this);
+    int nSigmaMigrated = 0;
+
     pcursor->Seek(make_pair(DB_BLOCK_INDEX, uint256()));
 
     // Load mapBlockIndex
@@ -339,12 +443,18 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
                 pindexNew->mintedPubCoins     = diskindex.mintedPubCoins;
                 pindexNew->spentSerials       = diskindex.spentSerials;
 
-                pindexNew->sigmaMintedPubCoins   = diskindex.sigmaMintedPubCoins;
-                pindexNew->sigmaSpentSerials     = diskindex.sigmaSpentSerials;
-
                 if (diskindex.IsProofOfStake()){
                     pindexNew->nStakeModifier = diskindex.nStakeModifier;
                 }
+
+                if (!diskindex.sigmaMintedPubCoins.empty() || !diskindex.sigmaSpentSerials.empty()) {
+                    CSigmaBlockIndex sigmaIndex;
+                    sigmaIndex.mintedPubCoins = diskindex.sigmaMintedPubCoins;
+                    sigmaIndex.spentSerials.assign(diskindex.sigmaSpentSerials.begin(), diskindex.sigmaSpentSerials.end());
+                    WriteSigmaBlockIndex(sigmaBatch, key.second, pindexNew->nHeight, sigmaIndex);
+                    sigmaBatch.Write(make_pair(DB_BLOCK_INDEX, key.second), CDiskBlockIndex(pindexNew));
+                    nSigmaMigrated++;
+                }
 /*
                 if (!CheckProofOfWork(pindexNew->GetBlockPoWHash(), pindexNew->nBits, Params().GetConsensus(),pindexNew->nHeight))
                     if(pindexNew->nHeight > 233000 || pindexNew->nHeight != INT_MAX)
@@ -359,6 +469,12 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
         }
     }
 
+    if (nSigmaMigrated > 0) {
+        LogPrintf("LoadBlockIndex(): moving sigma entries of %d blocks to the sigma index\n", nSigmaMigrated);
+        if (!WriteBatch(sigmaBatch, true))
+            return error("LoadBlockIndex() : failed to write sigma index");
+    }
+
     return true;
 }
 
@@ -12,6 +12,7 @@
 #include "spentindex.h"
 
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -115,7 +116,8 @@ private:
     CBlockTreeDB(const CBlockTreeDB&);
     void operator=(const CBlockTreeDB&);
 public:
-    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
+    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                        const std::vector<std::pair<const CBlockIndex*, const CSigmaBlockIndex*> >& sigmaInfo);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &fileinfo);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
@@ -136,6 +138,17 @@ public:
     bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
+    bool ReadSigmaBlockIndex(const uint256 &blockHash, CSigmaBlockIndex &sigmaIndex);
+    //! Hashes of all the blocks having a sigma record, read from the keys alone
+    bool ReadSigmaBlockIndexHashes(std::set<uint256> &blockHashes);
+    //! Coins added to the coin group by every block that had them in the chain, in order of height.
+    //! Blocks since disconnected are included.
+    bool ReadSigmaCoinGroup(sigma::CoinDenomination denomination, int id,
+                            std::vector<std::pair<CSigmaCoinGroupKey, std::vector<sigma::PublicCoin> > > &entries);
+    //! Hashes and heights of the blocks spending the serial, blocks since disconnected are included
+    bool ReadSigmaSpentSerial(const secp_primitives::Scalar &serial, std::vector<std::pair<uint256, int> > &blocks);
+    bool WriteAlternativeAccumulatorChanges(const std::vector<const CBlockIndex*> &blocks);
+    bool ReadAlternativeAccumulatorChanges(const uint256 &blockHash, std::map<std::pair<int,int>, std::pair<CBigNum,int> > &changes);
     bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
     int GetBlockIndexVersion();
 };
@@ -3438,7 +3438,7 @@ UniValue resetsigmamint(const UniValue& params, bool fHelp) {
 
     list <CSigmaEntry> listPubcoin;
     CWalletDB walletdb(pwalletMain->strWalletFile);
-    walletdb.ListSigmaPubCoin(listPubcoin);
+    pwalletMain->ListSigmaMints(listPubcoin);
 
     BOOST_FOREACH(const CSigmaEntry &zerocoinItem, listPubcoin){
         if (zerocoinItem.randomness != uint64_t(0) && zerocoinItem.serialNumber != uint64_t(0)) {
@@ -3450,7 +3450,7 @@ UniValue resetsigmamint(const UniValue& params, bool fHelp) {
             zerocoinTx.nHeight = -1;
             zerocoinTx.randomness = zerocoinItem.randomness;
 //            zerocoinTx.ecdsaSecretKey = zerocoinItem.ecdsaSecretKey;
-            walletdb.WriteZerocoinEntry(zerocoinTx);
+            pwalletMain->WriteSigmaEntry(walletdb, zerocoinTx);
         }
     }
 
@@ -3508,8 +3508,7 @@ UniValue listsigmamints(const UniValue& params, bool fHelp) {
     }
 
     list <CSigmaEntry> listPubcoin;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    walletdb.ListSigmaPubCoin(listPubcoin);
+    pwalletMain->ListSigmaMints(listPubcoin);
     UniValue results(UniValue::VARR);
 
     BOOST_FOREACH(const CSigmaEntry &zerocoinItem, listPubcoin) {
@@ -3587,8 +3586,7 @@ UniValue listsigmapubcoins(const UniValue& params, bool fHelp) {
     }
 
     list<CSigmaEntry> listPubcoin;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    walletdb.ListSigmaPubCoin(listPubcoin);
+    pwalletMain->ListSigmaMints(listPubcoin);
     UniValue results(UniValue::VARR);
     listPubcoin.sort(CompSigmaHeight);
 
@@ -3690,7 +3688,7 @@ UniValue setsigmamintstatus(const UniValue& params, bool fHelp) {
 
     list <CSigmaEntry> listPubcoin;
     CWalletDB walletdb(pwalletMain->strWalletFile);
-    walletdb.ListSigmaPubCoin(listPubcoin);
+    pwalletMain->ListSigmaMints(listPubcoin);
 
     UniValue results(UniValue::VARR);
 
@@ -3713,7 +3711,7 @@ UniValue setsigmamintstatus(const UniValue& params, bool fHelp) {
                     ? "Used (" + std::to_string((double)zerocoinTx.get_denomination_value() / COIN) + " mint)"
                     : "New (" + std::to_string((double)zerocoinTx.get_denomination_value() / COIN) + " mint)";
                 pwalletMain->NotifyZerocoinChanged(pwalletMain, zerocoinTx.value.GetHex(), isUsedDenomStr, CT_UPDATED);
-                walletdb.WriteZerocoinEntry(zerocoinTx);
+                pwalletMain->WriteSigmaEntry(walletdb, zerocoinTx);
 
                 if (!fStatus) {
                     // erase zerocoin spend entry
@@ -3,8 +3,6 @@
 
 #include "../primitives/transaction.h"
 
-#include "../sigma/coin.h"
-#include "../sigma/coinspend.h"
 #include "../sigma/spend_metadata.h"
 
 #include "../main.h"
@@ -14,47 +12,35 @@
 #include "../version.h"
 #include "../sigma.h"
 
+#include <map>
 #include <stdexcept>
 #include <tuple>
 
-class SigmaSpendSigner : public InputSigner
+SigmaSpendSigner::SigmaSpendSigner(const sigma::PrivateCoin& coin) : coin(coin)
 {
-public:
-    const sigma::PrivateCoin coin;
-    std::vector<sigma::PublicCoin> group;
-    uint256 lastBlockOfGroup;
-    bool fPadding;
-
-public:
-    SigmaSpendSigner(const sigma::PrivateCoin& coin) : coin(coin)
-    {
-        fPadding = true;
-    }
-
-    CScript Sign(const CMutableTransaction& tx, const uint256& sig) override
-    {
-        // construct spend
-        sigma::SpendMetaData meta(output.n, lastBlockOfGroup, sig);
-        sigma::CoinSpend spend(coin.getParams(), coin, group, meta, fPadding);
+    fPadding = true;
+}
 
-        spend.setVersion(coin.getVersion());
+CScript SigmaSpendSigner::Sign(const CMutableTransaction& tx, const uint256& sig)
+{
+    // construct spend
+    sigma::SpendMetaData meta(output.n, lastBlockOfGroup, sig);
+    spend.reset(new sigma::CoinSpend(coin.getParams(), coin, group, meta, fPadding));
 
-        if (!spend.Verify(group, meta, fPadding)) {
-            throw std::runtime_error(_("The spend coin transaction failed to verify"));
-        }
+    spend->setVersion(coin.getVersion());
 
-        // construct spend script
-        CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
-        serialized << spend;
+    // construct spend script, the spend is verified by SigmaSpendBuilder::CheckSigned together with the
+    // other spends of the transaction
+    CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+    serialized << *spend;
 
-        CScript script;
+    CScript script;
 
-        script << OP_SIGMASPEND;
-        script.insert(script.end(), serialized.begin(), serialized.end());
+    script << OP_SIGMASPEND;
+    script.insert(script.end(), serialized.begin(), serialized.end());
 
-        return script;
-    }
-};
+    return script;
+}
 
 static std::unique_ptr<SigmaSpendSigner> CreateSigner(const CSigmaEntry& coin)
 {
@@ -200,3 +186,43 @@ CAmount SigmaSpendBuilder::GetChanges(std::vector<CTxOut>& outputs, CAmount amou
 
     return amount;
 }
+
+void SigmaSpendBuilder::CheckSigned(const uint256& sig, const std::vector<std::unique_ptr<InputSigner>>& signers)
+{
+    if (!GetBoolArg("-sigmaspendcheck", DEFAULT_SIGMA_SPEND_CHECK)) {
+        return;
+    }
+
+    // spends from the same coin group share the anonymity set, so each group is verified as one batch
+    std::map<std::tuple<sigma::CoinDenomination, uint32_t, bool>, std::vector<const SigmaSpendSigner*>> batches;
+
+    for (auto& signer : signers) {
+        auto sigmaSigner = static_cast<const SigmaSpendSigner*>(signer.get());
+        auto denom = sigmaSigner->coin.getPublicCoin().getDenomination();
+
+        batches[std::make_tuple(denom, sigmaSigner->output.n, sigmaSigner->fPadding)].push_back(sigmaSigner);
+    }
+
+    for (auto& batch : batches) {
+        auto& batchSigners = batch.second;
+
+        std::vector<secp_primitives::GroupElement> values;
+        values.reserve(batchSigners[0]->group.size());
+
+        for (auto& pub : batchSigners[0]->group) {
+            values.push_back(pub.getValue());
+        }
+
+        std::vector<const sigma::CoinSpend*> spends;
+        std::vector<sigma::SpendMetaData> metadata;
+
+        for (auto signer : batchSigners) {
+            spends.push_back(signer->spend.get());
+            metadata.push_back(sigma::SpendMetaData(signer->output.n, signer->lastBlockOfGroup, sig));
+        }
+
+        if (!sigma::CoinSpend::BatchVerify(secp_primitives::AffineGroupElements(values), spends, metadata, std::get<2>(batch.first))) {
+            throw std::runtime_error(_("The spend coin transaction failed to verify"));
+        }
+    }
+}
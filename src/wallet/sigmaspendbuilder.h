@@ -3,8 +3,27 @@
 
 #include "txbuilder.h"
 
+#include "../sigma/coin.h"
+#include "../sigma/coinspend.h"
+
+#include <memory>
 #include <vector>
 
+class SigmaSpendSigner : public InputSigner
+{
+public:
+    const sigma::PrivateCoin coin;
+    std::vector<sigma::PublicCoin> group;
+    uint256 lastBlockOfGroup;
+    bool fPadding;
+    std::unique_ptr<sigma::CoinSpend> spend;
+
+public:
+    SigmaSpendSigner(const sigma::PrivateCoin& coin);
+
+    CScript Sign(const CMutableTransaction& tx, const uint256& sig) override;
+};
+
 class SigmaSpendBuilder : public TxBuilder
 {
 public:
@@ -19,6 +38,7 @@ public:
 protected:
     CAmount GetInputs(std::vector<std::unique_ptr<InputSigner>>& signers, CAmount required) override;
     CAmount GetChanges(std::vector<CTxOut>& outputs, CAmount amount) override;
+    void CheckSigned(const uint256& sig, const std::vector<std::unique_ptr<InputSigner>>& signers) override;
 };
 
 #endif
@@ -0,0 +1,82 @@
+#include "wallet/sigmaspendbuilder.h"
+
+#include "main.h"
+#include "streams.h"
+#include "util.h"
+#include "version.h"
+
+#include "wallet/test/wallet_test_fixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+// Exposes the signing steps of the builder, so spends can be signed without coins in the chain
+class TestSigmaSpendBuilder : public SigmaSpendBuilder
+{
+public:
+    explicit TestSigmaSpendBuilder(CWallet& wallet) : SigmaSpendBuilder(wallet) {}
+
+    using TxBuilder::SignInputs;
+    using SigmaSpendBuilder::CheckSigned;
+};
+
+BOOST_FIXTURE_TEST_SUITE(sigmaspendbuilder_tests, WalletTestingSetup)
+
+BOOST_AUTO_TEST_CASE(sigmaspendbuilder_sign_and_check)
+{
+    auto params = sigma::Params::get_default();
+
+    std::vector<sigma::PrivateCoin> coins;
+    std::vector<sigma::PublicCoin> group;
+    for (int i = 0; i < 4; i++) {
+        coins.push_back(sigma::PrivateCoin(params, sigma::CoinDenomination::SIGMA_DENOM_1, ZEROCOIN_TX_VERSION_3));
+        group.push_back(coins.back().getPublicCoin());
+    }
+
+    // a spend of three coins of the same group
+    CMutableTransaction tx;
+    std::vector<std::unique_ptr<InputSigner>> signers;
+    for (int i = 0; i < 3; i++) {
+        std::unique_ptr<SigmaSpendSigner> signer(new SigmaSpendSigner(coins[i]));
+        signer->output.n = 1;
+        signer->group = group;
+        signer->lastBlockOfGroup = uint256S("0x0102");
+        signer->fPadding = false;
+        tx.vin.emplace_back(signer->output, CScript(), signer->sequence);
+        signers.push_back(std::move(signer));
+    }
+    uint256 sig = tx.GetHash();
+
+    TestSigmaSpendBuilder builder(*pwalletMain);
+    TestSigmaSpendBuilder::SignInputs(tx, sig, signers);
+
+    // inputs signed concurrently still get their own spend, in order
+    for (int i = 0; i < 3; i++) {
+        const CScript& script = tx.vin[i].scriptSig;
+        BOOST_REQUIRE(script.IsSigmaSpend());
+        CDataStream serialized(std::vector<unsigned char>(script.begin() + 1, script.end()), SER_NETWORK, PROTOCOL_VERSION);
+        sigma::CoinSpend spend(params, serialized);
+        BOOST_CHECK(spend.getCoinSerialNumber() == coins[i].getSerialNumber());
+    }
+
+    BOOST_CHECK_NO_THROW(builder.CheckSigned(sig, signers));
+    // spends signed for another transaction
+    BOOST_CHECK_THROW(builder.CheckSigned(uint256S("0x01"), signers), std::runtime_error);
+
+    // corrupt the proof of the second spend: flip a byte of the first f_ scalar, after B_, A_,
+    // C_, D_ and the size of f_
+    auto sigmaSigner = static_cast<SigmaSpendSigner*>(signers[1].get());
+    CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+    serialized << *sigmaSigner->spend;
+    serialized[4 * GroupElement::serialize_size + 1 + 5] ^= 1;
+    sigmaSigner->spend.reset(new sigma::CoinSpend(params, serialized));
+    BOOST_CHECK(sigmaSigner->spend->getCoinSerialNumber() == coins[1].getSerialNumber());
+
+    BOOST_CHECK_THROW(builder.CheckSigned(sig, signers), std::runtime_error);
+
+    // the check can be turned off
+    mapArgs["-sigmaspendcheck"] = "0";
+    BOOST_CHECK_NO_THROW(builder.CheckSigned(sig, signers));
+    mapArgs.erase("-sigmaspendcheck");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
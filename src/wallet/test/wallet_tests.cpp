@@ -351,4 +351,59 @@ BOOST_AUTO_TEST_CASE(ApproximateBestSubset)
     BOOST_CHECK_EQUAL(setCoinsRet.size(), 2U);
 }
 
+static CSigmaEntry make_sigma_mint(sigma::CoinDenomination denomination, int nHeight, bool fUsed)
+{
+    CSigmaEntry entry;
+    entry.value.randomize();
+    entry.set_denomination(denomination);
+    entry.nHeight = nHeight;
+    entry.IsUsed = fUsed;
+    return entry;
+}
+
+BOOST_AUTO_TEST_CASE(sigma_mint_cache)
+{
+    CWallet sigmaWallet;
+    LOCK(sigmaWallet.cs_wallet);
+
+    CSigmaEntry a = make_sigma_mint(sigma::CoinDenomination::SIGMA_DENOM_1, 10, false);
+    CSigmaEntry b = make_sigma_mint(sigma::CoinDenomination::SIGMA_DENOM_1, 5, false);
+    CSigmaEntry c = make_sigma_mint(sigma::CoinDenomination::SIGMA_DENOM_10, 7, true);
+    sigmaWallet.LoadSigmaEntry(a);
+    sigmaWallet.LoadSigmaEntry(b);
+    sigmaWallet.LoadSigmaEntry(c);
+
+    std::list<CSigmaEntry> mints;
+    sigmaWallet.ListSigmaMints(mints);
+    BOOST_CHECK_EQUAL(mints.size(), 3U);
+
+    // unused mints of a denomination come ordered by height
+    mints.clear();
+    sigmaWallet.ListSigmaMints(mints, false, sigma::CoinDenomination::SIGMA_DENOM_1);
+    BOOST_CHECK_EQUAL(mints.size(), 2U);
+    BOOST_CHECK(mints.front().value == b.value);
+    BOOST_CHECK(mints.back().value == a.value);
+
+    // a rewritten mint moves to its new place in the index
+    a.IsUsed = true;
+    sigmaWallet.LoadSigmaEntry(a);
+    BOOST_CHECK_EQUAL(sigmaWallet.mapSigmaMints.size(), 3U);
+    BOOST_CHECK_EQUAL(sigmaWallet.sigmaMintIndex.size(), 3U);
+
+    mints.clear();
+    sigmaWallet.ListSigmaMints(mints, false);
+    BOOST_CHECK_EQUAL(mints.size(), 1U);
+    BOOST_CHECK(mints.front().value == b.value);
+
+    mints.clear();
+    sigmaWallet.ListSigmaMints(mints, true);
+    BOOST_CHECK_EQUAL(mints.size(), 2U);
+
+    CSigmaEntry entry;
+    BOOST_CHECK(sigmaWallet.GetSigmaEntry(a.value, entry));
+    BOOST_CHECK(entry.IsUsed);
+    BOOST_CHECK(sigmaWallet.HaveSigmaEntry(c.value));
+    BOOST_CHECK(!sigmaWallet.HaveSigmaEntry(make_sigma_mint(sigma::CoinDenomination::SIGMA_DENOM_1, 1, false).value));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include "../policy/policy.h"
 #include "../random.h"
 #include "../script/script.h"
+#include "../taskpool.h"
 #include "../txmempool.h"
 #include "../uint256.h"
 #include "../util.h"
@@ -31,6 +32,25 @@ InputSigner::~InputSigner()
 {
 }
 
+// Signs all inputs, several at a time since an input signature can be expensive (a sigma spend is a proof
+// over the whole coin group). Signers only read the transaction, the scripts are put in once all are done.
+void TxBuilder::SignInputs(CMutableTransaction& tx, const uint256& sig, const std::vector<std::unique_ptr<InputSigner>>& signers)
+{
+    std::vector<CScript> scripts(signers.size());
+
+    CTaskGroup group;
+    for (size_t i = 0; i < signers.size(); i++) {
+        group.Run([&, i] {
+            scripts[i] = signers[i]->Sign(tx, sig);
+        });
+    }
+    group.Wait();
+
+    for (size_t i = 0; i < tx.vin.size(); i++) {
+        tx.vin[i].scriptSig = std::move(scripts[i]);
+    }
+}
+
 TxBuilder::TxBuilder(CWallet& wallet) noexcept : wallet(wallet)
 {
 }
@@ -206,9 +226,8 @@ CWalletTx TxBuilder::Build(const std::vector<CRecipient>& recipients, CAmount& f
         // now every fields is populated then we can sign transaction
         uint256 sig = tx.GetHash();
 
-        for (size_t i = 0; i < tx.vin.size(); i++) {
-            tx.vin[i].scriptSig = signers[i]->Sign(tx, sig);
-        }
+        SignInputs(tx, sig, signers);
+        CheckSigned(sig, signers);
 
         // check fee
         static_cast<CTransaction&>(result) = CTransaction(tx);
@@ -257,4 +276,8 @@ CWalletTx TxBuilder::Build(const std::vector<CRecipient>& recipients, CAmount& f
 CAmount TxBuilder::AdjustFee(CAmount needed, unsigned txSize)
 {
     return needed;
-}
\ No newline at end of file
+}
+
+void TxBuilder::CheckSigned(const uint256& sig, const std::vector<std::unique_ptr<InputSigner>>& signers)
+{
+}
@@ -43,6 +43,12 @@ protected:
     virtual CAmount GetInputs(std::vector<std::unique_ptr<InputSigner>>& signers, CAmount required) = 0;
     virtual CAmount GetChanges(std::vector<CTxOut>& outputs, CAmount amount) = 0;
     virtual CAmount AdjustFee(CAmount needed, unsigned txSize);
+
+    // Called once every input is signed, throws if the signatures are not acceptable
+    virtual void CheckSigned(const uint256& sig, const std::vector<std::unique_ptr<InputSigner>>& signers);
+
+    // Signs all inputs of tx, several at a time
+    static void SignInputs(CMutableTransaction& tx, const uint256& sig, const std::vector<std::unique_ptr<InputSigner>>& signers);
 };
 
 #endif
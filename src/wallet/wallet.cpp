@@ -26,6 +26,7 @@
 #include "primitives/transaction.h"
 #include "script/script.h"
 #include "script/sign.h"
+#include "taskpool.h"
 #include "timedata.h"
 #include "txmempool.h"
 #include "util.h"
@@ -248,6 +249,27 @@ bool CWallet::LoadKeyMetadata(const CPubKey &pubkey, const CKeyMetadata &meta) {
     return true;
 }
 
+void CWallet::LoadSigmaEntry(const CSigmaEntry& entry) {
+    AssertLockHeld(cs_wallet); // mapSigmaMints
+    auto it = mapSigmaMints.find(entry.value);
+    if (it != mapSigmaMints.end()) {
+        // drop the index record of the previous state of the mint
+        auto range = sigmaMintIndex.equal_range(
+            std::make_tuple(it->second.IsUsed, it->second.get_denomination_value(), it->second.nHeight));
+        for (auto i = range.first; i != range.second; ++i) {
+            if (i->second == entry.value) {
+                sigmaMintIndex.erase(i);
+                break;
+            }
+        }
+        it->second = entry;
+    } else {
+        mapSigmaMints.emplace(entry.value, entry);
+    }
+
+    sigmaMintIndex.emplace(std::make_tuple(entry.IsUsed, entry.get_denomination_value(), entry.nHeight), entry.value);
+}
+
 bool CWallet::LoadCryptedKey(const CPubKey &vchPubKey, const std::vector<unsigned char> &vchCryptedSecret) {
     return CCryptoKeyStore::AddCryptedKey(vchPubKey, vchCryptedSecret);
 }
@@ -556,7 +578,7 @@ bool CWallet::IsSpent(const uint256 &hash, unsigned int n) const {
             auto pub = sigma::ParseSigmaMintScript(script);
             CSigmaEntry data;
 
-            if (!db.ReadZerocoinEntry(pub, data)) {
+            if (!GetSigmaEntry(pub, data)) {
                 return false;
             }
 
@@ -769,83 +791,79 @@ bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, int
         }
     }
 
+    // Search backward in time from the given txNew timestamp
+    // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
+    static int nMaxStakeSearchInterval = 60;
+    unsigned int nInterval = min(nSearchInterval, (int64_t)nMaxStakeSearchInterval);
+    vector<PAIRTYPE(const CWalletTx*, unsigned int)> vStakeCoins(setCoins.begin(), setCoins.end());
+    vector<COutPoint> vPrevouts;
+    vPrevouts.reserve(vStakeCoins.size());
+    BOOST_FOREACH(const PAIRTYPE(const CWalletTx*, unsigned int)& pcoin, vStakeCoins)
+        vPrevouts.push_back(COutPoint(pcoin.first->GetHash(), pcoin.second));
+    if (!stakeKernelTable.IsBuiltFor(pindexPrev, nBits, vPrevouts))
+        stakeKernelTable.Build(pindexPrev, nBits, vPrevouts, stakeCache);
+
     int64_t nCredit = 0;
     CScript scriptPubKeyKernel;
-    BOOST_FOREACH(const PAIRTYPE(const CWalletTx*, unsigned int)& pcoin, setCoins)
+    for (size_t nPos = 0; pindexPrev == pindexBestHeader && stakeKernelTable.Search(nTime, nInterval, nPos); nPos++)
     {
-        static int nMaxStakeSearchInterval = 60;
-        bool fKernelFound = false;
-        for (unsigned int n=0; n < min(nSearchInterval,(int64_t)nMaxStakeSearchInterval) && !fKernelFound && pindexPrev == pindexBestHeader; n++)
+        boost::this_thread::interruption_point();
+        const PAIRTYPE(const CWalletTx*, unsigned int)& pcoin = vStakeCoins[nPos];
+
+        // Found a kernel
+        LogPrintf("CWallet::CreateCoinStake(): kernel found\n");
+        vector<vector<unsigned char> > vSolutions;
+        txnouttype whichType;
+        CScript scriptPubKeyOut;
+        scriptPubKeyKernel = pcoin.first->vout[pcoin.second].scriptPubKey;
+        if (!Solver(scriptPubKeyKernel, whichType, vSolutions))
         {
-            boost::this_thread::interruption_point();
-            // Search backward in time from the given txNew timestamp
-            // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
-            COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
-            
-            int64_t nBlockTime;
-
-            if (CheckKernel(pindexPrev, nBits, nTime - n, prevoutStake, stakeCache, &nBlockTime))
+            LogPrintf("CWallet::CreateCoinStake(): failed to parse kernel\n");
+            continue;
+        }
+        LogPrintf("CWallet::CreateCoinStake(): parsed kernel type=%d\n", whichType);
+        if (whichType != TX_PUBKEY && whichType != TX_PUBKEYHASH)
+        {
+            LogPrintf("CWallet::CreateCoinStake(): no support for kernel type=%d\n", whichType);
+            continue;  // only support pay to public key and pay to address
+        }
+        if (whichType == TX_PUBKEYHASH) // pay to address type
+        {
+            // convert to pay to public key type
+            if (!keystore.GetKey(uint160(vSolutions[0]), key))
             {
-                // Found a kernel
-                LogPrintf("CWallet::CreateCoinStake(): kernel found\n");
-                vector<vector<unsigned char> > vSolutions;
-                txnouttype whichType;
-                CScript scriptPubKeyOut;
-                scriptPubKeyKernel = pcoin.first->vout[pcoin.second].scriptPubKey;
-                if (!Solver(scriptPubKeyKernel, whichType, vSolutions))
-                {
-                    LogPrintf("CWallet::CreateCoinStake(): failed to parse kernel\n");
-                    break;
-                }
-                LogPrintf("CWallet::CreateCoinStake(): parsed kernel type=%d\n", whichType);
-                if (whichType != TX_PUBKEY && whichType != TX_PUBKEYHASH)
-                {
-                    LogPrintf("CWallet::CreateCoinStake(): no support for kernel type=%d\n", whichType);
-                    break;  // only support pay to public key and pay to address
-                }
-                if (whichType == TX_PUBKEYHASH) // pay to address type
-                {
-                    // convert to pay to public key type
-                    if (!keystore.GetKey(uint160(vSolutions[0]), key))
-                    {
-                        LogPrintf("CWallet::CreateCoinStake(): failed to get key for kernel type=%d\n", whichType);
-                        break;  // unable to find corresponding public key
-                    }
-
-                    scriptPubKeyOut << key.GetPubKey().getvch() << OP_CHECKSIG;
-                }
-                if (whichType == TX_PUBKEY)
-                {
-
-                    if (!keystore.GetKey(Hash160(vSolutions[0]), key))
-                    {
-                        LogPrintf("CWallet::CreateCoinStake(): failed to get key for kernel type=%d\n", whichType);
-                        break;  // unable to find corresponding public key
-                    }
-
-                    if (key.GetPubKey() != vSolutions[0])
-                    {
-                        LogPrintf("CWallet::CreateCoinStake(): invalid key for kernel type=%d\n", whichType);
-                        break; // keys mismatch
-                    }
+                LogPrintf("CWallet::CreateCoinStake(): failed to get key for kernel type=%d\n", whichType);
+                continue;  // unable to find corresponding public key
+            }
 
-                    scriptPubKeyOut = scriptPubKeyKernel;
-                }
+            scriptPubKeyOut << key.GetPubKey().getvch() << OP_CHECKSIG;
+        }
+        if (whichType == TX_PUBKEY)
+        {
 
-                //txNew.nTime -= n;
-                txNew.vin.push_back(CTxIn(pcoin.first->GetHash(), pcoin.second));
-                nCredit += pcoin.first->vout[pcoin.second].nValue;
-                vwtxPrev.push_back(pcoin.first);
-                txNew.vout.push_back(CTxOut(0, scriptPubKeyOut));
+            if (!keystore.GetKey(Hash160(vSolutions[0]), key))
+            {
+                LogPrintf("CWallet::CreateCoinStake(): failed to get key for kernel type=%d\n", whichType);
+                continue;  // unable to find corresponding public key
+            }
 
-                LogPrintf("CWallet::CreateCoinStake(): added kernel type=%d\n", whichType);
-                fKernelFound = true;
-                break;
+            if (key.GetPubKey() != vSolutions[0])
+            {
+                LogPrintf("CWallet::CreateCoinStake(): invalid key for kernel type=%d\n", whichType);
+                continue; // keys mismatch
             }
+
+            scriptPubKeyOut = scriptPubKeyKernel;
         }
 
-        if (fKernelFound)
-            break; // if kernel is found stop searching
+        //txNew.nTime -= n;
+        txNew.vin.push_back(CTxIn(pcoin.first->GetHash(), pcoin.second));
+        nCredit += pcoin.first->vout[pcoin.second].nValue;
+        vwtxPrev.push_back(pcoin.first);
+        txNew.vout.push_back(CTxOut(0, scriptPubKeyOut));
+
+        LogPrintf("CWallet::CreateCoinStake(): added kernel type=%d\n", whichType);
+        break;
     }
 
     if (nCredit == 0 || nCredit > nBalance - nReserveBalance)
@@ -1416,7 +1434,7 @@ bool CWallet::AbandonTransaction(const uint256 &hashTx) {
 
             // mark corresponding mint as unspent
             list <CSigmaEntry> pubCoins;
-            walletdb.ListSigmaPubCoin(pubCoins);
+            ListSigmaMints(pubCoins);
 
             BOOST_FOREACH(const CSigmaEntry &zerocoinItem, pubCoins) {
                 if (zerocoinItem.serialNumber == serial) {
@@ -1427,7 +1445,7 @@ bool CWallet::AbandonTransaction(const uint256 &hashTx) {
                         zerocoinItem.value.GetHex(),
                         std::string("New (") + std::to_string((double)zerocoinItem.get_denomination_value() / COIN) + "mint)",
                         CT_UPDATED);
-                    walletdb.WriteZerocoinEntry(modifiedItem);
+                    WriteSigmaEntry(walletdb, modifiedItem);
 
                     // erase zerocoin spend entry
                     CSigmaSpendEntry spendEntry;
@@ -1641,7 +1659,6 @@ isminetype CWallet::IsMine(const CTxOut &txout) const {
 
         return db.HasZerocoinEntry(pub) ? ISMINE_SPENDABLE : ISMINE_NO;
     } else if (txout.scriptPubKey.IsSigmaMint()) {
-        CWalletDB db(strWalletFile);
         secp_primitives::GroupElement pub;
 
         try {
@@ -1650,7 +1667,7 @@ isminetype CWallet::IsMine(const CTxOut &txout) const {
             return ISMINE_NO;
         }
 
-        return db.HasZerocoinEntry(pub) ? ISMINE_SPENDABLE : ISMINE_NO;
+        return HaveSigmaEntry(pub) ? ISMINE_SPENDABLE : ISMINE_NO;
     } else {
         return ::IsMine(*this, txout.scriptPubKey);
     }
@@ -2543,11 +2560,69 @@ CAmount CWallet::SelectSpendCoinsForAmount(
     return required - val;
 }
 
+bool CWallet::WriteSigmaEntry(const CSigmaEntry& entry) {
+    CWalletDB walletdb(strWalletFile);
+    return WriteSigmaEntry(walletdb, entry);
+}
+
+bool CWallet::WriteSigmaEntry(CWalletDB& walletdb, const CSigmaEntry& entry) {
+    LOCK(cs_wallet);
+    if (!walletdb.WriteZerocoinEntry(entry))
+        return false;
+
+    LoadSigmaEntry(entry);
+    return true;
+}
+
+bool CWallet::GetSigmaEntry(const GroupElement& pub, CSigmaEntry& entry) const {
+    LOCK(cs_wallet);
+    auto it = mapSigmaMints.find(pub);
+    if (it == mapSigmaMints.end())
+        return false;
+
+    entry = it->second;
+    return true;
+}
+
+bool CWallet::HaveSigmaEntry(const GroupElement& pub) const {
+    LOCK(cs_wallet);
+    return mapSigmaMints.count(pub) > 0;
+}
+
+void CWallet::ListSigmaMints(std::list<CSigmaEntry>& mints) const {
+    LOCK(cs_wallet);
+    for (const auto& index : sigmaMintIndex)
+        mints.push_back(mapSigmaMints.at(index.second));
+}
+
+void CWallet::ListSigmaMints(std::list<CSigmaEntry>& mints, bool fUsed) const {
+    LOCK(cs_wallet);
+    auto begin = sigmaMintIndex.lower_bound(
+        std::make_tuple(fUsed, std::numeric_limits<int64_t>::min(), std::numeric_limits<int>::min()));
+    auto end = sigmaMintIndex.upper_bound(
+        std::make_tuple(fUsed, std::numeric_limits<int64_t>::max(), std::numeric_limits<int>::max()));
+    for (auto it = begin; it != end; ++it)
+        mints.push_back(mapSigmaMints.at(it->second));
+}
+
+void CWallet::ListSigmaMints(std::list<CSigmaEntry>& mints, bool fUsed, sigma::CoinDenomination denomination) const {
+    int64_t denominationValue;
+    sigma::DenominationToInteger(denomination, denominationValue);
+
+    LOCK(cs_wallet);
+    auto begin = sigmaMintIndex.lower_bound(
+        std::make_tuple(fUsed, denominationValue, std::numeric_limits<int>::min()));
+    auto end = sigmaMintIndex.upper_bound(
+        std::make_tuple(fUsed, denominationValue, std::numeric_limits<int>::max()));
+    for (auto it = begin; it != end; ++it)
+        mints.push_back(mapSigmaMints.at(it->second));
+}
+
 std::list<CSigmaEntry> CWallet::GetAvailableCoins(const CCoinControl *coinControl, bool includeUnsafe) const {
     LOCK2(cs_main, cs_wallet);
 
     std::list<CSigmaEntry> coins;
-    CWalletDB(strWalletFile).ListSigmaPubCoin(coins);
+    ListSigmaMints(coins, false);
 
     std::set<COutPoint> lockedCoins = setLockedCoins;
     
@@ -2564,18 +2639,13 @@ std::list<CSigmaEntry> CWallet::GetAvailableCoins(const CCoinControl *coinContro
             sigma::PublicCoin(coin.value, coin.get_denomination()));
 
         // Check group size
-        uint256 hashOut;
-        std::vector<sigma::PublicCoin> coinOuts;
-        sigmaState->GetCoinSetForSpend(
-            &chainActive,
+        int coinSetSize = sigmaState->GetCoinSetSizeForSpend(
             chainActive.Height() - (ZC_MINT_CONFIRMATIONS - 1), // required 6 confirmation for mint to spend
             coin.get_denomination(),
-            coinId,
-            hashOut,
-            coinOuts
+            coinId
         );
 
-        if (!includeUnsafe && coinOuts.size() < 2) {
+        if (!includeUnsafe && coinSetSize < 2) {
             return true;
         }
 
@@ -3243,8 +3313,7 @@ void CWallet::ListAvailableSigmaMintCoins(vector<COutput> &vCoins, bool fOnlyCon
     vCoins.clear();
     LOCK(cs_wallet);
     list<CSigmaEntry> listOwnCoins;
-    CWalletDB walletdb(pwalletMain->strWalletFile);
-    walletdb.ListSigmaPubCoin(listOwnCoins);
+    ListSigmaMints(listOwnCoins);
     LogPrintf("listOwnCoins.size()=%s\n", listOwnCoins.size());
     for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
         const CWalletTx *pcoin = &(*it).second;
@@ -4457,7 +4526,7 @@ bool CWallet::CreateSigmaMintModel(string &stringError, const string& denomAmoun
             zerocoinTx.value.GetHex(),
             "New (" + std::to_string(zerocoinTx.get_denomination_value() / COIN) + " mint)",
             CT_NEW);
-        if (!CWalletDB(strWalletFile).WriteZerocoinEntry(zerocoinTx))
+        if (!WriteSigmaEntry(zerocoinTx))
             return false;
         return true;
     } else {
@@ -5417,7 +5486,7 @@ bool CWallet::CreateSigmaSpendTransaction(
             // Select not yet used coin from the wallet with minimal possible id
 
             list <CSigmaEntry> listOwnCoins;
-            CWalletDB(strWalletFile).ListSigmaPubCoin(listOwnCoins);
+            ListSigmaMints(listOwnCoins, forceUsed, denomination);
             listOwnCoins.sort(CompSigmaHeight);
             CSigmaEntry coinToUse;
             sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
@@ -5501,7 +5570,7 @@ bool CWallet::CreateSigmaSpendTransaction(
                 fPadding = true;
             }
 
-            sigma::CoinSpend spend(sigmaParams, privateCoin, anonimity_set, metaData, fPadding);
+            sigma::CoinSpend spend(sigmaParams, privateCoin, anonimity_set, metaData, fPadding, ParallelFor);
             spend.setVersion(txVersion);
 
             // This is a sanity check. The CoinSpend object should always verify,
@@ -5540,7 +5609,7 @@ bool CWallet::CreateSigmaSpendTransaction(
                     pubCoinTx.serialNumber = coinToUse.serialNumber;
                     pubCoinTx.value = coinToUse.value;
                     pubCoinTx.ecdsaSecretKey = coinToUse.ecdsaSecretKey;
-                    CWalletDB(strWalletFile).WriteZerocoinEntry(pubCoinTx);
+                    WriteSigmaEntry(pubCoinTx);
                     LogPrintf("CreateZerocoinSpendTransaction() -> NotifyZerocoinChanged\n");
                     LogPrintf("pubcoin=%s, isUsed=Used\n", coinToUse.value.GetHex());
                     pwalletMain->NotifyZerocoinChanged(
@@ -5607,7 +5676,7 @@ bool CWallet::CreateSigmaSpendTransaction(
             coinToUse.IsUsed = true;
             coinToUse.id = coinId;
             coinToUse.nHeight = coinHeight;
-            CWalletDB(strWalletFile).WriteZerocoinEntry(coinToUse);
+            WriteSigmaEntry(coinToUse);
             pwalletMain->NotifyZerocoinChanged(
                 pwalletMain, coinToUse.value.GetHex(),
                 "Used (" + std::to_string(coinToUse.get_denomination_value() / COIN) + " mint)",
@@ -6050,7 +6119,7 @@ bool CWallet::CreateMultipleSigmaSpendTransaction(
                 // Fill vin
                 // Select not yet used coin from the wallet with minimal possible id
                 list <CSigmaEntry> listOwnCoins;
-                CWalletDB(strWalletFile).ListSigmaPubCoin(listOwnCoins);
+                ListSigmaMints(listOwnCoins, forceUsed, *it);
                 listOwnCoins.sort(CompSigmaHeight);
                 CSigmaEntry coinToUse;
                 sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
@@ -6185,7 +6254,8 @@ bool CWallet::CreateMultipleSigmaSpendTransaction(
                                        tempStorage.privateCoin,
                                        tempStorage.anonimity_set,
                                        metaData,
-                                       fPadding);
+                                       fPadding,
+                                       ParallelFor);
                 spend.setVersion(tempStorage.txVersion);
                 spends.push_back(spend);
                 // Verify the coinSpend
@@ -6226,7 +6296,7 @@ bool CWallet::CreateMultipleSigmaSpendTransaction(
                         pubCoinTx.serialNumber = coinToUse.serialNumber;
                         pubCoinTx.value = coinToUse.value;
                         pubCoinTx.ecdsaSecretKey = coinToUse.ecdsaSecretKey;
-                        CWalletDB(strWalletFile).WriteZerocoinEntry(pubCoinTx);
+                        WriteSigmaEntry(pubCoinTx);
                         LogPrintf("CreateZerocoinSpendTransaction() -> NotifyZerocoinChanged\n");
                         LogPrintf("pubcoin=%s, isUsed=Used\n", coinToUse.value.GetHex());
                         pwalletMain->NotifyZerocoinChanged(
@@ -6305,7 +6375,7 @@ bool CWallet::CreateMultipleSigmaSpendTransaction(
                 coinToUse.IsUsed = true;
                 coinToUse.id = tempStorage.coinId;
                 coinToUse.nHeight = tempStorage.coinHeight;
-                CWalletDB(strWalletFile).WriteZerocoinEntry(coinToUse);
+                WriteSigmaEntry(coinToUse);
                 pwalletMain->NotifyZerocoinChanged(
                     pwalletMain,
                     coinToUse.value.GetHex(),
@@ -6547,7 +6617,7 @@ string CWallet::MintAndStoreSigma(const vector<CRecipient>& vecSend,
         zerocoinTx.serialNumber = privCoin.getSerialNumber();
         const unsigned char *ecdsaSecretKey = privCoin.getEcdsaSeckey();
         zerocoinTx.ecdsaSecretKey = std::vector<unsigned char>(ecdsaSecretKey, ecdsaSecretKey+32);
-        walletdb.WriteZerocoinEntry(zerocoinTx);
+        WriteSigmaEntry(walletdb, zerocoinTx);
         NotifyZerocoinChanged(this,
             zerocoinTx.value.GetHex(),
             "New (" + std::to_string(zerocoinTx.get_denomination()) + " mint)",
@@ -6730,8 +6800,7 @@ string CWallet::SpendSigma(
         list <CSigmaEntry> listOwnCoins;
         listOwnCoins.clear();
 
-        CWalletDB walletdb(pwalletMain->strWalletFile);
-        walletdb.ListSigmaPubCoin(listOwnCoins);
+        ListSigmaMints(listOwnCoins);
         BOOST_FOREACH(const CSigmaEntry &ownCoinItem, listOwnCoins) {
             if (zcSelectedValue == ownCoinItem.value) {
                 pubCoinTx.id = ownCoinItem.id;
@@ -6742,7 +6811,7 @@ string CWallet::SpendSigma(
                 pubCoinTx.serialNumber = ownCoinItem.serialNumber;
                 pubCoinTx.set_denomination_value(ownCoinItem.get_denomination_value());
                 pubCoinTx.ecdsaSecretKey = ownCoinItem.ecdsaSecretKey;
-                CWalletDB(strWalletFile).WriteZerocoinEntry(pubCoinTx);
+                WriteSigmaEntry(pubCoinTx);
                 LogPrintf("SpendZerocoin failed, re-updated status -> NotifyZerocoinChanged\n");
                 LogPrintf("pubcoin=%s, isUsed=New\n", ownCoinItem.value.GetHex());
                 pwalletMain->NotifyZerocoinChanged(pwalletMain, ownCoinItem.value.GetHex(), "New", CT_UPDATED);
@@ -6864,8 +6933,7 @@ string CWallet::SpendMultipleSigma(
         CSigmaEntry pubCoinTx;
         list <CSigmaEntry> listOwnCoins;
         listOwnCoins.clear();
-        CWalletDB walletdb(pwalletMain->strWalletFile);
-        walletdb.ListSigmaPubCoin(listOwnCoins);
+        ListSigmaMints(listOwnCoins);
 
         for (std::vector<Scalar>::iterator it = coinSerials.begin(); it != coinSerials.end(); it++){
             unsigned index = it - coinSerials.begin();
@@ -6880,7 +6948,7 @@ string CWallet::SpendMultipleSigma(
                     pubCoinTx.serialNumber = ownCoinItem.serialNumber;
                     pubCoinTx.set_denomination_value(ownCoinItem.get_denomination_value());
                     pubCoinTx.ecdsaSecretKey = ownCoinItem.ecdsaSecretKey;
-                    CWalletDB(strWalletFile).WriteZerocoinEntry(pubCoinTx);
+                    WriteSigmaEntry(pubCoinTx);
                     LogPrintf("SpendZerocoin failed, re-updated status -> NotifyZerocoinChanged\n");
                     LogPrintf("pubcoin=%s, isUsed=New\n", ownCoinItem.value.GetHex());
                 }
@@ -6967,7 +7035,7 @@ bool CWallet::CommitSigmaTransaction(CWalletTx& wtxNew, std::vector<CSigmaEntry>
         coin.id = id;
         coin.nHeight = height;
 
-        if (!db.WriteZerocoinEntry(coin)) {
+        if (!WriteSigmaEntry(db, coin)) {
             throw std::runtime_error(_("Failed to mark Zerocoin as used"));
         }
 
@@ -6981,7 +7049,7 @@ bool CWallet::CommitSigmaTransaction(CWalletTx& wtxNew, std::vector<CSigmaEntry>
 
     for (auto& change : changes) {
 
-        if (!db.WriteZerocoinEntry(change)) {
+        if (!WriteSigmaEntry(db, change)) {
             throw std::runtime_error(_("Failed to store new Zerocoin"));
         }
 
@@ -7772,6 +7840,9 @@ std::string CWallet::GetWalletHelpString(bool showDebug) {
                                    strprintf(
                                            _("Send transactions as zero-fee transactions if possible (default: %u)"),
                                            DEFAULT_SEND_FREE_TRANSACTIONS));
+    strUsage += HelpMessageOpt("-sigmaspendcheck",
+                               strprintf(_("Verify the sigma spend proofs of transactions before sending them (default: %u)"),
+                                         DEFAULT_SIGMA_SPEND_CHECK));
     strUsage += HelpMessageOpt("-spendzeroconfchange",
                                strprintf(_("Spend unconfirmed change when sending transactions (default: %u)"),
                                          DEFAULT_SPEND_ZEROCONF_CHANGE));
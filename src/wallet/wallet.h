@@ -30,6 +30,8 @@
 #include <stdexcept>
 #include <stdint.h>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -62,6 +64,8 @@ static const bool DEFAULT_SPEND_ZEROCONF_CHANGE = true;
 static const bool DEFAULT_SEND_FREE_TRANSACTIONS = false;
 //! Default for -walletrejectlongchains
 static const bool DEFAULT_WALLET_REJECT_LONG_CHAINS = false;
+//! Default for -sigmaspendcheck
+static const bool DEFAULT_SIGMA_SPEND_CHECK = true;
 //! -txconfirmtarget default
 static const unsigned int DEFAULT_TX_CONFIRM_TARGET = 2;
 //! Largest (in bytes) free transaction we're willing to create
@@ -604,6 +608,114 @@ private:
     std::vector<char> _ssExtra;
 };
 
+class CSigmaEntry
+{
+public:
+    void set_denomination(sigma::CoinDenomination denom) {
+        DenominationToInteger(denom, denomination);
+    }
+    void set_denomination_value(int64_t new_denomination) {
+        denomination = new_denomination;
+    }
+    int64_t get_denomination_value() const {
+        return denomination;
+    }
+    sigma::CoinDenomination get_denomination() const {
+        sigma::CoinDenomination result;
+        IntegerToDenomination(denomination, result);
+        return result;
+    }
+
+    std::string get_string_denomination() const {
+        return DenominationToString(get_denomination());
+    }
+
+    //public
+    GroupElement value;
+
+    //private
+    Scalar randomness;
+    Scalar serialNumber;
+
+    // Signature over partial transaction
+    // to make sure the outputs are not changed by attacker.
+    std::vector<unsigned char> ecdsaSecretKey;
+
+    bool IsUsed;
+    int nHeight;
+    int id;
+
+private:
+    // NOTE(martun): made this one private to make sure people don't
+    // misuse it and try to assign a value of type sigma::CoinDenomination
+    // to it. In these cases the value is automatically converted to int,
+    // which is not what we want.
+    // Starting from Version 3 == sigma, this number is coin value * COIN,
+    // I.E. it is set to 100.000.000 for 1 noir.
+    int64_t denomination;
+
+public:
+
+    CSigmaEntry()
+    {
+        SetNull();
+    }
+
+    void SetNull()
+    {
+        IsUsed = false;
+        randomness = Scalar(uint64_t(0));
+        serialNumber = Scalar(uint64_t(0));
+        value = GroupElement();
+        denomination = -1;
+        nHeight = -1;
+        id = -1;
+    }
+
+    bool IsCorrectSigmaMint() const {
+        return randomness.isMember() && serialNumber.isMember();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(IsUsed);
+        READWRITE(randomness);
+        READWRITE(serialNumber);
+        READWRITE(value);
+        READWRITE(denomination);
+        READWRITE(nHeight);
+        READWRITE(id);
+        if (ser_action.ForRead()) {
+            if (!is_eof(s)) {
+                int nStoredVersion = 0;
+                READWRITE(nStoredVersion);
+                READWRITE(ecdsaSecretKey);
+            }
+        }
+        else {
+            READWRITE(nVersion);
+            READWRITE(ecdsaSecretKey);
+        }
+    }
+private:
+    template <typename Stream>
+    auto is_eof_helper(Stream &s, bool) -> decltype(s.eof()) {
+        return s.eof();
+    }
+
+    template <typename Stream>
+    bool is_eof_helper(Stream &s, int) {
+        return false;
+    }
+
+    template<typename Stream>
+    bool is_eof(Stream &s) {
+        return is_eof_helper(s, true);
+    }
+};
+
 enum MintAlgorithm {
     ZEROCOIN = 1,
     SIGMA = 2
@@ -636,6 +748,7 @@ private:
     bool fBroadcastTransactions;
 
     std::map<COutPoint, CStakeCache> stakeCache;
+    CStakeKernelTable stakeKernelTable;
 
     mutable bool fAnonymizableTallyCached;
     mutable std::vector<CompactTallyItem> vecAnonymizableTallyCached;
@@ -737,6 +850,12 @@ public:
 
     std::set<COutPoint> setLockedCoins;
 
+    //! Sigma mints of the wallet by public coin, a copy of the "sigma_mint" records kept in sync by
+    //! WriteSigmaEntry so the wallet does not have to scan the database to find them
+    std::unordered_map<GroupElement, CSigmaEntry> mapSigmaMints;
+    //! Public coins of mapSigmaMints ordered by spent state, denomination and height
+    std::multimap<std::tuple<bool, int64_t, int>, GroupElement> sigmaMintIndex;
+
     int64_t nTimeFirstKey;
 
     const CWalletTx* GetWalletTx(const uint256& hash) const;
@@ -788,6 +907,8 @@ public:
     bool LoadKey(const CKey& key, const CPubKey &pubkey) { return CCryptoKeyStore::AddKeyPubKey(key, pubkey); }
     //! Load metadata (used by LoadWallet)
     bool LoadKeyMetadata(const CPubKey &pubkey, const CKeyMetadata &metadata);
+    //! Adds a sigma mint to mapSigmaMints, without saving it to disk (used by LoadWallet)
+    void LoadSigmaEntry(const CSigmaEntry& entry);
 
     bool LoadMinVersion(int nVersion) { AssertLockHeld(cs_wallet); nWalletVersion = nVersion; nWalletMaxVersion = std::max(nWalletMaxVersion, nVersion); return true; }
 
@@ -875,6 +996,17 @@ public:
         const std::list<CSigmaEntry>& coinsIn,
         std::vector<CSigmaEntry>& coinsOut);
 
+    //! Saves a sigma mint to disk and updates mapSigmaMints
+    bool WriteSigmaEntry(const CSigmaEntry& entry);
+    bool WriteSigmaEntry(CWalletDB& walletdb, const CSigmaEntry& entry);
+    bool GetSigmaEntry(const GroupElement& pub, CSigmaEntry& entry) const;
+    bool HaveSigmaEntry(const GroupElement& pub) const;
+    //! Lists the sigma mints ordered by spent state, denomination and height, all of them or only the used
+    //! or unused ones (of one denomination)
+    void ListSigmaMints(std::list<CSigmaEntry>& mints) const;
+    void ListSigmaMints(std::list<CSigmaEntry>& mints, bool fUsed) const;
+    void ListSigmaMints(std::list<CSigmaEntry>& mints, bool fUsed, sigma::CoinDenomination denomination) const;
+
     // Returns a list of unspent and verified coins, I.E. coins which are ready
     // to be spent.
     std::list<CSigmaEntry> GetAvailableCoins(const CCoinControl *coinControl = NULL, bool includeUnsafe = false) const;
@@ -1319,115 +1451,6 @@ public:
 };
 
 
-class CSigmaEntry
-{
-public:
-    void set_denomination(sigma::CoinDenomination denom) {
-        DenominationToInteger(denom, denomination);
-    }
-    void set_denomination_value(int64_t new_denomination) {
-        denomination = new_denomination;
-    }
-    int64_t get_denomination_value() const {
-        return denomination;
-    }
-    sigma::CoinDenomination get_denomination() const {
-        sigma::CoinDenomination result;
-        IntegerToDenomination(denomination, result);
-        return result;
-    }
-
-    std::string get_string_denomination() const {
-        return DenominationToString(get_denomination());
-    }
-
-    //public
-    GroupElement value;
-
-    //private
-    Scalar randomness;
-    Scalar serialNumber;
-
-    // Signature over partial transaction
-    // to make sure the outputs are not changed by attacker.
-    std::vector<unsigned char> ecdsaSecretKey;
-
-    bool IsUsed;
-    int nHeight;
-    int id;
-
-private:
-    // NOTE(martun): made this one private to make sure people don't
-    // misuse it and try to assign a value of type sigma::CoinDenomination
-    // to it. In these cases the value is automatically converted to int,
-    // which is not what we want.
-    // Starting from Version 3 == sigma, this number is coin value * COIN,
-    // I.E. it is set to 100.000.000 for 1 noir.
-    int64_t denomination;
-
-public:
-
-    CSigmaEntry()
-    {
-        SetNull();
-    }
-
-    void SetNull()
-    {
-        IsUsed = false;
-        randomness = Scalar(uint64_t(0));
-        serialNumber = Scalar(uint64_t(0));
-        value = GroupElement();
-        denomination = -1;
-        nHeight = -1;
-        id = -1;
-    }
-
-    bool IsCorrectSigmaMint() const {
-        return randomness.isMember() && serialNumber.isMember();
-    }
-
-    ADD_SERIALIZE_METHODS;
-
-    template <typename Stream, typename Operation>
-    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
-        READWRITE(IsUsed);
-        READWRITE(randomness);
-        READWRITE(serialNumber);
-        READWRITE(value);
-        READWRITE(denomination);
-        READWRITE(nHeight);
-        READWRITE(id);
-        if (ser_action.ForRead()) {
-            if (!is_eof(s)) {
-                int nStoredVersion = 0;
-                READWRITE(nStoredVersion);
-                READWRITE(ecdsaSecretKey);
-            }
-        }
-        else {
-            READWRITE(nVersion);
-            READWRITE(ecdsaSecretKey);
-        }
-    }
-private:
-    template <typename Stream>
-    auto is_eof_helper(Stream &s, bool) -> decltype(s.eof()) {
-        return s.eof();
-    }
-
-    template <typename Stream>
-    bool is_eof_helper(Stream &s, int) {
-        return false;
-    }
-
-    template<typename Stream>
-    bool is_eof(Stream &s) {
-        return is_eof_helper(s, true);
-    }
-};
-
-
 class CZerocoinSpendEntry
 {
 public:
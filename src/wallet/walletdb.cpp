@@ -738,6 +738,12 @@ bool ReadKeyValue(CWallet *pwallet, CDataStream &ssKey, CDataStream &ssValue,
                 strErr = "Error reading wallet database: LoadDestData failed";
                 return false;
             }
+        } else if (strType == "sigma_mint") {
+            GroupElement pub;
+            ssKey >> pub;
+            CSigmaEntry entry;
+            ssValue >> entry;
+            pwallet->LoadSigmaEntry(entry);
         } else if (strType == "hdchain") {
             CHDChain chain;
             ssValue >> chain;
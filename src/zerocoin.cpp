@@ -1,5 +1,7 @@
 #include "main.h"
 #include "zerocoin.h"
+#include "statesnapshot.h"
+#include "txdb.h"
 #include "timedata.h"
 #include "chainparams.h"
 #include "util.h"
@@ -724,12 +726,64 @@ int ZerocoinGetNHeight(const CBlockHeader &block) {
 }
 
 
+static const char *ZEROCOIN_STATE_SNAPSHOT_FILENAME = "zerocoinstate.dat";
+static const int ZEROCOIN_STATE_SNAPSHOT_VERSION = 1;
+
+bool ZerocoinWriteStateSnapshot(CChain *chain) {
+    if (chain->Tip() == NULL)
+        return false;
+
+    CDataStream ssState(SER_DISK, CLIENT_VERSION);
+    zerocoinState.WriteSnapshot(ssState);
+    return WriteStateSnapshot(ZEROCOIN_STATE_SNAPSHOT_FILENAME, ZEROCOIN_STATE_SNAPSHOT_VERSION, chain->Tip()->GetBlockHash(), ssState);
+}
+
+// Loads the latest snapshot of the state if it was taken at a block of the chain. Returns that block
+static CBlockIndex *ZerocoinReadStateSnapshot(CChain *chain) {
+    uint256 blockHash;
+    CDataStream ssState(SER_DISK, CLIENT_VERSION);
+    if (!ReadStateSnapshot(ZEROCOIN_STATE_SNAPSHOT_FILENAME, ZEROCOIN_STATE_SNAPSHOT_VERSION, blockHash, ssState))
+        return NULL;
+
+    BlockMap::iterator mi = mapBlockIndex.find(blockHash);
+    if (mi == mapBlockIndex.end() || !chain->Contains(mi->second)) {
+        LogPrintf("ZerocoinBuildStateFromIndex: snapshot block %s is not in the chain\n", blockHash.ToString());
+        return NULL;
+    }
+
+    try {
+        if (zerocoinState.ReadSnapshot(ssState, chain))
+            return mi->second;
+    }
+    catch (const std::exception &e) {
+        LogPrintf("ZerocoinBuildStateFromIndex: failed to read snapshot - %s\n", e.what());
+    }
+    zerocoinState.Reset();
+    return NULL;
+}
+
 bool ZerocoinBuildStateFromIndex(CChain *chain, set<CBlockIndex *> &changes) {
     zerocoinState.Reset();
-    for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
-        zerocoinState.AddBlock(blockIndex);
 
-    changes = zerocoinState.RecalculateAccumulators(chain);
+    CBlockIndex *blockIndex = ZerocoinReadStateSnapshot(chain);
+    if (blockIndex) {
+        LogPrintf("ZerocoinBuildStateFromIndex: loaded snapshot at height %d\n", blockIndex->nHeight);
+        for (blockIndex = chain->Next(blockIndex); blockIndex; blockIndex=chain->Next(blockIndex))
+            zerocoinState.AddBlock(blockIndex);
+        // accumulators were recalculated, and the changes flushed, before the snapshot was taken
+        changes.clear();
+    }
+    else {
+        for (blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
+            zerocoinState.AddBlock(blockIndex);
+
+        // the index only needs checking once after an upgrade from pre-modulusv2 versions
+        bool fAccumulatorsChecked = false;
+        if (pblocktree)
+            pblocktree->ReadFlag(ZEROCOIN_ACCUMULATORS_CHECKED_FLAG, fAccumulatorsChecked);
+        if (!fAccumulatorsChecked)
+            changes = zerocoinState.RecalculateAccumulators(chain);
+    }
 
     // DEBUG
     LogPrintf("Latest IDs are %d, %d, %d, %d, %d\n",
@@ -891,6 +945,72 @@ void CZerocoinState::RemoveBlock(CBlockIndex *index) {
     }
 }
 
+void CZerocoinState::WriteSnapshot(CDataStream &stream) const {
+    stream << (uint32_t)coinGroups.size();
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), CoinGroupInfo) &coinGroup, coinGroups) {
+        stream << coinGroup.first;
+        stream << coinGroup.second.firstBlock->GetBlockHash();
+        stream << coinGroup.second.lastBlock->GetBlockHash();
+        stream << coinGroup.second.nCoins;
+    }
+
+    stream << (uint64_t)mintedPubCoins.size();
+    BOOST_FOREACH(const PAIRTYPE(CBigNum, CMintedCoinInfo) &coin, mintedPubCoins) {
+        stream << coin.first;
+        stream << coin.second.denomination << coin.second.id << coin.second.nHeight;
+    }
+
+    stream << latestCoinIds;
+
+    stream << (uint64_t)usedCoinSerials.size();
+    BOOST_FOREACH(const CBigNum &serial, usedCoinSerials)
+        stream << serial;
+}
+
+bool CZerocoinState::ReadSnapshot(CDataStream &stream, CChain *chain) {
+    uint32_t nGroups;
+    stream >> nGroups;
+    for (uint32_t i = 0; i < nGroups; i++) {
+        pair<int,int> key;
+        uint256 firstBlockHash, lastBlockHash;
+        CoinGroupInfo coinGroup;
+        stream >> key >> firstBlockHash >> lastBlockHash >> coinGroup.nCoins;
+
+        BlockMap::iterator first = mapBlockIndex.find(firstBlockHash);
+        BlockMap::iterator last = mapBlockIndex.find(lastBlockHash);
+        if (first == mapBlockIndex.end() || !chain->Contains(first->second) ||
+                last == mapBlockIndex.end() || !chain->Contains(last->second))
+            return false;
+        coinGroup.firstBlock = first->second;
+        coinGroup.lastBlock = last->second;
+        coinGroups[key] = coinGroup;
+    }
+
+    uint64_t nCoins;
+    stream >> nCoins;
+    mintedPubCoins.reserve(nCoins);
+    for (uint64_t i = 0; i < nCoins; i++) {
+        CBigNum pubCoin;
+        CMintedCoinInfo coinInfo;
+        stream >> pubCoin;
+        stream >> coinInfo.denomination >> coinInfo.id >> coinInfo.nHeight;
+        mintedPubCoins.insert(make_pair(pubCoin, coinInfo));
+    }
+
+    stream >> latestCoinIds;
+
+    uint64_t nSerials;
+    stream >> nSerials;
+    usedCoinSerials.reserve(nSerials);
+    for (uint64_t i = 0; i < nSerials; i++) {
+        CBigNum serial;
+        stream >> serial;
+        usedCoinSerials.insert(serial);
+    }
+
+    return true;
+}
+
 bool CZerocoinState::GetCoinGroupInfo(int denomination, int id, CoinGroupInfo &result) {
     pair<int,int>   key = make_pair(denomination, id);
     if (coinGroups.count(key) == 0)
@@ -1025,17 +1145,46 @@ int CZerocoinState::GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomin
         return -1;
 }
 
+bool CZerocoinState::HasAlternativeAccumulatorValue(CBlockIndex *block, const pair<int, int> &denomAndId) {
+    if (block->alternativeAccumulatorChanges.count(denomAndId) > 0)
+        return true;
+    if (block->accumulatorChanges.count(denomAndId) == 0 || !pblocktree)
+        return false;
+
+    // calculated before the last restart
+    map<pair<int,int>, pair<CBigNum,int>> storedChanges;
+    if (pblocktree->ReadAlternativeAccumulatorChanges(block->GetBlockHash(), storedChanges))
+        block->alternativeAccumulatorChanges.insert(storedChanges.begin(), storedChanges.end());
+    return block->alternativeAccumulatorChanges.count(denomAndId) > 0;
+}
+
 void CZerocoinState::CalculateAlternativeModulusAccumulatorValues(CChain *chain, int denomination, int id) {
     libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
     pair<int, int> denomAndId = pair<int, int>(denomination, id);
     libzerocoin::Params *altParams = IsZerocoinTxV2(d, Params(), id) ? ZCParams : ZCParamsV2;
     libzerocoin::Accumulator accumulator(altParams, d);
-     assert(coinGroups.count(denomAndId) > 0);
-     CoinGroupInfo coinGroup = coinGroups[denomAndId];
-     CBlockIndex *block = coinGroup.firstBlock;
+    assert(coinGroups.count(denomAndId) > 0);
+    CoinGroupInfo coinGroup = coinGroups[denomAndId];
+
+    // Values are calculated from the first block of the group on, so only the blocks after the
+    // latest one having a value, in memory or stored before the last restart, need them
+    CBlockIndex *block = coinGroup.lastBlock;
+    for (;;) {
+        if (HasAlternativeAccumulatorValue(block, denomAndId)) {
+            if (block == coinGroup.lastBlock)
+                return;
+            accumulator = libzerocoin::Accumulator(altParams, block->alternativeAccumulatorChanges[denomAndId].first, d);
+            block = (*chain)[block->nHeight+1];
+            break;
+        }
+        if (block == coinGroup.firstBlock)
+            break;
+        block = block->pprev;
+    }
+
     for (;;) {
         if (block->accumulatorChanges.count(denomAndId) > 0) {
-            if (block->alternativeAccumulatorChanges.count(denomAndId) > 0)
+            if (HasAlternativeAccumulatorValue(block, denomAndId))
                 // already calculated, update accumulator with cached value
                 accumulator = libzerocoin::Accumulator(altParams, block->alternativeAccumulatorChanges[denomAndId].first, d);
             else {
@@ -1046,13 +1195,31 @@ void CZerocoinState::CalculateAlternativeModulusAccumulatorValues(CChain *chain,
                     accumulator += libzerocoin::PublicCoin(altParams, c, d);
                 }
                 block->alternativeAccumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), (int)mintedCoins.size());
+                unsavedAlternativeBlocks.insert(block);
             }
         }
-         if (block != coinGroup.lastBlock)
+        if (block != coinGroup.lastBlock)
             block = (*chain)[block->nHeight+1];
         else
             break;
     }
+
+    if (!FlushAlternativeAccumulatorValues())
+        LogPrintf("ZerocoinState: failed to store alternative accumulator values for denomination=%d, id=%d, "
+                  "retrying on the next flush\n", denomination, id);
+}
+
+bool CZerocoinState::FlushAlternativeAccumulatorValues() {
+    if (unsavedAlternativeBlocks.empty() || !pblocktree)
+        return true;
+
+    // The values only depend on the blocks up to the one they are stored for, so they stay valid
+    // across reorganizations
+    vector<const CBlockIndex *> blocks(unsavedAlternativeBlocks.begin(), unsavedAlternativeBlocks.end());
+    if (!pblocktree->WriteAlternativeAccumulatorChanges(blocks))
+        return false;
+    unsavedAlternativeBlocks.clear();
+    return true;
 }
 
 bool CZerocoinState::TestValidity(CChain *chain) {
@@ -1152,6 +1319,7 @@ void CZerocoinState::Reset() {
     mintedPubCoins.clear();
     latestCoinIds.clear();
     mempoolCoinSerials.clear();
+    unsavedAlternativeBlocks.clear();
 }
 
 CZerocoinState *CZerocoinState::GetZerocoinState() {
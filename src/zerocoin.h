@@ -63,7 +63,15 @@ bool ConnectBlockZC(CValidationState &state, const CChainParams &chainparams, CB
 
 int ZerocoinGetNHeight(const CBlockHeader &block);
 
+// Block tree database flag set once the accumulators of the index were checked and, if needed,
+// recalculated with modulus v2
+static const char *const ZEROCOIN_ACCUMULATORS_CHECKED_FLAG = "zerocoinaccumulatorschecked";
+
+// Builds the state from the latest snapshot, if any, and the blocks of the chain after it
 bool ZerocoinBuildStateFromIndex(CChain *chain, set<CBlockIndex *> &changes);
+
+// Writes a snapshot of the state at the tip of the chain
+bool ZerocoinWriteStateSnapshot(CChain *chain);
  
 CBigNum ZerocoinGetSpendSerialNumber(const CTransaction &tx);
 
@@ -102,6 +110,12 @@ private:
     unordered_multimap<CBigNum,CMintedCoinInfo,CBigNumHash> mintedPubCoins;
     // Latest IDs of coins by denomination
     map<int, int> latestCoinIds;
+    // Blocks whose alternative accumulator values couldn't be stored yet
+    set<const CBlockIndex *> unsavedAlternativeBlocks;
+
+    // Loads the alternative accumulator values stored for the block if they aren't in memory.
+    // Returns true if the block has a value for the group
+    bool HasAlternativeAccumulatorValue(CBlockIndex *block, const pair<int, int> &denomAndId);
 
 public:
     CZerocoinState();
@@ -144,9 +158,20 @@ public:
     // If needed calculate accumulators for alternative accumulator modulus
     void CalculateAlternativeModulusAccumulatorValues(CChain *chain, int denomination, int id);
 
+    // Store the alternative accumulator values calculated but not written yet. Returns false if
+    // the write failed, the values are then kept for the next call
+    bool FlushAlternativeAccumulatorValues();
+
     // Reset to initial values
     void Reset();
 
+    // Serialize coin groups, minted coins, spent serials and latest ids, referring to blocks by hash
+    void WriteSnapshot(CDataStream &stream) const;
+
+    // Restore the state written by WriteSnapshot into an empty state. Returns false if the
+    // snapshot refers to blocks not in the chain
+    bool ReadSnapshot(CDataStream &stream, CChain *chain);
+
     // Test function
     bool TestValidity(CChain *chain);
     
@@ -32,8 +32,11 @@ public:
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
+    // pblock is the block of the new tip if it is still in memory, NULL otherwise
+    virtual bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    // Called for the transactions of every block connected to the chain
+    virtual bool NotifyConnectedTransaction(const CTransaction &transaction, const CBlockIndex *pindex);
 
 protected:
     void *psocket;
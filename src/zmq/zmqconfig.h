@@ -10,6 +10,7 @@
 #endif
 
 #include <stdarg.h>
+#include <memory>
 #include <string>
 
 #if ENABLE_ZMQ
@@ -39,6 +39,8 @@ CZMQNotificationInterface* CZMQNotificationInterface::CreateWithArguments(const
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubrawsigmamint"] = CZMQAbstractNotifier::Create<CZMQPublishRawSigmaMintNotifier>;
+    factories["pubsigmaspendserial"] = CZMQAbstractNotifier::Create<CZMQPublishSigmaSpendSerialNotifier>;
 
     for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
     {
@@ -124,12 +126,12 @@ void CZMQNotificationInterface::Shutdown()
     }
 }
 
-void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindex)
+void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock)
 {
     for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
     {
         CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyBlock(pindex))
+        if (notifier->NotifyBlock(pindex, pblock))
         {
             i++;
         }
@@ -146,7 +148,8 @@ void CZMQNotificationInterface::SyncTransaction(const CTransaction& tx, const CB
     for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
     {
         CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyTransaction(tx))
+        // transactions come with their block when it is connected
+        if (notifier->NotifyTransaction(tx) && (!pblock || notifier->NotifyConnectedTransaction(tx, pindex)))
         {
             i++;
         }
@@ -7,6 +7,7 @@
 #include "main.h"
 #include "util.h"
 #include "rpc/server.h"
+#include "sigma.h"
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -14,6 +15,8 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_RAWSIGMAMINT     = "rawsigmamint";
+static const char *MSG_SIGMASPENDSERIAL = "sigmaspendserial";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -55,6 +58,19 @@ static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
     return 0;
 }
 
+// Frees the data of a message sent without copy
+static void zmq_free_stream(void * /*data*/, void *hint)
+{
+    delete static_cast<CDataStream*>(hint);
+}
+
+// Writes a hash in the byte order it is displayed in
+static void WriteReversedHash(unsigned char *data, const uint256 &hash)
+{
+    for (unsigned int i = 0; i < 32; i++)
+        data[31 - i] = hash.begin()[i];
+}
+
 bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
 {
     assert(!psocket);
@@ -141,7 +157,45 @@ bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* d
     return true;
 }
 
-bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQAbstractPublishNotifier::SendMessage(const char *command, std::unique_ptr<CDataStream> data)
+{
+    assert(psocket);
+
+    /* send three parts, command & data & a LE 4byte sequence number, the data part
+       being owned by the ZMQ message from here on */
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(&msgseq[0], nSequence);
+
+    zmq_msg_t msg;
+    CDataStream *pdata = data.release();
+    if (zmq_msg_init_data(&msg, &(*pdata->begin()), pdata->size(), zmq_free_stream, pdata) != 0)
+    {
+        zmqError("Unable to initialize ZMQ msg");
+        delete pdata;
+        return false;
+    }
+
+    if (zmq_send(psocket, command, strlen(command), ZMQ_SNDMORE) == -1 ||
+        zmq_msg_send(&msg, psocket, ZMQ_SNDMORE) == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        zmq_msg_close(&msg);
+        return false;
+    }
+
+    if (zmq_send(psocket, msgseq, sizeof(msgseq), 0) == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+
+    /* increment memory only sequence number after sending */
+    nSequence++;
+
+    return true;
+}
+
+bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &/*pblock*/)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint("zmq", "zmq: Publish hashblock %s\n", hash.GetHex());
@@ -161,13 +215,19 @@ bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &t
     return SendMessage(MSG_HASHTX, data, 32);
 }
 
-bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock)
 {
     LogPrint("zmq", "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+    std::unique_ptr<CDataStream> ss(new CDataStream(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags()));
+    if (pblock)
+    {
+        *ss << *pblock;
+    }
+    else
     {
+        // the block of the tip is not in memory anymore
+        const Consensus::Params& consensusParams = Params().GetConsensus();
         LOCK(cs_main);
         CBlock block;
         if(!ReadBlockFromDisk(block, pindex, consensusParams))
@@ -176,17 +236,70 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
             return false;
         }
 
-        ss << block;
+        *ss << block;
     }
 
-    return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    return SendMessage(MSG_RAWBLOCK, std::move(ss));
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogPrint("zmq", "zmq: Publish rawtx %s\n", hash.GetHex());
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    ss << transaction;
-    return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    std::unique_ptr<CDataStream> ss(new CDataStream(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags()));
+    *ss << transaction;
+    return SendMessage(MSG_RAWTX, std::move(ss));
+}
+
+bool CZMQPublishRawSigmaMintNotifier::NotifyConnectedTransaction(const CTransaction &transaction, const CBlockIndex *pindex)
+{
+    if (!transaction.IsSigmaMint())
+        return true;
+
+    uint256 hash = transaction.GetHash();
+    for (uint32_t n = 0; n < transaction.vout.size(); n++)
+    {
+        const CTxOut &txout = transaction.vout[n];
+        if (!txout.scriptPubKey.IsSigmaMint())
+            continue;
+
+        LogPrint("zmq", "zmq: Publish rawsigmamint %s:%u\n", hash.GetHex(), n);
+        /* block hash & txid & LE 4byte output index & LE 8byte value & public coin */
+        secp_primitives::GroupElement pubCoin = sigma::ParseSigmaMintScript(txout.scriptPubKey);
+        std::vector<unsigned char> data(76 + pubCoin.memoryRequired());
+        WriteReversedHash(&data[0], pindex->GetBlockHash());
+        WriteReversedHash(&data[32], hash);
+        WriteLE32(&data[64], n);
+        WriteLE64(&data[68], txout.nValue);
+        pubCoin.serialize(&data[76]);
+        if (!SendMessage(MSG_RAWSIGMAMINT, &data[0], data.size()))
+            return false;
+    }
+    return true;
+}
+
+bool CZMQPublishSigmaSpendSerialNotifier::NotifyConnectedTransaction(const CTransaction &transaction, const CBlockIndex *pindex)
+{
+    if (!transaction.IsSigmaSpend())
+        return true;
+
+    uint256 hash = transaction.GetHash();
+    for (uint32_t n = 0; n < transaction.vin.size(); n++)
+    {
+        const CTxIn &txin = transaction.vin[n];
+        if (!txin.IsSigmaSpend())
+            continue;
+
+        LogPrint("zmq", "zmq: Publish sigmaspendserial %s:%u\n", hash.GetHex(), n);
+        /* block hash & txid & LE 4byte input index & coin serial */
+        Scalar serial = sigma::GetSigmaSpendSerialNumber(transaction, txin);
+        std::vector<unsigned char> data(68 + serial.memoryRequired());
+        WriteReversedHash(&data[0], pindex->GetBlockHash());
+        WriteReversedHash(&data[32], hash);
+        WriteLE32(&data[64], n);
+        serial.serialize(&data[68]);
+        if (!SendMessage(MSG_SIGMASPENDSERIAL, &data[0], data.size()))
+            return false;
+    }
+    return true;
 }
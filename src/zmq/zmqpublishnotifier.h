@@ -6,6 +6,7 @@
 #define BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
 
 #include "zmqabstractnotifier.h"
+#include "streams.h"
 
 class CBlockIndex;
 
@@ -24,6 +25,10 @@ public:
     */
     bool SendMessage(const char *command, const void* data, size_t size);
 
+    /* send zmq multipart message as above, handing the data over to ZMQ without
+       copying it; ZMQ frees it once sent */
+    bool SendMessage(const char *command, std::unique_ptr<CDataStream> data);
+
     bool Initialize(void *pcontext);
     void Shutdown();
 };
@@ -31,7 +36,7 @@ public:
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex);
+    bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock);
 };
 
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -43,7 +48,7 @@ public:
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex);
+    bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock);
 };
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -52,4 +57,16 @@ public:
     bool NotifyTransaction(const CTransaction &transaction);
 };
 
+class CZMQPublishRawSigmaMintNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyConnectedTransaction(const CTransaction &transaction, const CBlockIndex *pindex);
+};
+
+class CZMQPublishSigmaSpendSerialNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyConnectedTransaction(const CTransaction &transaction, const CBlockIndex *pindex);
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H